@@ -0,0 +1,511 @@
+#include <JuceHeader.h>
+#include "Database/ChopsDatabase.h"
+#include "Core/ChordTypes.h"
+#include <sqlite3.h>
+#include <iostream>
+#include <map>
+#include <random>
+
+/**
+ * ChopsDbBench - synthetic library generator and database benchmark
+ *
+ * Generates a library with a realistic shape (chord types weighted from
+ * ChordTypes, tags, ratings, play counts) directly into a database file,
+ * then runs a scripted query mix through ChopsDatabase and reports latency
+ * percentiles, throughput and the query plan of every statement it saw.
+ *
+ *   ChopsDbBench [--rows N] [--iterations N] [--seed N] [--db path]
+ *                [--schema path] [--reuse] [--keep] [--analyze] [--verbose]
+ */
+
+namespace
+{
+    struct BenchOptions
+    {
+        int rows = 100000;
+        int iterations = 200;
+        unsigned int seed = 1234;
+        juce::File databaseFile;
+        juce::File schemaFile;
+        bool reuseDatabase = false;
+        bool keepDatabase = false;
+        bool runAnalyze = false;
+        bool verbose = false;
+    };
+
+    // ChopsDatabase logs every open and error; keep benchmark output readable
+    class QuietLogger : public juce::Logger
+    {
+    public:
+        void logMessage(const juce::String&) override {}
+    };
+
+    //==============================================================================
+    class LibraryGenerator
+    {
+    public:
+        explicit LibraryGenerator(unsigned int seed) : rng(seed)
+        {
+            auto types = ChordTypes::getStandardizedChordTypes();
+            std::vector<juce::String> keys;
+            for (const auto& pair : types) keys.push_back(pair.first);
+            std::sort(keys.begin(), keys.end()); // unordered_map order is not stable across platforms
+
+            std::vector<double> weights;
+            for (const auto& key : keys)
+            {
+                const auto& type = types[key];
+                chordTypes.push_back(type);
+                // Triads and sevenths dominate real chop libraries; intervals and 13ths are rare
+                weights.push_back(type.family == "interval" ? 0.5 : 16.0 / (1 << juce::jlimit(1, 6, type.complexity)));
+            }
+            chordTypeDist = std::discrete_distribution<int>(weights.begin(), weights.end());
+        }
+
+        const juce::StringArray& getTagPool() const { return tagPool; }
+        const juce::StringArray& getRootNotes() const { return rootNotes; }
+        const std::vector<ChordTypes::ChordType>& getChordTypes() const { return chordTypes; }
+
+        bool generate(const juce::File& databaseFile, const juce::File& schemaFile, int numRows)
+        {
+            sqlite3* db = nullptr;
+            if (sqlite3_open(databaseFile.getFullPathName().toRawUTF8(), &db) != SQLITE_OK)
+            {
+                std::cerr << "Could not create " << databaseFile.getFullPathName() << std::endl;
+                sqlite3_close(db);
+                return false;
+            }
+
+            bool ok = exec(db, "PRAGMA journal_mode = WAL") && exec(db, "PRAGMA synchronous = OFF")
+                   && exec(db, schemaFile.loadFileAsString()) && exec(db, "BEGIN");
+
+            sqlite3_stmt* insertSample = nullptr;
+            sqlite3_stmt* insertTag = nullptr;
+            sqlite3_stmt* insertSampleTag = nullptr;
+            ok = ok && prepare(db, R"(
+                INSERT INTO samples (
+                    original_filename, current_filename, file_path, file_size,
+                    root_note, chord_type, chord_type_display,
+                    extensions, alterations, added_notes, suspensions,
+                    bass_note, inversion, date_added, date_modified, processing_version, search_text,
+                    duration_ms, sample_rate, bit_depth, channels, bpm,
+                    rating, color_hex, is_favorite, play_count, last_played
+                ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+            )", &insertSample)
+               && prepare(db, "INSERT OR IGNORE INTO tags (name) VALUES (?)", &insertTag)
+               && prepare(db, "INSERT OR IGNORE INTO sample_tags (sample_id, tag_id) VALUES (?, ?)", &insertSampleTag);
+
+            if (ok)
+            {
+                for (const auto& tag : tagPool)
+                {
+                    sqlite3_bind_text(insertTag, 1, tag.toRawUTF8(), -1, SQLITE_TRANSIENT);
+                    sqlite3_step(insertTag);
+                    sqlite3_reset(insertTag);
+                }
+            }
+
+            auto startTime = juce::Time::getMillisecondCounterHiRes();
+            auto now = juce::Time::getCurrentTime();
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            std::discrete_distribution<int> ratingDist({ 50, 5, 8, 15, 12, 10 });
+            std::geometric_distribution<int> playCountDist(0.2);
+            std::uniform_int_distribution<int> ageSeconds(0, 730 * 24 * 3600);
+
+            for (int i = 0; ok && i < numRows; ++i)
+            {
+                const auto& type = chordTypes[(size_t) chordTypeDist(rng)];
+                juce::String root = rootNotes[rootNoteDist(rng)];
+                juce::StringArray extensions, alterations, addedNotes, suspensions, tags;
+
+                if (type.complexity >= 3 && unit(rng) < 0.25) extensions.add(juce::StringArray { "9", "11", "13" }[(int) (unit(rng) * 3)]);
+                if (unit(rng) < 0.15) alterations.add(juce::StringArray { "b5", "#5", "b9", "#9", "#11", "b13" }[(int) (unit(rng) * 6)]);
+                if (unit(rng) < 0.05) addedNotes.add("add9");
+                if (type.family == "suspended") suspensions.add(type.key);
+
+                int numTags = juce::jmin(4, (int) (unit(rng) * unit(rng) * 5));
+                for (int t = 0; t < numTags; ++t)
+                    tags.addIfNotAlreadyThere(tagPool[tagDist(rng)]);
+
+                juce::String bassNote = unit(rng) < 0.15 ? rootNotes[rootNoteDist(rng)] : juce::String();
+                juce::String inversion = bassNote.isNotEmpty() && bassNote != root ? "slash" : "";
+                int bpm = 70 + (int) (unit(rng) * 100);
+                juce::String display = root + type.symbol + extensions.joinIntoString("") + alterations.joinIntoString("")
+                                     + (bassNote.isNotEmpty() ? "/" + bassNote : juce::String());
+                juce::String filename = display + " " + juce::String(bpm) + "bpm " + tags.joinIntoString(" ") + " " + juce::String(i + 1) + ".wav";
+                juce::String path = "/bench/Chops/2. Processed/" + ChordTypes::sanitizeChordFolderName(type.key) + "/" + filename;
+
+                int rating = ratingDist(rng);
+                int playCount = unit(rng) < 0.6 ? 0 : playCountDist(rng);
+                auto added = now - juce::RelativeTime::seconds(ageSeconds(rng));
+                juce::String searchText = (filename + " " + filename + " " + root + " " + type.key + " " + tags.joinIntoString(" ")).toLowerCase();
+
+                int col = 1;
+                auto bindText = [&](const juce::String& text) { sqlite3_bind_text(insertSample, col++, text.toRawUTF8(), -1, SQLITE_TRANSIENT); };
+                bindText(filename);
+                bindText(filename);
+                bindText(path);
+                sqlite3_bind_int64(insertSample, col++, 200000 + (juce::int64) (unit(rng) * 5000000));
+                bindText(root);
+                bindText(type.key);
+                bindText(display);
+                bindText(toJson(extensions));
+                bindText(toJson(alterations));
+                bindText(toJson(addedNotes));
+                bindText(toJson(suspensions));
+                bindText(bassNote);
+                bindText(inversion);
+                sqlite3_bind_int64(insertSample, col++, added.toMilliseconds());
+                sqlite3_bind_int64(insertSample, col++, added.toMilliseconds());
+                bindText("bench");
+                bindText(searchText);
+                sqlite3_bind_int(insertSample, col++, 1000 + (int) (unit(rng) * 8000));
+                sqlite3_bind_int(insertSample, col++, unit(rng) < 0.7 ? 44100 : 48000);
+                sqlite3_bind_int(insertSample, col++, unit(rng) < 0.5 ? 16 : 24);
+                sqlite3_bind_int(insertSample, col++, 2);
+                sqlite3_bind_double(insertSample, col++, bpm);
+                sqlite3_bind_int(insertSample, col++, rating);
+                bindText(juce::Colours::transparentBlack.toDisplayString(true));
+                sqlite3_bind_int(insertSample, col++, unit(rng) < 0.05 ? 1 : 0);
+                sqlite3_bind_int(insertSample, col++, playCount);
+                if (playCount > 0) sqlite3_bind_int64(insertSample, col++, (now - juce::RelativeTime::seconds(ageSeconds(rng) / 4)).toMilliseconds());
+                else sqlite3_bind_null(insertSample, col++);
+
+                ok = sqlite3_step(insertSample) == SQLITE_DONE;
+                sqlite3_reset(insertSample);
+
+                auto sampleId = sqlite3_last_insert_rowid(db);
+                for (const auto& tag : tags)
+                {
+                    sqlite3_bind_int64(insertSampleTag, 1, sampleId);
+                    sqlite3_bind_int(insertSampleTag, 2, tagPool.indexOf(tag) + 1);
+                    sqlite3_step(insertSampleTag);
+                    sqlite3_reset(insertSampleTag);
+                }
+
+                if ((i + 1) % 100000 == 0)
+                    std::cout << "  ... " << (i + 1) << " rows" << std::endl;
+            }
+
+            if (!ok) std::cerr << "Generation failed: " << sqlite3_errmsg(db) << std::endl;
+
+            sqlite3_finalize(insertSample);
+            sqlite3_finalize(insertTag);
+            sqlite3_finalize(insertSampleTag);
+            ok = ok && exec(db, "COMMIT");
+
+            double seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+            if (ok)
+                std::cout << "Generated " << numRows << " samples in " << juce::String(seconds, 2) << " s ("
+                          << juce::String(numRows / juce::jmax(seconds, 0.001), 0) << " rows/sec)" << std::endl;
+
+            sqlite3_close(db);
+            return ok;
+        }
+
+    private:
+        std::mt19937 rng;
+        std::vector<ChordTypes::ChordType> chordTypes;
+        std::discrete_distribution<int> chordTypeDist;
+
+        juce::StringArray rootNotes { "C", "C#", "Db", "D", "D#", "Eb", "E", "F", "F#", "Gb", "G", "G#", "Ab", "A", "A#", "Bb", "B" };
+        std::discrete_distribution<int> rootNoteDist { 3, 1, 1, 3, 1, 1, 3, 3, 1, 1, 3, 1, 1, 3, 1, 1, 3 };
+
+        juce::StringArray tagPool { "warm", "dark", "bright", "lofi", "vinyl", "piano", "rhodes", "pad", "strings", "guitar",
+                                    "synth", "organ", "choir", "brass", "airy", "dusty", "soulful", "jazzy", "cinematic", "ambient",
+                                    "trap", "house", "neosoul", "gospel", "detuned", "chopped", "reversed", "stab", "long", "short",
+                                    "wide", "mono", "clean", "saturated", "tape", "granular", "plucked", "bowed", "sampled", "favourite" };
+        // Roughly Zipfian: a few tags are everywhere, most are rare
+        std::discrete_distribution<int> tagDist = makeZipf(40);
+
+        static std::discrete_distribution<int> makeZipf(int n)
+        {
+            std::vector<double> weights;
+            for (int i = 1; i <= n; ++i) weights.push_back(1.0 / i);
+            return std::discrete_distribution<int>(weights.begin(), weights.end());
+        }
+
+        static juce::String toJson(const juce::StringArray& values)
+        {
+            juce::String json = "[";
+            for (int i = 0; i < values.size(); ++i)
+                json << (i > 0 ? "," : "") << "\"" << values[i] << "\"";
+            return json + "]";
+        }
+
+        static bool exec(sqlite3* db, const juce::String& sql)
+        {
+            char* errMsg = nullptr;
+            if (sqlite3_exec(db, sql.toRawUTF8(), nullptr, nullptr, &errMsg) == SQLITE_OK) return true;
+            std::cerr << "SQL error: " << (errMsg ? errMsg : "unknown") << std::endl;
+            sqlite3_free(errMsg);
+            return false;
+        }
+
+        static bool prepare(sqlite3* db, const char* sql, sqlite3_stmt** stmt)
+        {
+            if (sqlite3_prepare_v2(db, sql, -1, stmt, nullptr) == SQLITE_OK) return true;
+            std::cerr << "Prepare failed: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+    };
+
+    //==============================================================================
+    struct CaseResult
+    {
+        juce::String name;
+        std::vector<double> latenciesMs;
+        juce::int64 rows = 0;
+
+        double percentile(double p) const
+        {
+            if (latenciesMs.empty()) return 0.0;
+            auto sorted = latenciesMs;
+            std::sort(sorted.begin(), sorted.end());
+            auto index = (size_t) juce::jlimit(0, (int) sorted.size() - 1, (int) std::ceil(p * (double) sorted.size()) - 1);
+            return sorted[index];
+        }
+
+        double totalMs() const { return std::accumulate(latenciesMs.begin(), latenciesMs.end(), 0.0); }
+    };
+
+    class QueryBench
+    {
+    public:
+        QueryBench(ChopsDatabase& databaseToUse, int iterationsPerCase) : database(databaseToUse), iterations(iterationsPerCase) {}
+
+        // Runs fn `runs` times; fn returns the number of rows it produced
+        void run(const juce::String& name, int runs, const std::function<juce::int64(int)>& fn)
+        {
+            CaseResult result;
+            result.name = name;
+            for (int i = 0; i < runs; ++i)
+            {
+                auto start = juce::Time::getMillisecondCounterHiRes();
+                result.rows += fn(i);
+                result.latenciesMs.push_back(juce::Time::getMillisecondCounterHiRes() - start);
+            }
+            results.push_back(std::move(result));
+            std::cout << "  " << name << " done" << std::endl;
+        }
+
+        void printReport() const
+        {
+            std::cout << std::endl
+                      << juce::String("case").paddedRight(' ', 34) << juce::String("runs").paddedLeft(' ', 6)
+                      << juce::String("p50 ms").paddedLeft(' ', 10) << juce::String("p90 ms").paddedLeft(' ', 10)
+                      << juce::String("p99 ms").paddedLeft(' ', 10) << juce::String("max ms").paddedLeft(' ', 10)
+                      << juce::String("ops/s").paddedLeft(' ', 10) << juce::String("rows/s").paddedLeft(' ', 12) << std::endl;
+
+            for (const auto& r : results)
+            {
+                double seconds = juce::jmax(r.totalMs() / 1000.0, 1.0e-9);
+                std::cout << r.name.paddedRight(' ', 34)
+                          << juce::String((int) r.latenciesMs.size()).paddedLeft(' ', 6)
+                          << juce::String(r.percentile(0.50), 3).paddedLeft(' ', 10)
+                          << juce::String(r.percentile(0.90), 3).paddedLeft(' ', 10)
+                          << juce::String(r.percentile(0.99), 3).paddedLeft(' ', 10)
+                          << juce::String(r.percentile(1.00), 3).paddedLeft(' ', 10)
+                          << juce::String(r.latenciesMs.size() / seconds, 0).paddedLeft(' ', 10)
+                          << juce::String(r.rows / seconds, 0).paddedLeft(' ', 12) << std::endl;
+            }
+        }
+
+        int getIterations() const { return iterations; }
+        ChopsDatabase& getDatabase() { return database; }
+
+    private:
+        ChopsDatabase& database;
+        int iterations;
+        std::vector<CaseResult> results;
+    };
+
+    //==============================================================================
+    void printQueryPlans(const juce::File& databaseFile, const std::map<juce::String, int>& statements)
+    {
+        sqlite3* db = nullptr;
+        if (sqlite3_open_v2(databaseFile.getFullPathName().toRawUTF8(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+            sqlite3_close(db);
+            return;
+        }
+
+        std::cout << std::endl << "=== QUERY PLANS ===" << std::endl;
+        for (const auto& [sql, count] : statements)
+        {
+            auto trimmed = sql.trim();
+            if (!(trimmed.startsWithIgnoreCase("SELECT") || trimmed.startsWithIgnoreCase("INSERT")
+                  || trimmed.startsWithIgnoreCase("UPDATE") || trimmed.startsWithIgnoreCase("DELETE")))
+                continue;
+
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + trimmed).toRawUTF8(), -1, &stmt, nullptr) != SQLITE_OK)
+                continue;
+
+            auto oneLine = juce::StringArray::fromTokens(trimmed, " \t\r\n", "").joinIntoString(" ");
+            std::cout << std::endl << "[" << count << "x] " << oneLine << std::endl;
+            std::map<int, int> depthById;
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                int id = sqlite3_column_int(stmt, 0);
+                int parent = sqlite3_column_int(stmt, 1);
+                int depth = depthById.count(parent) ? depthById[parent] + 1 : 1;
+                depthById[id] = depth;
+                std::cout << juce::String::repeatedString("  ", depth) << "- "
+                          << reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)) << std::endl;
+            }
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(db);
+    }
+
+    bool parseOptions(int argc, char* argv[], BenchOptions& options)
+    {
+        juce::StringArray args;
+        for (int i = 1; i < argc; ++i) args.add(juce::String::fromUTF8(argv[i]));
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            auto next = [&]() { return i + 1 < args.size() ? args[++i] : juce::String(); };
+            const auto& arg = args[i];
+            if (arg == "--rows") options.rows = juce::jmax(1, next().getIntValue());
+            else if (arg == "--iterations") options.iterations = juce::jmax(1, next().getIntValue());
+            else if (arg == "--seed") options.seed = (unsigned int) next().getLargeIntValue();
+            else if (arg == "--db") options.databaseFile = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--schema") options.schemaFile = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--reuse") options.reuseDatabase = true;
+            else if (arg == "--keep") options.keepDatabase = true;
+            else if (arg == "--analyze") options.runAnalyze = true;
+            else if (arg == "--verbose") options.verbose = true;
+            else
+            {
+                std::cout << "Usage: ChopsDbBench [--rows N] [--iterations N] [--seed N] [--db path] [--schema path]\n"
+                             "                    [--reuse] [--keep] [--analyze] [--verbose]" << std::endl;
+                return false;
+            }
+        }
+
+        if (options.schemaFile == juce::File())
+            options.schemaFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getSiblingFile("schema.sql");
+
+        if (options.databaseFile == juce::File())
+            options.databaseFile = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                       .getChildFile("chops_bench_" + juce::String(options.rows) + ".sqlite");
+        else
+            options.keepDatabase = true; // Never delete a file the user pointed us at
+
+        return true;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    QuietLogger quietLogger;
+    if (!options.verbose)
+        juce::Logger::setCurrentLogger(&quietLogger);
+
+    LibraryGenerator generator(options.seed);
+    const auto& dbFile = options.databaseFile;
+
+    if (!(options.reuseDatabase && dbFile.existsAsFile()))
+    {
+        if (!options.schemaFile.existsAsFile())
+        {
+            std::cerr << "Schema not found at " << options.schemaFile.getFullPathName() << " (use --schema)" << std::endl;
+            return 1;
+        }
+
+        for (auto suffix : { "", "-wal", "-shm" })
+            dbFile.getSiblingFile(dbFile.getFileName() + suffix).deleteFile();
+
+        std::cout << "Generating " << options.rows << " samples into " << dbFile.getFullPathName() << std::endl;
+        if (!generator.generate(dbFile, options.schemaFile, options.rows))
+            return 1;
+    }
+
+    ChopsDatabase database;
+    if (!database.open(dbFile.getFullPathName()))
+    {
+        std::cerr << "Could not open " << dbFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (options.runAnalyze)
+        database.analyze();
+
+    std::map<juce::String, int> statements;
+    database.setTraceCallback([&statements](const juce::String& sql, double) { ++statements[sql]; });
+
+    std::mt19937 rng(options.seed + 1);
+    const auto& roots = generator.getRootNotes();
+    const auto& tags = generator.getTagPool();
+    const auto& types = generator.getChordTypes();
+    auto pick = [&rng](int size) { return std::uniform_int_distribution<int>(0, size - 1)(rng); };
+
+    int n = options.iterations;
+    int slowN = juce::jmax(5, n / 10);
+    QueryBench bench(database, n);
+
+    std::cout << std::endl << "Running query mix (" << n << " iterations per case)" << std::endl;
+
+    bench.run("search: browse first page", n, [&](int) {
+        return (juce::int64) database.searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, 100, 0).size(); });
+    bench.run("search: browse page 50", n, [&](int) {
+        return (juce::int64) database.searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, 100, 5000).size(); });
+    bench.run("search: root note", n, [&](int) {
+        return (juce::int64) database.searchSamples("", roots[pick(roots.size())], "").size(); });
+    bench.run("search: root + chord type", n, [&](int) {
+        return (juce::int64) database.searchSamples("", roots[pick(roots.size())], types[(size_t) pick((int) types.size())].key).size(); });
+    bench.run("search: text (tag word)", n, [&](int) {
+        return (juce::int64) database.searchSamples(tags[pick(tags.size())]).size(); });
+    bench.run("search: text + has extensions", n, [&](int) {
+        return (juce::int64) database.searchSamples("bpm", "", "", ChopsDatabase::Yes).size(); });
+    bench.run("getSamplesByTag", slowN, [&](int) {
+        return (juce::int64) database.getSamplesByTag(tags[pick(juce::jmin(10, tags.size()))]).size(); });
+    bench.run("getSampleById", n, [&](int) {
+        return (juce::int64) (database.getSampleById(1 + pick(options.rows)) != nullptr ? 1 : 0); });
+    bench.run("getStatistics", slowN, [&](int) {
+        return (juce::int64) database.getStatistics().totalSamples; });
+    bench.run("getDistinctRootNotes + ChordTypes", slowN, [&](int) {
+        return (juce::int64) (database.getDistinctRootNotes().size() + database.getDistinctChordTypes().size()); });
+
+    auto makeSample = [&](int i) {
+        ChopsDatabase::SampleInfo sample;
+        const auto& type = types[(size_t) pick((int) types.size())];
+        sample.rootNote = roots[pick(roots.size())];
+        sample.chordType = type.key;
+        sample.chordTypeDisplay = sample.rootNote + type.symbol;
+        sample.originalFilename = sample.currentFilename = "bench insert " + juce::String(i) + ".wav";
+        sample.filePath = "/bench/inserted/" + juce::Uuid().toString() + ".wav";
+        sample.tags.add(tags[pick(tags.size())]);
+        return sample;
+    };
+
+    bench.run("insertSample (autocommit)", n, [&](int i) {
+        return (juce::int64) (database.insertSample(makeSample(i)) > 0 ? 1 : 0); });
+    bench.run("insertSample (100 per txn)", slowN, [&](int i) {
+        juce::int64 inserted = 0;
+        database.beginTransaction();
+        for (int j = 0; j < 100; ++j)
+            inserted += database.insertSample(makeSample(i * 100 + j)) > 0 ? 1 : 0;
+        database.commitTransaction();
+        return inserted; });
+
+    database.setTraceCallback(nullptr);
+
+    std::cout << std::endl << "=== RESULTS (" << options.rows << " rows, seed " << (int) options.seed << ") ===";
+    bench.printReport();
+    printQueryPlans(dbFile, statements);
+
+    database.close();
+    if (!options.keepDatabase)
+        for (auto suffix : { "", "-wal", "-shm" })
+            dbFile.getSiblingFile(dbFile.getFileName() + suffix).deleteFile();
+
+    return 0;
+}
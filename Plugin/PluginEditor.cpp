@@ -61,7 +61,11 @@ ChopsBrowserPluginEditor::ChopsBrowserPluginEditor(ChopsBrowserPluginProcessor&
     // Add this editor as a change listener to the processor
     audioProcessor.addChangeListener(this);
     
-    // Start timer for preview progress updates (30 FPS)
+    // A chord detected before the editor opened isn't a new request
+    pendingChord = searchedChord = audioProcessor.getDetectedChord();
+    handledChordSerial = pendingChord.serial;
+    
+    // Start timer for preview progress updates and chord detection polling (30 FPS)
     startTimer(33);
     
     // Force a repaint
@@ -173,6 +177,9 @@ void ChopsBrowserPluginEditor::timerCallback()
         float progress = audioProcessor.getPreviewProgress();
         uiBridge->sendPreviewState(true, progress);
     }
+    
+    if (audioProcessor.isChordDetectionEnabled())
+        pollDetectedChord();
 }
 
 //==============================================================================
@@ -240,97 +247,49 @@ void ChopsBrowserPluginEditor::setupUIBridgeCallbacks()
 //==============================================================================
 void ChopsBrowserPluginEditor::handleSearchRequested(const juce::String& query)
 {
-    auto logFile = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
-                   .getChildFile("ChopsBrowser_VST_Debug.log");
-    
-    logFile.appendText("=== SEARCH REQUEST RECEIVED ===\n");
-    logFile.appendText("Time: " + juce::Time::getCurrentTime().toString(true, true, true, true) + "\n");
-    logFile.appendText("Query: '" + query + "'\n");
-    
     juce::Logger::writeToLog("Search requested: " + query);
+    searchedChord = {}; // Playing the last detected chord again should bring it back
     
     if (!uiBridge) {
-        logFile.appendText("❌ ERROR: uiBridge is null!\n");
-        logFile.appendText("==============================\n\n");
         return;
     }
     
-    logFile.appendText("✅ UIBridge is available\n");
-    
     // Send loading state
     uiBridge->sendLoadingState(true);
-    logFile.appendText("Sent loading state: true\n");
     
     // Parse the query into search criteria
     ChopsBrowserPluginProcessor::SearchCriteria criteria;
     parseQueryIntoCriteria(query, criteria);
     
-    logFile.appendText("Parsed search criteria:\n");
-    logFile.appendText("  - Root note: '" + criteria.rootNote + "'\n");
-    logFile.appendText("  - Chord type: '" + criteria.chordType + "'\n");
-    logFile.appendText("  - Search text: '" + criteria.searchText + "'\n");
-    
-    // Check if processor is available
-    logFile.appendText("Checking processor availability...\n");
-    logFile.appendText("  - Processor database available: " + juce::String(audioProcessor.isDatabaseAvailable() ? "YES" : "NO") + "\n");
-    
-    if (audioProcessor.isDatabaseAvailable())
-    {
-        auto dbInfo = audioProcessor.getDatabaseInfo();
-        logFile.appendText("  - Database info: " + dbInfo + "\n");
-    }
-    
-    // Perform the search
-    logFile.appendText("Calling audioProcessor.searchSamples()...\n");
-    currentResults = audioProcessor.searchSamples(criteria);
-    logFile.appendText("Search completed, got " + juce::String(currentResults.size()) + " results\n");
-    
-    if (currentResults.size() > 0)
-    {
-        logFile.appendText("First few results:\n");
-        for (int i = 0; i < juce::jmin(3, (int)currentResults.size()); ++i)
-        {
-            const auto& sample = currentResults[i];
-            logFile.appendText("  " + juce::String(i+1) + ". " + sample.currentFilename + 
-                             " (Root: '" + sample.rootNote + "', Type: '" + sample.chordType + "')\n");
-        }
-    }
-    
-    // Send results to UI
-    logFile.appendText("Sending results to UI...\n");
-    uiBridge->sendSampleResults(currentResults);
-    uiBridge->sendLoadingState(false);
-    logFile.appendText("Results sent to UI\n");
-    
-    logFile.appendText("==============================\n\n");
-    
-    juce::Logger::writeToLog("Search completed with " + juce::String(currentResults.size()) + " results");
+    // Perform the search off the message thread; a newer keystroke supersedes this one
+    juce::Component::SafePointer<ChopsBrowserPluginEditor> safeThis(this);
+    audioProcessor.searchSamplesAsync(criteria, [safeThis](const std::vector<ChopsDatabase::SampleInfo>& results) {
+        if (safeThis == nullptr || safeThis->uiBridge == nullptr)
+            return;
+        
+        safeThis->currentResults = results;
+        safeThis->audioProcessor.setSamplerResults(safeThis->currentResults);
+        safeThis->uiBridge->sendSampleResults(safeThis->currentResults);
+        safeThis->uiBridge->sendLoadingState(false);
+        
+        juce::Logger::writeToLog("Search completed with " + juce::String(results.size()) + " results");
+    });
 }
 
 void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query, ChopsBrowserPluginProcessor::SearchCriteria& criteria)
 {
-    auto logFile = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
-                   .getChildFile("ChopsBrowser_VST_Debug.log");
-    
-    logFile.appendText("=== PARSING QUERY INTO CRITERIA ===\n");
-    logFile.appendText("Input query: '" + query + "'\n");
-    
     // Simple query parsing - can be enhanced
     juce::String trimmedQuery = query.trim();
     
     if (trimmedQuery.isEmpty())
     {
-        logFile.appendText("Empty query - returning all samples\n");
         // Empty query - return all samples
         criteria.searchText = "";
         criteria.rootNote = "";
         criteria.chordType = "";
-        logFile.appendText("================================\n\n");
         return;
     }
     
-    logFile.appendText("Trimmed query: '" + trimmedQuery + "'\n");
-    
     // FIXED: Try to parse as chord notation (e.g., "C", "Cmaj7", "Am", "F#dim")
     ChordParser parser;
     
@@ -338,15 +297,9 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
     juce::String testFilename = trimmedQuery + ".wav";
     auto parsedChord = parser.parseFilename(testFilename);
     
-    logFile.appendText("Chord parser results (first attempt):\n");
-    logFile.appendText("  - Root note: '" + parsedChord.rootNote + "'\n");
-    logFile.appendText("  - Standardized quality: '" + parsedChord.standardizedQuality + "'\n");
-    logFile.appendText("  - Issues: " + parsedChord.issues.joinIntoString(", ") + "\n");
-    
     // If that didn't work, try some common chord patterns
     if (parsedChord.rootNote.isEmpty())
     {
-        logFile.appendText("First attempt failed, trying alternative patterns...\n");
         
         // Try with common chord suffixes
         juce::StringArray testPatterns = {
@@ -362,7 +315,6 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
             if (!testParsed.rootNote.isEmpty())
             {
                 parsedChord = testParsed;
-                logFile.appendText("Alternative pattern '" + pattern + "' worked!\n");
                 break;
             }
         }
@@ -370,7 +322,6 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
         // FIXED: Manual chord recognition for simple cases
         if (parsedChord.rootNote.isEmpty())
         {
-            logFile.appendText("Parser failed, trying manual recognition...\n");
             
             // Check if it's a simple root note (C, D, E, F, G, A, B with optional # or b)
             juce::String upperQuery = trimmedQuery.toUpperCase();
@@ -391,7 +342,6 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
                     
                     parsedChord.rootNote = rootCandidate;
                     parsedChord.standardizedQuality = "maj"; // Default to major
-                    logFile.appendText("Manual recognition: Root='" + rootCandidate + "', Quality='maj'\n");
                 }
             }
             
@@ -424,11 +374,6 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
                     parsedChord.rootNote = upperQuery.substring(0, upperQuery.length() - 1);
                     parsedChord.standardizedQuality = "dom7";
                 }
-                
-                if (!parsedChord.rootNote.isEmpty())
-                {
-                    logFile.appendText("Pattern matching: Root='" + parsedChord.rootNote + "', Quality='" + parsedChord.standardizedQuality + "'\n");
-                }
             }
         }
     }
@@ -440,7 +385,6 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
         criteria.chordType = parsedChord.standardizedQuality;
         criteria.searchText = ""; // Clear text search when using structured search
         
-        logFile.appendText("✅ Parsed as chord: " + criteria.rootNote + " " + criteria.chordType + "\n");
         juce::Logger::writeToLog("Parsed as chord: " + criteria.rootNote + " " + criteria.chordType);
     }
     else
@@ -450,20 +394,15 @@ void ChopsBrowserPluginEditor::parseQueryIntoCriteria(const juce::String& query,
         criteria.rootNote = "";
         criteria.chordType = "";
         
-        logFile.appendText("✅ Using text search: " + criteria.searchText + "\n");
         juce::Logger::writeToLog("Using text search: " + criteria.searchText);
     }
     
-    logFile.appendText("Final criteria:\n");
-    logFile.appendText("  - Root note: '" + criteria.rootNote + "'\n");
-    logFile.appendText("  - Chord type: '" + criteria.chordType + "'\n");
-    logFile.appendText("  - Search text: '" + criteria.searchText + "'\n");
-    logFile.appendText("================================\n\n");
 }
 
 void ChopsBrowserPluginEditor::handleChordSelected(const ChordParser::ParsedData& chordData)
 {
     juce::Logger::writeToLog("Chord selected: " + chordData.rootNote + " " + chordData.standardizedQuality);
+    searchedChord = {};
     
     // Trigger search based on selected chord
     ChopsBrowserPluginProcessor::SearchCriteria criteria;
@@ -474,11 +413,72 @@ void ChopsBrowserPluginEditor::handleChordSelected(const ChordParser::ParsedData
     {
         uiBridge->sendLoadingState(true);
         currentResults = audioProcessor.searchSamples(criteria);
+        audioProcessor.setSamplerResults(currentResults);
         uiBridge->sendSampleResults(currentResults);
         uiBridge->sendLoadingState(false);
     }
 }
 
+void ChopsBrowserPluginEditor::pollDetectedChord()
+{
+    auto chord = audioProcessor.getDetectedChord();
+    auto now = juce::Time::getMillisecondCounter();
+    
+    // Debounce: a voicing played as a roll, or changed note by note, only searches once it settles
+    if (chord.serial != pendingChord.serial)
+    {
+        pendingChord = chord;
+        pendingChordSince = now;
+        return;
+    }
+    
+    if (!pendingChord.isValid() || pendingChord.serial == handledChordSerial || now - pendingChordSince < chordDebounceMs)
+        return;
+    
+    handledChordSerial = pendingChord.serial;
+    if (pendingChord.isSameChordAs(searchedChord))
+        return;
+    
+    // Unpinned sampler keys follow the results; re-searching would remap the keys being played
+    if (audioProcessor.isSamplerEnabled() && !audioProcessor.isSamplerPinned())
+        return;
+    
+    searchedChord = pendingChord;
+    handleChordDetected(pendingChord);
+}
+
+void ChopsBrowserPluginEditor::handleChordDetected(const ChordDetector::Chord& chord)
+{
+    ChordParser::ParsedData chordData;
+    chordData.rootNote = ChordDetector::getPitchClassName(chord.root);
+    chordData.standardizedQuality = audioProcessor.getChordTypeKey(chord.type);
+    if (chord.bass != chord.root)
+        chordData.determinedBassNote = ChordDetector::getPitchClassName(chord.bass);
+    
+    juce::Logger::writeToLog("Chord detected: " + chordData.rootNote + " " + chordData.standardizedQuality);
+    
+    if (!uiBridge)
+        return;
+    
+    ChopsBrowserPluginProcessor::SearchCriteria criteria;
+    criteria.rootNote = chordData.rootNote;
+    criteria.chordType = chordData.standardizedQuality;
+    
+    uiBridge->sendChordData(chordData);
+    uiBridge->sendLoadingState(true);
+    
+    juce::Component::SafePointer<ChopsBrowserPluginEditor> safeThis(this);
+    audioProcessor.searchSamplesAsync(criteria, [safeThis](const std::vector<ChopsDatabase::SampleInfo>& results) {
+        if (safeThis == nullptr || safeThis->uiBridge == nullptr)
+            return;
+        
+        safeThis->currentResults = results;
+        safeThis->audioProcessor.setSamplerResults(safeThis->currentResults);
+        safeThis->uiBridge->sendSampleResults(safeThis->currentResults);
+        safeThis->uiBridge->sendLoadingState(false);
+    });
+}
+
 void ChopsBrowserPluginEditor::handleSampleSelected(int sampleId)
 {
     juce::Logger::writeToLog("Sample selected: " + juce::String(sampleId));
@@ -493,9 +493,23 @@ void ChopsBrowserPluginEditor::handleSampleSelected(int sampleId)
     {
         selectedSampleIndex = static_cast<int>(std::distance(currentResults.begin(), it));
         
+        // Results can be older than edits made since; the cache makes this re-fetch cheap
+        if (auto* dbManager = audioProcessor.getDatabaseManager())
+            if (auto fresh = dbManager->getSample(sampleId))
+                *it = *fresh;
+        
         // Load sample for preview
         audioProcessor.loadSampleForPreview(it->filePath);
         
+        // Arrowing through results goes to a neighbour next; have their heads decoded by then.
+        // The selection itself goes first, so coming back to it is instant too.
+        juce::StringArray likelyNext { it->filePath };
+        for (int distance = 1; distance <= 2; ++distance)
+            for (int index : { selectedSampleIndex + distance, selectedSampleIndex - distance })
+                if (index >= 0 && index < static_cast<int>(currentResults.size()))
+                    likelyNext.add(currentResults[static_cast<size_t>(index)].filePath);
+        audioProcessor.prefetchPreviews(likelyNext);
+        
         // Send updated sample info to UI
         if (uiBridge)
         {
@@ -587,6 +601,7 @@ void ChopsBrowserPluginEditor::handleLibraryRescanRequested()
             ChopsBrowserPluginProcessor::SearchCriteria criteria;
             criteria.searchText = ""; // Reload all
             currentResults = audioProcessor.searchSamples(criteria);
+            audioProcessor.setSamplerResults(currentResults);
             uiBridge->sendSampleResults(currentResults);
         }
         uiBridge->sendLoadingState(false);
@@ -611,6 +626,22 @@ void ChopsBrowserPluginEditor::handleUIEvent(const juce::String& eventType, cons
             uiBridge->sendErrorMessage("Chopsie Daisy effects not yet implemented");
         }
     }
+    else if (eventType == "samplerMode")
+    {
+        // Plays the results (or the pinned set) from MIDI, one per key from C1 up
+        audioProcessor.setSamplerEnabled(static_cast<bool>(eventData.getProperty("enabled", false)));
+    }
+    else if (eventType == "chordDetect")
+    {
+        // Searches for whatever chord is held on the MIDI input
+        audioProcessor.setChordDetectionEnabled(static_cast<bool>(eventData.getProperty("enabled", false)));
+    }
+    else if (eventType == "samplerPin")
+    {
+        audioProcessor.setSamplerPinned(static_cast<bool>(eventData.getProperty("pinned", false)));
+        if (!audioProcessor.isSamplerPinned())
+            audioProcessor.setSamplerResults(currentResults);
+    }
     else if (eventType == "bridgeReady")
     {
         // FIXED: UI is ready - send comprehensive initial data
@@ -825,6 +856,7 @@ void ChopsBrowserPluginEditor::sendCurrentData()
         if (!initialResults.empty())
         {
             currentResults = initialResults;
+            audioProcessor.setSamplerResults(currentResults);
             uiBridge->sendSampleResults(currentResults);
         }
     }
@@ -47,6 +47,11 @@ private:
     std::vector<ChopsDatabase::SampleInfo> currentResults;
     int selectedSampleIndex = -1;
     
+    // Chord detection: a chord is searched for once it has been held this long unchanged
+    static constexpr juce::uint32 chordDebounceMs = 120;
+    ChordDetector::Chord pendingChord, searchedChord;
+    juce::uint32 pendingChordSince = 0, handledChordSerial = 0;
+    
     //==============================================================================
     // UI Bridge Callbacks Setup
     void setupUIBridgeCallbacks();
@@ -56,6 +61,8 @@ private:
     void handleSearchRequested(const juce::String& query);
     void parseQueryIntoCriteria(const juce::String& query, ChopsBrowserPluginProcessor::SearchCriteria& criteria);
     void handleChordSelected(const ChordParser::ParsedData& chordData);
+    void pollDetectedChord();
+    void handleChordDetected(const ChordDetector::Chord& chord);
     void handleSampleSelected(int sampleId);
     
     //==============================================================================
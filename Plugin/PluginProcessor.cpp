@@ -26,10 +26,13 @@ ChopsBrowserPluginProcessor::ChopsBrowserPluginProcessor()
     formatManager = std::make_unique<juce::AudioFormatManager>();
     initializeAudioFormats();
     
-    // Initialize transport source with a dummy callback
-    transportSource.addChangeListener(nullptr);
+    // State changes (including a preview playing to its end) arrive on the message thread
+    previewEngine = std::make_unique<PreviewEngine>(*formatManager);
+    previewEngine->onStateChange = [this] { sendChangeMessage(); };
+    keySampler = std::make_unique<KeySampler>(previewEngine->getCache());
     
     // Initialize database manager - try to find and connect to existing database
+    databaseManager.addListener(this);
     logFile.appendText("Starting database initialization...\n");
     initializeDatabase();
     logFile.appendText("Database initialization completed\n");
@@ -38,8 +41,9 @@ ChopsBrowserPluginProcessor::ChopsBrowserPluginProcessor()
 
 ChopsBrowserPluginProcessor::~ChopsBrowserPluginProcessor()
 {
-    transportSource.setSource(nullptr);
-    readerSource.reset();
+    databaseManager.removeListener(this);
+    keySampler.reset(); // Uses the engine's cache
+    previewEngine.reset();
 }
 
 //==============================================================================
@@ -122,23 +126,15 @@ void ChopsBrowserPluginProcessor::initializeDatabase()
         }
     }
     
-    // Test database connection
+    // Test database connection. Browsing reads the snapshot; SQLite stays closed until an edit needs it.
     if (isDatabaseAvailable())
     {
-        auto* db = databaseManager.getReadDatabase();
-        if (db)
+        logFile.appendText("Database connected successfully!\n");
+        if (librarySnapshot.isValid())
         {
-            auto stats = db->getStatistics();
-            logFile.appendText("Database connected successfully!\n");
-            logFile.appendText("Database stats:\n");
-            logFile.appendText("  - Total samples: " + juce::String(stats.totalSamples) + "\n");
-            logFile.appendText("  - With extensions: " + juce::String(stats.withExtensions) + "\n");
-            logFile.appendText("  - With alterations: " + juce::String(stats.withAlterations) + "\n");
-            logFile.appendText("  - Added last week: " + juce::String(stats.addedLastWeek) + "\n");
+            logFile.appendText("Library snapshot: " + juce::String(librarySnapshot.getNumSamples()) + " samples\n");
             
-            // Test a simple search
-            logFile.appendText("Testing simple database search...\n");
-            auto testResults = db->searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, 5, 0);
+            auto testResults = librarySnapshot.searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, 5, 0);
             logFile.appendText("Test search returned " + juce::String(testResults.size()) + " samples\n");
             
             if (!testResults.empty())
@@ -154,7 +150,7 @@ void ChopsBrowserPluginProcessor::initializeDatabase()
         }
         else
         {
-            logFile.appendText("ERROR: Database manager created but read database is null!\n");
+            logFile.appendText("No library snapshot yet; searches use SQLite until one is published\n");
         }
     }
     else
@@ -233,12 +229,14 @@ void ChopsBrowserPluginProcessor::changeProgramName (int index, const juce::Stri
 //==============================================================================
 void ChopsBrowserPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    transportSource.prepareToPlay(samplesPerBlock, sampleRate);
+    previewEngine->prepareToPlay(sampleRate, samplesPerBlock);
+    keySampler->prepareToPlay(sampleRate, samplesPerBlock);
 }
 
 void ChopsBrowserPluginProcessor::releaseResources()
 {
-    transportSource.releaseResources();
+    previewEngine->releaseResources();
+    keySampler->releaseResources();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -266,8 +264,6 @@ bool ChopsBrowserPluginProcessor::isBusesLayoutSupported (const BusesLayout& lay
 void ChopsBrowserPluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused(midiMessages);
-    
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -276,24 +272,15 @@ void ChopsBrowserPluginProcessor::processBlock (juce::AudioBuffer<float>& buffer
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Preview audio playback
-    if (previewIsPlaying)
-    {
-        juce::AudioSourceChannelInfo info(buffer);
-        transportSource.getNextAudioBlock(info);
-        
-        // Check if preview has finished
-        if (!transportSource.isPlaying())
-        {
-            previewIsPlaying = false;
-            sendChangeMessage(); // Notify UI
-        }
-    }
-    else
-    {
-        // When not previewing, just pass through input
-        // (or silence if this is being used as a generator)
-    }
+    // Preview audio playback; when not previewing, the input passes through
+    // (or silence if this is being used as a generator)
+    previewEngine->render(buffer, 0, buffer.getNumSamples());
+    
+    // Sampler mode plays on top, sample-accurately from the incoming MIDI
+    keySampler->render(buffer, midiMessages);
+    
+    // The held chord, for the editor to search for
+    chordDetector.process(midiMessages);
 }
 
 //==============================================================================
@@ -319,6 +306,18 @@ void ChopsBrowserPluginProcessor::getStateInformation (juce::MemoryBlock& destDa
     // Store last search query
     xml.setAttribute("lastSearchQuery", lastSearchQuery);
     
+    // Sampler mode, and the pinned keys if any
+    xml.setAttribute("samplerEnabled", isSamplerEnabled());
+    xml.setAttribute("samplerPinned", samplerPinned);
+    if (samplerPinned)
+    {
+        auto* keys = xml.createNewChildElement("SamplerKeys");
+        for (auto& path : samplerKeyPaths)
+            keys->createNewChildElement("Key")->setAttribute("path", path);
+    }
+    
+    xml.setAttribute("chordDetectionEnabled", isChordDetectionEnabled());
+    
     copyXmlToBinary(xml, destData);
 }
 
@@ -333,6 +332,20 @@ void ChopsBrowserPluginProcessor::setStateInformation (const void* data, int siz
         juce::String dbPath = xmlState->getStringAttribute("databasePath");
         lastSearchQuery = xmlState->getStringAttribute("lastSearchQuery");
         
+        samplerPinned = false;
+        if (xmlState->getBoolAttribute("samplerPinned"))
+        {
+            juce::StringArray pinnedPaths;
+            if (auto* keys = xmlState->getChildByName("SamplerKeys"))
+                for (auto* key : keys->getChildWithTagNameIterator("Key"))
+                    pinnedPaths.add(key->getStringAttribute("path"));
+            
+            mapSamplerKeys(pinnedPaths);
+            samplerPinned = true;
+        }
+        setSamplerEnabled(xmlState->getBoolAttribute("samplerEnabled"));
+        setChordDetectionEnabled(xmlState->getBoolAttribute("chordDetectionEnabled"));
+        
         if (dbPath.isNotEmpty())
             setDatabasePath(dbPath);
     }
@@ -358,10 +371,15 @@ void ChopsBrowserPluginProcessor::setDatabasePath(const juce::String& path)
     {
         logFile.appendText("File size: " + juce::String(dbFile.getSize()) + " bytes\n");
         
-        if (databaseManager.initialize(juce::File(path)))
+        if (databaseManager.initialize(juce::File(path), DatabaseSyncManager::Role::browser))
         {
             logFile.appendText("✅ Database initialized successfully: " + path + "\n");
             juce::Logger::writeToLog("Database initialized successfully: " + path);
+            openLibrarySnapshot();
+            searchService.setDatabase(dbFile, ChopsConfig::getLibrarySnapshotFile(dbFile));
+            logFile.appendText("Library snapshot: " + (librarySnapshot.isValid()
+                               ? juce::String(librarySnapshot.getNumSamples()) + " samples mapped"
+                               : juce::String("not available, using SQLite")) + "\n");
             sendChangeMessage(); // Notify UI that database has changed
         }
         else
@@ -411,20 +429,19 @@ std::vector<ChopsDatabase::SampleInfo> ChopsBrowserPluginProcessor::searchSample
     logFile.appendText("  - Min rating: " + juce::String(criteria.minRating) + "\n");
     logFile.appendText("  - Favorites only: " + juce::String(criteria.favoritesOnly ? "YES" : "NO") + "\n");
     
-    auto* db = databaseManager.getReadDatabase();
-    if (!db || !db->isOpen())
+    if (!isDatabaseAvailable())
     {
         logFile.appendText("❌ ERROR: Database not available for search!\n");
-        logFile.appendText("  - Database manager exists: " + juce::String(db ? "YES" : "NO") + "\n");
-        if (db)
-            logFile.appendText("  - Database is open: " + juce::String(db->isOpen() ? "YES" : "NO") + "\n");
         logFile.appendText("==============================\n\n");
         
         juce::Logger::writeToLog("Database not available for search");
         return {};
     }
     
-    logFile.appendText("✅ Database is available and open\n");
+    logFile.appendText("✅ Database is available\n");
+    
+    // A synchronous search is the newest request; drop any typing search still in flight
+    searchService.cancel();
     
     // Store the last search query for state saving
     if (!criteria.searchText.isEmpty())
@@ -432,18 +449,32 @@ std::vector<ChopsDatabase::SampleInfo> ChopsBrowserPluginProcessor::searchSample
     else if (!criteria.rootNote.isEmpty() && !criteria.chordType.isEmpty())
         lastSearchQuery = criteria.rootNote + criteria.chordType;
     
-    logFile.appendText("Calling database search...\n");
+    databaseManager.noteActivity();
+    metadataWriteBehind.noteActivity();
     
-    // Use the database search method
-    auto results = db->searchSamples(
-        criteria.searchText,
-        criteria.rootNote,
-        criteria.chordType,
-        criteria.filterByExtensions ? (criteria.hasExtensions ? ChopsDatabase::Yes : ChopsDatabase::No) : ChopsDatabase::DontCare,
-        criteria.filterByAlterations ? (criteria.hasAlterations ? ChopsDatabase::Yes : ChopsDatabase::No) : ChopsDatabase::DontCare,
-        100, // limit
-        0    // offset
-    );
+    auto extensionsFilter = criteria.filterByExtensions ? (criteria.hasExtensions ? ChopsDatabase::Yes : ChopsDatabase::No) : ChopsDatabase::DontCare;
+    auto alterationsFilter = criteria.filterByAlterations ? (criteria.hasAlterations ? ChopsDatabase::Yes : ChopsDatabase::No) : ChopsDatabase::DontCare;
+    
+    std::vector<ChopsDatabase::SampleInfo> results;
+    if (librarySnapshot.isValid())
+    {
+        logFile.appendText("Searching library snapshot...\n");
+        results = librarySnapshot.searchSamples(criteria.searchText, criteria.rootNote, criteria.chordType,
+                                                extensionsFilter, alterationsFilter, 100, 0, criteria.format);
+        
+        for (auto& sample : results)
+        {
+            if (locallyModifiedIds.contains(sample.id))
+                if (auto fresh = databaseManager.getSample(sample.id))
+                    sample = *fresh;
+        }
+    }
+    else
+    {
+        logFile.appendText("Calling database search...\n");
+        results = databaseManager.getReadDatabase()->searchSamples(criteria.searchText, criteria.rootNote, criteria.chordType,
+                                    extensionsFilter, alterationsFilter, 100, 0, criteria.format).toVector();
+    }
     
     logFile.appendText("Database search completed\n");
     logFile.appendText("Results: " + juce::String(results.size()) + " samples found\n");
@@ -466,7 +497,7 @@ std::vector<ChopsDatabase::SampleInfo> ChopsBrowserPluginProcessor::searchSample
         
         // Let's do a debug search with broader criteria
         logFile.appendText("Trying broader search for debugging...\n");
-        auto debugResults = db->searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, 10, 0);
+        auto debugResults = databaseManager.getReadDatabase()->searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, 10, 0);
         logFile.appendText("Broad search found: " + juce::String(debugResults.size()) + " samples\n");
         
         if (!debugResults.empty())
@@ -489,6 +520,28 @@ std::vector<ChopsDatabase::SampleInfo> ChopsBrowserPluginProcessor::searchSample
     return results;
 }
 
+void ChopsBrowserPluginProcessor::searchSamplesAsync(const SearchCriteria& criteria,
+                                                     std::function<void(const std::vector<ChopsDatabase::SampleInfo>&)> onResults)
+{
+    if (!criteria.searchText.isEmpty())
+        lastSearchQuery = criteria.searchText;
+    else if (!criteria.rootNote.isEmpty() && !criteria.chordType.isEmpty())
+        lastSearchQuery = criteria.rootNote + criteria.chordType;
+    
+    databaseManager.noteActivity();
+    metadataWriteBehind.noteActivity();
+    
+    SearchService::Request request;
+    request.query = criteria.searchText;
+    request.rootNote = criteria.rootNote;
+    request.chordType = criteria.chordType;
+    request.hasExtensions = criteria.filterByExtensions ? (criteria.hasExtensions ? ChopsDatabase::Yes : ChopsDatabase::No) : ChopsDatabase::DontCare;
+    request.hasAlterations = criteria.filterByAlterations ? (criteria.hasAlterations ? ChopsDatabase::Yes : ChopsDatabase::No) : ChopsDatabase::DontCare;
+    request.format = criteria.format;
+    
+    searchService.search(request, std::move(onResults));
+}
+
 void ChopsBrowserPluginProcessor::loadSampleForPreview(const juce::String& filePath)
 {
     juce::File file(filePath);
@@ -510,81 +563,123 @@ void ChopsBrowserPluginProcessor::loadSampleForPreview(const juce::String& fileP
     }
     
     // Load new file
-    auto* reader = formatManager->createReaderFor(file);
-    
-    if (reader != nullptr)
+    if (previewEngine->load(file))
     {
         currentSamplePath = filePath;
-        auto newSource = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource = std::move(newSource);
-        
         juce::Logger::writeToLog("Sample loaded for preview: " + file.getFileName());
     }
-    else
-    {
-        juce::Logger::writeToLog("Could not create reader for file: " + filePath);
-    }
+}
+
+void ChopsBrowserPluginProcessor::prefetchPreviews(const juce::StringArray& filePaths)
+{
+    juce::Array<juce::File> files;
+    for (auto& path : filePaths)
+        files.add(juce::File(path));
+    
+    previewEngine->prefetch(files);
 }
 
 void ChopsBrowserPluginProcessor::playPreview()
 {
-    if (readerSource != nullptr)
-    {
-        transportSource.setPosition(0);
-        transportSource.start();
-        previewIsPlaying = true;
-        sendChangeMessage();
-        
-        juce::Logger::writeToLog("Preview started");
-    }
-    else
-    {
-        juce::Logger::writeToLog("No sample loaded for preview");
-    }
+    previewEngine->play();
+    juce::Logger::writeToLog("Preview started");
 }
 
 void ChopsBrowserPluginProcessor::stopPreview()
 {
-    if (previewIsPlaying)
+    if (previewEngine->isPlaying())
     {
-        transportSource.stop();
-        previewIsPlaying = false;
-        sendChangeMessage();
-        
+        previewEngine->stop();
         juce::Logger::writeToLog("Preview stopped");
     }
 }
 
 void ChopsBrowserPluginProcessor::seekPreview(float position)
 {
-    if (readerSource != nullptr && position >= 0.0f && position <= 1.0f)
+    if (position >= 0.0f && position <= 1.0f && previewEngine->getLengthInSeconds() > 0.0)
     {
-        double lengthInSeconds = transportSource.getLengthInSeconds();
-        if (lengthInSeconds > 0.0)
-        {
-            double seekPosition = position * lengthInSeconds;
-            transportSource.setPosition(seekPosition);
-            
-            juce::Logger::writeToLog("Preview seeked to: " + juce::String(position * 100.0f, 1) + "%");
-        }
+        previewEngine->seek(position);
+        juce::Logger::writeToLog("Preview seeked to: " + juce::String(position * 100.0f, 1) + "%");
     }
 }
 
 float ChopsBrowserPluginProcessor::getPreviewProgress() const
 {
-    if (readerSource != nullptr && transportSource.getLengthInSeconds() > 0)
+    return static_cast<float>(previewEngine->getProgress());
+}
+
+//==============================================================================
+void ChopsBrowserPluginProcessor::setSamplerEnabled(bool shouldBeEnabled)
+{
+    keySampler->setEnabled(shouldBeEnabled);
+    juce::Logger::writeToLog(juce::String("Sampler mode ") + (shouldBeEnabled ? "enabled" : "disabled"));
+}
+
+void ChopsBrowserPluginProcessor::setSamplerPinned(bool shouldBePinned)
+{
+    samplerPinned = shouldBePinned;
+    juce::Logger::writeToLog(juce::String("Sampler keys ") + (shouldBePinned ? "pinned" : "following results"));
+}
+
+void ChopsBrowserPluginProcessor::setSamplerResults(const std::vector<ChopsDatabase::SampleInfo>& results)
+{
+    if (samplerPinned)
+        return;
+    
+    juce::StringArray paths;
+    for (size_t i = 0; i < results.size() && paths.size() < KeySampler::maxKeys; ++i)
+        paths.add(results[i].filePath);
+    
+    mapSamplerKeys(paths);
+}
+
+void ChopsBrowserPluginProcessor::mapSamplerKeys(const juce::StringArray& filePaths)
+{
+    if (filePaths == samplerKeyPaths)
+        return;
+    
+    samplerKeyPaths = filePaths;
+    
+    juce::Array<juce::File> files;
+    for (auto& path : filePaths)
+        files.add(juce::File(path));
+    
+    keySampler->setFiles(files);
+}
+
+//==============================================================================
+void ChopsBrowserPluginProcessor::setChordDetectionEnabled(bool shouldBeEnabled)
+{
+    chordDetector.setEnabled(shouldBeEnabled);
+    juce::Logger::writeToLog(juce::String("Chord detection ") + (shouldBeEnabled ? "enabled" : "disabled"));
+}
+
+void ChopsBrowserPluginProcessor::openLibrarySnapshot()
+{
+    locallyModifiedIds.clear();
+    if (currentDatabasePath.isEmpty() || !librarySnapshot.open(ChopsConfig::getLibrarySnapshotFile(juce::File(currentDatabasePath))))
+        librarySnapshot.close();
+}
+
+void ChopsBrowserPluginProcessor::databaseUpdated()
+{
+    // The database manager polls the snapshot file, so this is where a republish lands
+    if (!librarySnapshot.isValid() || librarySnapshot.isOutOfDate())
     {
-        return static_cast<float>(transportSource.getCurrentPosition() / 
-                                  transportSource.getLengthInSeconds());
+        openLibrarySnapshot();
+        searchService.snapshotRepublished();
     }
-    return 0.0f;
+}
+
+void ChopsBrowserPluginProcessor::sampleMetadataChanged(int sampleId)
+{
+    locallyModifiedIds.add(sampleId);
+    searchService.markSampleModified(sampleId);
 }
 
 bool ChopsBrowserPluginProcessor::isDatabaseAvailable() const
 {
-    auto* db = databaseManager.getReadDatabase();
-    return db && db->isOpen();
+    return databaseManager.isInitialized();
 }
 
 juce::String ChopsBrowserPluginProcessor::getDatabaseInfo() const
@@ -593,7 +688,7 @@ juce::String ChopsBrowserPluginProcessor::getDatabaseInfo() const
     if (!db || !db->isOpen())
         return "No database connected";
     
-    return db->getDatabaseInfo();
+    return db->getDatabaseInfo() + databaseManager.getMaintenanceReport().toString();
 }
 
 //==============================================================================
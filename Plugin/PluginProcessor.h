@@ -3,6 +3,12 @@
 #include <JuceHeader.h>
 #include "../Source/Database/ChopsDatabase.h"
 #include "../Source/Database/DatabaseSyncManager.h"
+#include "../Source/Database/LibrarySnapshot.h"
+#include "../Source/Database/SearchService.h"
+#include "../Source/Core/MetadataWriteBehind.h"
+#include "../Source/Audio/PreviewEngine.h"
+#include "../Source/Audio/KeySampler.h"
+#include "../Source/Audio/ChordDetector.h"
 #include <memory>
 
 //==============================================================================
@@ -13,7 +19,8 @@
     with preview capabilities and drag & drop functionality.
 */
 class ChopsBrowserPluginProcessor : public juce::AudioProcessor,
-                                    public juce::ChangeBroadcaster
+                                    public juce::ChangeBroadcaster,
+                                    private DatabaseSyncManager::Listener
 {
 public:
     //==============================================================================
@@ -75,18 +82,38 @@ public:
         bool hasAlterations = false;
         bool filterByExtensions = false;
         bool filterByAlterations = false;
+        ChopsDatabase::FormatFilter format;
     };
     
     std::vector<ChopsDatabase::SampleInfo> searchSamples(const SearchCriteria& criteria);
     
+    // Runs the search on a background thread. Supersedes any search still in flight;
+    // onResults is called on the message thread only for the newest request.
+    void searchSamplesAsync(const SearchCriteria& criteria,
+                            std::function<void(const std::vector<ChopsDatabase::SampleInfo>&)> onResults);
+    
     // Preview functionality
     void loadSampleForPreview(const juce::String& filePath);
+    void prefetchPreviews(const juce::StringArray& filePaths); // Most likely to be auditioned first
     void playPreview();
     void stopPreview();
     void seekPreview(float position); // 0.0 to 1.0
-    bool isPreviewPlaying() const { return previewIsPlaying; }
+    bool isPreviewPlaying() const { return previewEngine != nullptr && previewEngine->isPlaying(); }
     float getPreviewProgress() const;
     
+    // Sampler mode: the result list (or a pinned set) played from MIDI, one sample per key
+    void setSamplerEnabled(bool shouldBeEnabled);
+    bool isSamplerEnabled() const { return keySampler != nullptr && keySampler->isEnabled(); }
+    void setSamplerPinned(bool shouldBePinned); // Keeps the current keys while browsing
+    bool isSamplerPinned() const { return samplerPinned; }
+    void setSamplerResults(const std::vector<ChopsDatabase::SampleInfo>& results);
+    
+    // Chord detection: names the chord held on the MIDI input, for the editor to search for
+    void setChordDetectionEnabled(bool shouldBeEnabled);
+    bool isChordDetectionEnabled() const { return chordDetector.isEnabled(); }
+    ChordDetector::Chord getDetectedChord() const { return chordDetector.getLatest(); }
+    juce::String getChordTypeKey(int type) const { return chordDetector.getTypeKey(type); }
+    
     // Drag and drop
     juce::String getCurrentSamplePath() const { return currentSamplePath; }
     
@@ -108,24 +135,39 @@ public:
 private:
     //==============================================================================
     // Database
-    DatabaseSyncManager databaseManager;
+    DatabaseSyncManager databaseManager; // A browser: one SQLite connection, opened by the first edit
+    MetadataWriteBehind metadataWriteBehind { databaseManager }; // Carries edits back into the files
     juce::String chopsLibraryPath;
     juce::String currentDatabasePath;
     
-    // Preview player
+    // Browsing reads come from the mapped snapshot; rows edited through this
+    // instance since the snapshot was published are re-read from SQLite
+    LibrarySnapshot librarySnapshot;
+    juce::SortedSet<int> locallyModifiedIds;
+    void openLibrarySnapshot();
+    void databaseUpdated() override;
+    void sampleMetadataChanged(int sampleId) override;
+    
+    // Typing searches run here so stale queries never block the message thread
+    SearchService searchService;
+    
+    // Preview player; processBlock only talks to it through its lock-free queue
     std::unique_ptr<juce::AudioFormatManager> formatManager;
-    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
-    juce::AudioTransportSource transportSource;
-    juce::AudioBuffer<float> previewBuffer;
-    bool previewIsPlaying = false;
+    std::unique_ptr<PreviewEngine> previewEngine;
     juce::String currentSamplePath;
     
+    // Sampler mode; processBlock feeds it the MIDI
+    std::unique_ptr<KeySampler> keySampler;
+    juce::StringArray samplerKeyPaths; // What's mapped, from baseNote up
+    bool samplerPinned = false;
+    void mapSamplerKeys(const juce::StringArray& filePaths);
+    
+    // Chord detection; processBlock feeds it the MIDI too
+    ChordDetector chordDetector;
+    
     // State
     juce::String lastSearchQuery;
     
-    // Thread safety
-    juce::CriticalSection audioLock;
-    
     // Initialize components
     void initializeAudioFormats();
     void initializeDatabase();
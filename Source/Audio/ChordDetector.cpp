@@ -0,0 +1,201 @@
+#include "ChordDetector.h"
+#include "../Core/ChordTypes.h"
+#include <limits>
+
+namespace
+{
+    // Packing of the published word: type, root, bass, a valid flag and a serial number
+    constexpr juce::uint32 validBit = 1u << 16;
+    constexpr int serialShift = 17;
+}
+
+ChordDetector::ChordDetector()
+{
+    buildTable();
+}
+
+//==============================================================================
+ChordDetector::Chord ChordDetector::getLatest() const noexcept
+{
+    auto word = latest.load();
+    Chord chord;
+    if ((word & validBit) != 0)
+    {
+        chord.type = (int) (word & 0xff);
+        chord.root = (int) ((word >> 8) & 0xf);
+        chord.bass = (int) ((word >> 12) & 0xf);
+    }
+    chord.serial = word >> serialShift;
+    return chord;
+}
+
+juce::String ChordDetector::getTypeKey(int type) const
+{
+    return juce::isPositiveAndBelow(type, (int) typeKeys.size()) ? typeKeys[(size_t) type] : juce::String();
+}
+
+juce::String ChordDetector::getPitchClassName(int pitchClass)
+{
+    static const char* const names[] = { "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B" };
+    return juce::isPositiveAndBelow(pitchClass, 12) ? juce::String(names[pitchClass]) : juce::String();
+}
+
+//==============================================================================
+void ChordDetector::buildTable()
+{
+    auto types = ChordTypes::getStandardizedChordTypes();
+
+    // Sorted, so ties between types with the same notes (A4 and d5, say) always go the same way
+    juce::StringArray keys;
+    for (auto& entry : types)
+        keys.add(entry.first);
+    keys.sort(false);
+
+    std::array<int, numPitchClassSets> bestScore;
+    bestScore.fill(std::numeric_limits<int>::max());
+
+    for (auto& key : keys)
+    {
+        const auto& type = types[key];
+
+        juce::uint32 chordTones = 0;
+        for (auto& interval : type.intervals)
+        {
+            auto semitones = parseInterval(interval);
+            if (semitones >= 0)
+                chordTones |= 1u << (semitones % 12);
+        }
+
+        if (juce::countNumberOfBits(chordTones) < 2 || typeKeys.size() > 0xff)
+            continue;
+
+        auto typeIndex = (juce::uint8) typeKeys.size();
+        typeKeys.push_back(key);
+
+        // Voicings of four notes or more often leave the fifth out
+        juce::uint32 variants[2] = { chordTones, 0 };
+        if (juce::countNumberOfBits(chordTones) >= 4 && (chordTones & (1u << 7)) != 0)
+            variants[1] = chordTones & ~(1u << 7);
+
+        for (int omitted = 0; omitted < 2; ++omitted)
+        {
+            if (variants[omitted] == 0)
+                continue;
+
+            for (int rootAboveBass = 0; rootAboveBass < 12; ++rootAboveBass)
+            {
+                // The same tones, counted up from a bass that sits rootAboveBass below the root
+                juce::uint32 fromBass = ((variants[omitted] << rootAboveBass) | (variants[omitted] >> (12 - rootAboveBass))) & 0xfff;
+                if ((fromBass & 1u) == 0)
+                    continue; // The bass has to be one of the chord's tones
+
+                auto score = omitted * 1000 + type.complexity * 10 + (rootAboveBass != 0 ? 1 : 0);
+                if (score < bestScore[fromBass])
+                {
+                    bestScore[fromBass] = score;
+                    table[fromBass] = { (juce::int8) rootAboveBass, typeIndex };
+                }
+            }
+        }
+    }
+}
+
+int ChordDetector::parseInterval(const juce::String& interval)
+{
+    // "b3", "#5", "bb7", "9", "13" ... as ChordTypes writes them
+    static const int majorScale[] = { 0, 2, 4, 5, 7, 9, 11 };
+
+    int accidental = 0, i = 0;
+    for (; i < interval.length(); ++i)
+    {
+        if (interval[i] == 'b')
+            --accidental;
+        else if (interval[i] == '#')
+            ++accidental;
+        else
+            break;
+    }
+
+    auto degree = interval.substring(i).getIntValue();
+    if (degree < 1)
+        return -1;
+
+    auto octaves = (degree - 1) / 7;
+    return juce::jmax(0, octaves * 12 + majorScale[(degree - 1) % 7] + accidental);
+}
+
+//==============================================================================
+void ChordDetector::process(const juce::MidiBuffer& midi) noexcept
+{
+    bool on = enabled.load();
+    if (on != wasEnabled)
+    {
+        // Notes released while switched off were never seen; start over
+        held = {};
+        wasEnabled = on;
+    }
+
+    if (!on)
+        return;
+
+    bool added = false;
+    for (const auto metadata : midi)
+        handle(metadata.data, metadata.numBytes, added);
+
+    if (added)
+        detect();
+}
+
+void ChordDetector::handle(const juce::uint8* data, int numBytes, bool& added) noexcept
+{
+    // Raw bytes rather than MidiMessage, which can allocate for long messages
+    if (numBytes < 3)
+        return;
+
+    auto status = data[0] & 0xf0;
+    auto note = data[1] & 0x7f;
+    auto bit = (juce::uint64) 1 << (note & 63);
+
+    if (status == 0x90 && data[2] > 0)
+    {
+        held[(size_t) (note >> 6)] |= bit;
+        added = true;
+    }
+    else if (status == 0x80 || status == 0x90)
+    {
+        held[(size_t) (note >> 6)] &= ~bit;
+    }
+    else if (status == 0xb0 && (data[1] == 120 || data[1] == 123)) // All sound off, all notes off
+    {
+        held = {};
+    }
+}
+
+void ChordDetector::detect() noexcept
+{
+    int bass = -1;
+    juce::uint32 pitchClasses = 0;
+    for (int note = 0; note < 128; ++note)
+    {
+        if ((held[(size_t) (note >> 6)] & ((juce::uint64) 1 << (note & 63))) == 0)
+            continue;
+
+        if (bass < 0)
+            bass = note % 12;
+        pitchClasses |= 1u << (note % 12);
+    }
+
+    if (juce::countNumberOfBits(pitchClasses) < 2)
+        return;
+
+    // Turn the set so the bass is bit 0
+    auto fromBass = ((pitchClasses >> bass) | (pitchClasses << (12 - bass))) & 0xfff;
+    const auto& match = table[fromBass];
+    if (match.rootAboveBass < 0)
+        return; // Nothing we have a name for; the last chord stands
+
+    auto root = (bass + match.rootAboveBass) % 12;
+    ++serial;
+    latest = (juce::uint32) match.type | ((juce::uint32) root << 8) | ((juce::uint32) bass << 12) | validBit
+           | (serial << serialShift);
+}
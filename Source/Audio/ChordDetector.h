@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+/**
+ * ChordDetector - names the chord being held on incoming MIDI
+ *
+ * The audio thread tracks which notes are down and, whenever a block adds one, looks
+ * the held pitch classes up in a table: 4096 entries, one per set of pitch classes
+ * relative to the lowest note, each giving the best chord for that set (root relative to
+ * the bass, and type). The table is built once, from ChordTypes, when the detector is
+ * constructed, so detection is a few bit operations and an array read; nothing
+ * allocates or locks.
+ *
+ * The result is published as a single atomic word with a serial number, for the message
+ * thread to poll and debounce. Releasing notes never publishes: letting go of a chord
+ * one finger at a time would otherwise name every subset on the way out.
+ *
+ * Matching prefers, in order: every held pitch class being a chord tone with nothing
+ * missing; then the same with the fifth left out of a chord of four or more notes; the
+ * simplest type (ChordTypes complexity); and the bass as the root. So C E G A is C6 and
+ * A C E G is Am7, while C E Bb is C7 without its fifth.
+ *
+ * Threading: setEnabled and getLatest from any thread; process for the audio thread.
+ */
+class ChordDetector
+{
+public:
+    struct Chord
+    {
+        int root = -1;              // Pitch class, 0 = C; -1 if nothing has been detected
+        int bass = -1;              // Pitch class of the lowest held note
+        int type = -1;              // Index into getTypeKeys()
+        juce::uint32 serial = 0;    // Bumped on every detection, even of the same chord
+
+        bool isValid() const noexcept { return root >= 0 && type >= 0; }
+        bool isSameChordAs(const Chord& other) const noexcept
+        {
+            return root == other.root && bass == other.bass && type == other.type;
+        }
+    };
+
+    ChordDetector();
+
+    void setEnabled(bool shouldBeEnabled)       { enabled = shouldBeEnabled; }
+    bool isEnabled() const noexcept             { return enabled.load(); }
+
+    Chord getLatest() const noexcept;
+
+    // The standardized ChordTypes key for a Chord's type, e.g. "min7"
+    juce::String getTypeKey(int type) const;
+
+    // Spelt the way the browser's chord selector spells them (C#, Eb, F#, Ab, Bb)
+    static juce::String getPitchClassName(int pitchClass);
+
+    //==============================================================================
+    // Audio thread
+    void process(const juce::MidiBuffer& midi) noexcept;
+
+private:
+    struct Match
+    {
+        juce::int8 rootAboveBass = -1;
+        juce::uint8 type = 0;
+    };
+
+    static constexpr int numPitchClassSets = 1 << 12;
+
+    std::vector<juce::String> typeKeys;
+    std::array<Match, numPitchClassSets> table;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<juce::uint32> latest { 0 };
+
+    // Audio thread only
+    std::array<juce::uint64, 2> held {};        // One bit per MIDI note
+    bool wasEnabled = false;
+    juce::uint32 serial = 0;
+
+    void buildTable();
+    static int parseInterval(const juce::String& interval);
+    void handle(const juce::uint8* data, int numBytes, bool& added) noexcept;
+    void detect() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChordDetector)
+};
@@ -0,0 +1,114 @@
+#include "ChordDetectorTest.h"
+
+//==============================================================================
+bool ChordDetectorTest::runAllTests()
+{
+    juce::Logger::writeToLog("=== CHORD DETECTOR TEST SUITE ===");
+
+    std::vector<TestResult> results;
+    results.push_back(testSixthsAndSevenths());
+    results.push_back(testSuspendedInversions());
+    results.push_back(testSlashBass());
+
+    int passedTests = 0;
+    for (const auto& result : results)
+    {
+        if (result.success)
+            ++passedTests;
+        juce::Logger::writeToLog(result.toString());
+    }
+
+    juce::Logger::writeToLog(juce::String::formatted("Tests: %d/%d passed", passedTests, (int) results.size()));
+    return passedTests == (int) results.size();
+}
+
+//==============================================================================
+ChordDetectorTest::TestResult ChordDetectorTest::testSixthsAndSevenths()
+{
+    // C6 and Am7 are the same four notes. With A in the bass it's Am7; anywhere else
+    // the two tie on complexity and C6 wins, so Am7/C is never reported.
+    return runCases("C6 vs Am7", {
+        { { 60, 64, 67, 69 }, "C maj6/C" },
+        { { 48, 57, 64, 67 }, "C maj6/C" },         // Spread, A inside the voicing
+        { { 57, 60, 64, 67 }, "A min7/A" },
+        { { 64, 67, 69, 72 }, "C maj6/E" },
+        { { 55, 57, 60, 64 }, "C maj6/G" },
+        { { 53, 57, 60, 62 }, "F maj6/F" },
+        { { 50, 53, 57, 60 }, "D min7/D" },
+        { { 60, 63, 67, 69 }, "C min6/C" },         // Cm6 against Am7b5
+        { { 57, 60, 63, 67 }, "A halfDim7/A" },
+    });
+}
+
+ChordDetectorTest::TestResult ChordDetectorTest::testSuspendedInversions()
+{
+    // Csus2 inverted is Gsus4 and the other way round. Root position goes to whichever
+    // the bass is the root of; with neither, the tie goes to sus2.
+    return runCases("sus2 vs sus4 inversions", {
+        { { 60, 62, 67 }, "C sus2/C" },
+        { { 55, 60, 62 }, "G sus4/G" },
+        { { 67, 72, 74 }, "G sus4/G" },
+        { { 62, 67, 72 }, "C sus2/D" },
+        { { 60, 65, 67 }, "C sus4/C" },
+        { { 65, 67, 72 }, "F sus2/F" },
+        { { 67, 72, 77 }, "F sus2/G" },
+    });
+}
+
+ChordDetectorTest::TestResult ChordDetectorTest::testSlashBass()
+{
+    // The bass has to be a chord tone; a foreign one names nothing
+    return runCases("Slash-bass chords", {
+        { { 64, 67, 72 }, "C maj/E" },
+        { { 55, 60, 64 }, "C maj/G" },
+        { { 58, 60, 64, 67 }, "C dom7/Bb" },
+        { { 60, 64, 70 }, "C dom7/C" },             // Fifth left out
+        { { 36, 52, 67, 84 }, "C maj/C" },          // Doubled across octaves
+        { { 62, 64, 67, 72 }, "none" },             // C/D
+        { { 53, 60, 64, 67 }, "none" },             // C/F
+    });
+}
+
+//==============================================================================
+ChordDetectorTest::TestResult ChordDetectorTest::runCases(const juce::String& name, const std::vector<Case>& cases)
+{
+    TestResult result;
+    result.message = name;
+
+    juce::StringArray failures;
+    for (const auto& testCase : cases)
+    {
+        auto detected = detect(testCase.notes);
+        if (detected == testCase.expected)
+            continue;
+
+        juce::StringArray noteNames;
+        for (auto note : testCase.notes)
+            noteNames.add(juce::MidiMessage::getMidiNoteName(note, true, true, 4));
+        failures.add(noteNames.joinIntoString(" ") + ": expected " + testCase.expected + ", got " + detected);
+    }
+
+    result.success = failures.isEmpty();
+    result.details = result.success ? juce::String(cases.size()) + " voicings"
+                                    : failures.joinIntoString("; ");
+    return result;
+}
+
+juce::String ChordDetectorTest::detect(const std::vector<int>& notes)
+{
+    ChordDetector detector;
+    detector.setEnabled(true);
+
+    juce::MidiBuffer midi;
+    int samplePosition = 0;
+    for (auto note : notes)
+        midi.addEvent(juce::MidiMessage::noteOn(1, note, (juce::uint8) 100), samplePosition++);
+    detector.process(midi);
+
+    auto chord = detector.getLatest();
+    if (!chord.isValid())
+        return "none";
+
+    return ChordDetector::getPitchClassName(chord.root) + " " + detector.getTypeKey(chord.type)
+         + "/" + ChordDetector::getPitchClassName(chord.bass);
+}
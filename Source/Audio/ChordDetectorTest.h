@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChordDetector.h"
+#include <vector>
+
+/**
+ * Tests for ChordDetector
+ *
+ * Table-driven: each case is a set of held MIDI notes and the chord it should be
+ * named as, concentrating on note sets that more than one chord could claim.
+ */
+class ChordDetectorTest
+{
+public:
+    struct TestResult
+    {
+        bool success = false;
+        juce::String message;
+        juce::String details;
+
+        juce::String toString() const
+        {
+            juce::String result = success ? "✅ PASS: " : "❌ FAIL: ";
+            result += message;
+            if (details.isNotEmpty())
+                result += "\n   Details: " + details;
+            return result;
+        }
+    };
+
+    struct Case
+    {
+        std::vector<int> notes;     // MIDI note numbers, pressed in this order
+        juce::String expected;      // "root type/bass" as describe() writes it, or "none"
+    };
+
+    bool runAllTests();
+
+    TestResult testSixthsAndSevenths();
+    TestResult testSuspendedInversions();
+    TestResult testSlashBass();
+
+private:
+    static TestResult runCases(const juce::String& name, const std::vector<Case>& cases);
+
+    // What a fresh detector names these notes, e.g. "C maj6/E"
+    static juce::String detect(const std::vector<int>& notes);
+};
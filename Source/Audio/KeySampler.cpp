@@ -0,0 +1,430 @@
+#include "KeySampler.h"
+#include "SincResampler.h"
+
+KeySampler::KeySampler(PreviewCache& previewCache)
+    : juce::Thread("ChopsKeySampler"), cache(previewCache)
+{
+}
+
+KeySampler::~KeySampler()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+
+    // The audio thread has stopped calling render() by now, so its side can be cleaned up here
+    delete current;
+    for (auto* map : draining)
+        delete map;
+
+    auto pending = mapFifo.read(mapFifo.getNumReady());
+    pending.forEach([this](int index) { delete incoming[index]; });
+
+    collectRetiredMaps();
+}
+
+//==============================================================================
+void KeySampler::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled.exchange(shouldBeEnabled) != shouldBeEnabled)
+        requestBuild(); // Turning off builds an empty map, which frees the old one
+}
+
+void KeySampler::setFiles(const juce::Array<juce::File>& files)
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+        requestedFiles.clearQuick();
+        for (int i = 0; i < juce::jmin(files.size(), maxKeys); ++i)
+            requestedFiles.add(files.getReference(i));
+    }
+    requestBuild();
+}
+
+void KeySampler::requestBuild()
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+        mapRequested = true;
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+    notify();
+}
+
+//==============================================================================
+void KeySampler::run()
+{
+    while (!threadShouldExit())
+    {
+        collectRetiredMaps();
+
+        juce::Array<juce::File> files;
+        bool requested = false;
+        {
+            const juce::ScopedLock sl(requestLock);
+            std::swap(requested, mapRequested);
+            files = requestedFiles;
+        }
+
+        // Not prepared yet: prepareToPlay() asks again once the rate is known
+        auto rate = hostRate.load();
+        if (!requested || rate <= 0.0)
+        {
+            wait(500); // Wakes now and then to free maps the audio thread has finished with
+            continue;
+        }
+
+        auto map = enabled.load() ? buildMap(files, rate) : std::make_unique<KeyMap>();
+        if (map == nullptr)
+            continue; // Superseded while building
+
+        if (!enabled.load())
+            builtHeads.clear();
+
+        int playable = 0;
+        for (auto& head : map->keys)
+            playable += head != nullptr ? 1 : 0;
+
+        map->sampleRate = rate;
+        while (!threadShouldExit() && !send(map))
+        {
+            // The audio thread isn't running, or hasn't caught up yet
+            wait(50);
+            collectRetiredMaps();
+
+            const juce::ScopedLock sl(requestLock);
+            if (mapRequested)
+                break;
+        }
+
+        if (map == nullptr)
+            mappedKeys = playable;
+    }
+}
+
+std::unique_ptr<KeySampler::KeyMap> KeySampler::buildMap(const juce::Array<juce::File>& files, double rate)
+{
+    auto map = std::make_unique<KeyMap>();
+    std::unordered_map<juce::String, std::shared_ptr<const DecodedHead>> heads;
+
+    for (auto& file : files)
+    {
+        {
+            const juce::ScopedLock sl(requestLock);
+            if (mapRequested || threadShouldExit())
+                return nullptr;
+        }
+
+        std::shared_ptr<const DecodedHead> head;
+        auto path = file.getFullPathName();
+        auto previous = builtHeads.find(path);
+        if (previous != builtHeads.end() && previous->second->sampleRate == rate
+            && previous->second->modified == file.getLastModificationTime() && previous->second->fileSize == file.getSize())
+        {
+            head = previous->second; // Same file at the same rate as last time
+        }
+        else if (file.existsAsFile())
+        {
+            head = cache.findOrDecode(file);
+            if (head != nullptr && !SincResampler::isIdentity(head->sampleRate, rate))
+                head = resample(head, rate);
+        }
+
+        // Files that can't be read keep their key, so the rest stay where the list has them
+        if (head != nullptr)
+            heads[path] = head;
+        map->keys.push_back(std::move(head));
+    }
+
+    builtHeads = std::move(heads);
+    return map;
+}
+
+std::shared_ptr<const DecodedHead> KeySampler::resample(const std::shared_ptr<const DecodedHead>& head, double rate)
+{
+    SincResampler resampler(head->sampleRate, rate, head->audio.getNumChannels());
+
+    auto result = std::make_shared<DecodedHead>();
+    result->file = head->file;
+    result->modified = head->modified;
+    result->fileSize = head->fileSize;
+    result->sampleRate = rate;
+    result->lengthInSamples = resampler.getOutputLength(head->lengthInSamples);
+
+    auto numFrames = (int) resampler.getOutputLength(head->getNumFrames());
+    result->audio.setSize(head->audio.getNumChannels(), juce::jmax(1, numFrames));
+    result->audio.clear();
+
+    auto pushed = (int) resampler.reset(0);
+    bool padded = false;
+    for (int done = 0; done < numFrames;)
+    {
+        done += resampler.process(result->audio, done, numFrames - done);
+        if (done == numFrames)
+            break;
+
+        if (pushed < head->getNumFrames())
+        {
+            auto count = juce::jmin(resampler.getFreeSpace(), head->getNumFrames() - pushed);
+            resampler.push(head->audio, pushed, count);
+            pushed += count;
+        }
+        else if (!padded)
+        {
+            resampler.pushEndPadding();
+            padded = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return result;
+}
+
+bool KeySampler::send(std::unique_ptr<KeyMap>& map)
+{
+    // Each map applied retires at most one, and the draining ones plus the current one
+    // can come back besides; leave room for all of that in the retired queue
+    if (mapFifo.getNumReady() + retiredFifo.getNumReady() + maxDraining + 1 >= queueSize - 1)
+        return false;
+
+    auto scope = mapFifo.write(1);
+    scope.forEach([this, &map](int index) { incoming[index] = map.release(); });
+    return true;
+}
+
+void KeySampler::collectRetiredMaps()
+{
+    auto scope = retiredFifo.read(retiredFifo.getNumReady());
+    scope.forEach([this](int index) {
+        delete retired[index];
+        retired[index] = nullptr;
+    });
+}
+
+//==============================================================================
+void KeySampler::prepareToPlay(double sampleRate, int maximumBlockSize)
+{
+    juce::ignoreUnused(maximumBlockSize);
+    attackStep = (float) (1.0 / (attackSeconds * sampleRate));
+    releaseStep = (float) (1.0 / (releaseSeconds * sampleRate));
+
+    // Heads are resampled to the host rate up front, so a new rate needs a new map
+    if (hostRate.exchange(sampleRate) != sampleRate)
+        requestBuild();
+}
+
+void KeySampler::releaseResources()
+{
+    for (auto& voice : voices)
+        if (voice.active)
+            stopVoice(voice);
+}
+
+void KeySampler::retire(KeyMap* map) noexcept
+{
+    if (map == nullptr)
+        return;
+
+    auto scope = retiredFifo.write(1);
+    scope.forEach([this, map](int index) { retired[index] = map; });
+    jassert(scope.blockSize1 + scope.blockSize2 == 1); // send() keeps room for this
+}
+
+void KeySampler::applyMaps() noexcept
+{
+    auto scope = mapFifo.read(mapFifo.getNumReady());
+    scope.forEach([this](int index) {
+        auto* map = incoming[index];
+        incoming[index] = nullptr;
+
+        if (current != nullptr && current->voicesUsing == 0)
+        {
+            retire(current);
+        }
+        else if (current != nullptr)
+        {
+            // Still sounding: keep it until those voices finish. With no room left, the
+            // oldest map's voices are cut short.
+            int slot = -1;
+            for (int i = 0; i < maxDraining && slot < 0; ++i)
+                if (draining[i] == nullptr)
+                    slot = i;
+
+            if (slot < 0)
+            {
+                for (auto& voice : voices)
+                    if (voice.active && voice.map == draining[0])
+                        stopVoice(voice);
+
+                retire(draining[0]);
+                for (int i = 0; i < maxDraining - 1; ++i)
+                    draining[i] = draining[i + 1];
+                slot = maxDraining - 1;
+            }
+            draining[slot] = current;
+        }
+        current = map;
+    });
+}
+
+void KeySampler::render(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi) noexcept
+{
+    applyMaps();
+
+    auto numSamples = buffer.getNumSamples();
+    bool on = enabled.load();
+    if (!on)
+        releaseNotes(-1);
+
+    // Render up to each event, then apply it, so notes start on the exact sample
+    int position = 0;
+    for (const auto metadata : midi)
+    {
+        auto eventPosition = juce::jlimit(0, numSamples, metadata.samplePosition);
+        if (eventPosition > position)
+        {
+            renderVoices(buffer, position, eventPosition - position);
+            position = eventPosition;
+        }
+
+        if (on)
+            handle(metadata.data, metadata.numBytes);
+    }
+
+    if (position < numSamples)
+        renderVoices(buffer, position, numSamples - position);
+
+    for (auto& map : draining)
+    {
+        if (map != nullptr && map->voicesUsing == 0)
+        {
+            retire(map);
+            map = nullptr;
+        }
+    }
+}
+
+void KeySampler::handle(const juce::uint8* data, int numBytes) noexcept
+{
+    // Raw bytes rather than MidiMessage, which can allocate for long messages
+    if (numBytes < 3)
+        return;
+
+    auto status = data[0] & 0xf0;
+    if (status == 0x90 && data[2] > 0)
+        noteOn(data[1], (float) data[2] / 127.0f);
+    else if (status == 0x80 || status == 0x90)
+        releaseNotes(data[1]);
+    else if (status == 0xb0 && (data[1] == 120 || data[1] == 123)) // All sound off, all notes off
+        releaseNotes(-1);
+}
+
+void KeySampler::noteOn(int note, float velocity) noexcept
+{
+    if (current == nullptr)
+        return;
+
+    auto index = note - baseNote;
+    if (index < 0 || index >= (int) current->keys.size() || current->keys[(size_t) index] == nullptr)
+        return;
+
+    // A retrigger fades the previous one out under the new one
+    releaseNotes(note);
+
+    // A free voice, or else the one started longest ago
+    Voice* voice = nullptr;
+    for (auto& candidate : voices)
+    {
+        if (!candidate.active)
+        {
+            voice = &candidate;
+            break;
+        }
+        if (voice == nullptr || candidate.startedAt - voice->startedAt > 0x80000000u)
+            voice = &candidate;
+    }
+
+    if (voice->active)
+        stopVoice(*voice);
+
+    voice->map = current;
+    voice->head = current->keys[(size_t) index].get();
+    voice->note = note;
+    voice->position = 0;
+    voice->velocity = velocity;
+    voice->level = 0.0f;
+    voice->target = 1.0f;
+    voice->startedAt = ++noteCounter;
+    voice->active = true;
+    ++current->voicesUsing;
+}
+
+void KeySampler::releaseNotes(int note) noexcept
+{
+    for (auto& voice : voices)
+        if (voice.active && (note < 0 || voice.note == note))
+            voice.target = 0.0f;
+}
+
+void KeySampler::stopVoice(Voice& voice) noexcept
+{
+    --voice.map->voicesUsing;
+    voice.active = false;
+    voice.map = nullptr;
+    voice.head = nullptr;
+}
+
+void KeySampler::renderVoices(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    auto numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    auto releaseFrames = (juce::int64) std::ceil(1.0f / juce::jmax(releaseStep, 1.0e-6f));
+
+    for (auto& voice : voices)
+    {
+        if (!voice.active)
+            continue;
+
+        auto& audio = voice.head->audio;
+        bool truncated = voice.head->getNumFrames() < voice.head->lengthInSamples;
+
+        for (int offset = startSample, left = numSamples; left > 0 && voice.active;)
+        {
+            auto remaining = audio.getNumSamples() - voice.position;
+            if (remaining <= 0)
+            {
+                stopVoice(voice);
+                break;
+            }
+
+            // The sample goes on past what's cached; fade out rather than stop dead
+            if (truncated && voice.target > 0.0f && remaining <= releaseFrames)
+                voice.target = 0.0f;
+
+            auto length = (int) juce::jmin((juce::int64) left, remaining);
+            if (voice.level != voice.target)
+                length = juce::jmin(length, framesPerRamp);
+
+            auto startGain = voice.level * voice.velocity;
+            voice.level = voice.target > voice.level ? juce::jmin(voice.target, voice.level + attackStep * (float) length)
+                                                     : juce::jmax(voice.target, voice.level - releaseStep * (float) length);
+            auto endGain = voice.level * voice.velocity;
+
+            // Mono heads go to both sides
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.addFromWithRamp(channel, offset,
+                                       audio.getReadPointer(juce::jmin(channel, audio.getNumChannels() - 1), (int) voice.position),
+                                       length, startGain, endGain);
+
+            voice.position += length;
+            offset += length;
+            left -= length;
+
+            if (voice.level <= 0.0f && voice.target <= 0.0f)
+                stopVoice(voice);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PreviewCache.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * KeySampler - plays a list of samples from MIDI, one per key
+ *
+ * setFiles() maps a list (the current results, or a set the user has pinned) onto
+ * consecutive keys from baseNote up. A background thread fetches each file's head from
+ * the PreviewCache (decoding what isn't there yet), resamples it to the host rate and
+ * hands the finished map to the audio thread through a lock-free queue. Note-ons then
+ * start a voice at the exact sample offset of the event, straight out of RAM: nothing
+ * is opened, decoded or filtered while playing, so latency is the host's block size.
+ *
+ * Voices are gated (note-off releases them), with short linear attack and release
+ * envelopes. Only the cached head plays (PreviewCache::Settings::headSeconds), which
+ * covers typical chops; longer samples fade out at its end. A map that voices are still
+ * sounding from is kept until they finish. Maps and heads are freed on the background
+ * thread, never on the audio thread.
+ *
+ * Threading: setEnabled/setFiles from any thread; prepare, release and render for the
+ * audio thread (prepare/release while it isn't rendering).
+ */
+class KeySampler : private juce::Thread
+{
+public:
+    static constexpr int baseNote = 36;     // C1; the first pad on most controllers
+    static constexpr int maxKeys = 32;
+
+    explicit KeySampler(PreviewCache& cache);
+    ~KeySampler() override;
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const noexcept         { return enabled.load(); }
+
+    // Replaces the mapping; files past maxKeys are ignored
+    void setFiles(const juce::Array<juce::File>& files);
+    int getNumMappedKeys() const noexcept   { return mappedKeys.load(); }
+
+    //==============================================================================
+    // Audio thread
+    void prepareToPlay(double sampleRate, int maximumBlockSize);
+    void releaseResources();
+
+    // Handles the MIDI in this block and adds the sampler's voices to the buffer
+    void render(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi) noexcept;
+
+private:
+    struct KeyMap
+    {
+        std::vector<std::shared_ptr<const DecodedHead>> keys;  // At the host rate; index = note - baseNote
+        double sampleRate = 0.0;
+        int voicesUsing = 0;                                    // Audio thread only
+    };
+
+    struct Voice
+    {
+        KeyMap* map = nullptr;
+        const DecodedHead* head = nullptr;  // Owned by map
+        int note = -1;
+        juce::int64 position = 0;
+        float velocity = 0.0f;
+        float level = 0.0f, target = 0.0f;
+        juce::uint32 startedAt = 0;
+        bool active = false;
+    };
+
+    static constexpr int maxVoices = 16;
+    static constexpr int queueSize = 8;
+    static constexpr int maxDraining = 2;
+    static constexpr double attackSeconds = 0.002;
+    static constexpr double releaseSeconds = 0.03;
+    static constexpr int framesPerRamp = 32;
+
+    PreviewCache& cache;
+
+    // Any thread -> builder thread
+    juce::CriticalSection requestLock;
+    juce::Array<juce::File> requestedFiles;
+    bool mapRequested = false;
+    std::atomic<bool> enabled { false };
+    std::atomic<double> hostRate { 0.0 };
+    std::atomic<int> mappedKeys { 0 };
+
+    // Builder thread only: the heads of the last map built, for reuse by the next
+    std::unordered_map<juce::String, std::shared_ptr<const DecodedHead>> builtHeads;
+
+    // Builder thread -> audio thread: finished maps; and back again for deleting
+    juce::AbstractFifo mapFifo { queueSize };
+    KeyMap* incoming[queueSize] = {};
+    juce::AbstractFifo retiredFifo { queueSize };
+    KeyMap* retired[queueSize] = {};
+
+    // Audio thread only
+    KeyMap* current = nullptr;
+    KeyMap* draining[maxDraining] = {};
+    Voice voices[maxVoices];
+    juce::uint32 noteCounter = 0;
+    float attackStep = 0.0f, releaseStep = 0.0f;
+
+    void requestBuild();
+    void run() override;
+    std::unique_ptr<KeyMap> buildMap(const juce::Array<juce::File>& files, double rate);
+    static std::shared_ptr<const DecodedHead> resample(const std::shared_ptr<const DecodedHead>& head, double rate);
+    bool send(std::unique_ptr<KeyMap>& map);  // Takes the map only if there's room
+    void collectRetiredMaps();
+
+    void applyMaps() noexcept;
+    void retire(KeyMap* map) noexcept;
+    void handle(const juce::uint8* data, int numBytes) noexcept;
+    void noteOn(int note, float velocity) noexcept;
+    void releaseNotes(int note) noexcept;   // -1 for all
+    void stopVoice(Voice& voice) noexcept;
+    void renderVoices(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KeySampler)
+};
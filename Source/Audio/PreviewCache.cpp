@@ -0,0 +1,194 @@
+#include "PreviewCache.h"
+
+PreviewCache::PreviewCache(ReaderFactory factory)
+    : juce::Thread("ChopsPreviewPrefetch"), openReader(std::move(factory))
+{
+}
+
+PreviewCache::~PreviewCache()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+}
+
+//==============================================================================
+void PreviewCache::setSettings(const Settings& newSettings)
+{
+    const juce::ScopedLock sl(lock);
+    settings = newSettings;
+    while (bytes > settings.memoryBudgetBytes && !entries.empty())
+    {
+        erase(std::prev(entries.end()));
+        ++stats.evictions;
+    }
+}
+
+PreviewCache::Stats PreviewCache::getStats() const
+{
+    const juce::ScopedLock sl(lock);
+    auto current = stats;
+    current.entries = entries.size();
+    current.bytes = bytes;
+    return current;
+}
+
+std::shared_ptr<const DecodedHead> PreviewCache::find(const juce::File& file)
+{
+    // Stat outside the lock; the prefetch thread may be waiting to insert
+    auto modified = file.getLastModificationTime();
+    auto size = file.getSize();
+
+    const juce::ScopedLock sl(lock);
+    auto found = byPath.find(file.getFullPathName());
+    if (found == byPath.end())
+    {
+        ++stats.misses;
+        return nullptr;
+    }
+
+    auto it = found->second;
+    if ((*it)->modified != modified || (*it)->fileSize != size)
+    {
+        erase(it); // Rewritten since; decoded again next time it's prefetched
+        ++stats.misses;
+        return nullptr;
+    }
+
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, it);
+    return *it;
+}
+
+std::shared_ptr<const DecodedHead> PreviewCache::findOrDecode(const juce::File& file)
+{
+    if (auto head = find(file))
+        return head;
+
+    double headSeconds = 0.0;
+    {
+        const juce::ScopedLock sl(lock);
+        headSeconds = settings.headSeconds;
+    }
+
+    if (auto head = decode(file, headSeconds))
+    {
+        insert(head);
+        return head;
+    }
+    return find(file); // The prefetch thread may have got there first
+}
+
+void PreviewCache::prefetch(const juce::Array<juce::File>& files)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        queue.assign(files.begin(), files.end());
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+    notify();
+}
+
+void PreviewCache::clear()
+{
+    const juce::ScopedLock sl(lock);
+    queue.clear();
+    entries.clear();
+    byPath.clear();
+    bytes = 0;
+}
+
+//==============================================================================
+void PreviewCache::run()
+{
+    while (!threadShouldExit())
+    {
+        juce::File file;
+        double headSeconds = 0.0;
+        {
+            const juce::ScopedLock sl(lock);
+            if (!queue.empty())
+            {
+                file = queue.front();
+                queue.pop_front();
+            }
+            headSeconds = settings.headSeconds;
+        }
+
+        if (file == juce::File())
+        {
+            wait(-1);
+            continue;
+        }
+
+        if (auto head = decode(file, headSeconds))
+            insert(std::move(head));
+    }
+}
+
+std::shared_ptr<DecodedHead> PreviewCache::decode(const juce::File& file, double headSeconds)
+{
+    // Stat before reading, so a write that lands mid-decode shows up as stale on lookup
+    auto modified = file.getLastModificationTime();
+    auto size = file.getSize();
+    {
+        const juce::ScopedLock sl(lock);
+        auto found = byPath.find(file.getFullPathName());
+        if (found != byPath.end() && (*found->second)->modified == modified && (*found->second)->fileSize == size)
+            return nullptr; // Already have it
+    }
+
+    auto reader = openReader(file);
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+    {
+        juce::Logger::writeToLog("PreviewCache: Could not decode " + file.getFullPathName());
+        return nullptr;
+    }
+
+    auto head = std::make_shared<DecodedHead>();
+    head->file = file;
+    head->modified = modified;
+    head->fileSize = size;
+    head->sampleRate = reader->sampleRate;
+    head->lengthInSamples = reader->lengthInSamples;
+
+    auto numFrames = (int) juce::jmin(reader->lengthInSamples, (juce::int64) std::ceil(headSeconds * reader->sampleRate));
+    auto numChannels = (int) juce::jlimit(1u, 2u, reader->numChannels);
+    head->audio.setSize(numChannels, juce::jmax(1, numFrames));
+    if (!reader->read(&head->audio, 0, numFrames, 0, true, numChannels > 1))
+    {
+        juce::Logger::writeToLog("PreviewCache: Read failed for " + file.getFullPathName());
+        return nullptr;
+    }
+    return head;
+}
+
+void PreviewCache::insert(Entry head)
+{
+    const juce::ScopedLock sl(lock);
+    auto path = head->file.getFullPathName();
+    auto existing = byPath.find(path);
+    if (existing != byPath.end())
+        erase(existing->second);
+
+    bytes += head->getBytes();
+    entries.push_front(std::move(head));
+    byPath[path] = entries.begin();
+    ++stats.decoded;
+
+    // The newest entry always stays, even if it alone is over budget
+    while (bytes > settings.memoryBudgetBytes && entries.size() > 1)
+    {
+        erase(std::prev(entries.end()));
+        ++stats.evictions;
+    }
+}
+
+void PreviewCache::erase(std::list<Entry>::iterator it)
+{
+    bytes -= (*it)->getBytes();
+    byPath.erase((*it)->file.getFullPathName());
+    entries.erase(it);
+}
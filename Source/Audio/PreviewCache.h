@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * DecodedHead - the first few seconds of a file, decoded, plus what's needed to stream
+ * the rest of it: a preview can start from this without opening the file.
+ */
+struct DecodedHead
+{
+    juce::File file;
+    juce::Time modified;                 // The file's, when it was decoded
+    juce::int64 fileSize = 0;
+    double sampleRate = 0.0;
+    juce::int64 lengthInSamples = 0;     // The whole file's
+    juce::AudioBuffer<float> audio;      // Up to two channels
+
+    int getNumFrames() const noexcept    { return audio.getNumSamples(); }
+    size_t getBytes() const noexcept     { return (size_t) audio.getNumChannels() * (size_t) audio.getNumSamples() * sizeof(float); }
+};
+
+/**
+ * PreviewCache - memory-bounded LRU of decoded heads, filled speculatively
+ *
+ * The browser tells it which samples are likely to be auditioned next (the selection's
+ * neighbours in the result list) and a background thread decodes their first
+ * headSeconds. A later find() for one of them is a lookup and a stat(), so the preview
+ * starts without opening or decoding anything on the caller's thread. Entries whose
+ * file has changed since are dropped on lookup.
+ *
+ * Entries are shared: one evicted while a preview is still playing from it stays alive
+ * until that preview lets go. Thread-safe.
+ */
+class PreviewCache : private juce::Thread
+{
+public:
+    using ReaderFactory = std::function<std::unique_ptr<juce::AudioFormatReader>(const juce::File&)>;
+
+    struct Settings
+    {
+        double headSeconds = 4.0;
+        size_t memoryBudgetBytes = 64 * 1024 * 1024;
+    };
+
+    struct Stats
+    {
+        juce::int64 hits = 0;
+        juce::int64 misses = 0;
+        int decoded = 0;
+        int evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    // openReader is called on the prefetch thread
+    explicit PreviewCache(ReaderFactory openReader);
+    ~PreviewCache() override;
+
+    void setSettings(const Settings& newSettings);
+    Stats getStats() const;
+
+    // The cached head for a file, if there is a current one
+    std::shared_ptr<const DecodedHead> find(const juce::File& file);
+
+    // For background threads: decodes (and caches) the head right away on a miss
+    std::shared_ptr<const DecodedHead> findOrDecode(const juce::File& file);
+
+    // Replaces whatever was still waiting to be prefetched; most likely first
+    void prefetch(const juce::Array<juce::File>& files);
+
+    void clear();
+
+private:
+    using Entry = std::shared_ptr<const DecodedHead>;
+
+    ReaderFactory openReader;
+
+    mutable juce::CriticalSection lock;     // Guards everything below
+    Settings settings;
+    std::list<Entry> entries;               // Most recently used first
+    std::unordered_map<juce::String, std::list<Entry>::iterator> byPath;
+    std::deque<juce::File> queue;
+    size_t bytes = 0;
+    Stats stats;
+
+    void run() override;
+    std::shared_ptr<DecodedHead> decode(const juce::File& file, double headSeconds);
+    void insert(Entry head);
+    void erase(std::list<Entry>::iterator it);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreviewCache)
+};
@@ -0,0 +1,441 @@
+#include "PreviewEngine.h"
+
+//==============================================================================
+PreviewEngine::Voice::Voice(std::unique_ptr<PreviewStream> source, juce::TimeSliceThread& thread)
+    : stream(std::move(source)),
+      ioThread(thread)
+{
+    // Enough to start playing straight away; the I/O thread takes it from there
+    stream->prefill(prefillFrames);
+    ioThread.addTimeSliceClient(stream.get());
+}
+
+PreviewEngine::Voice::~Voice()
+{
+    ioThread.removeTimeSliceClient(stream.get());
+}
+
+void PreviewEngine::Voice::restart() noexcept
+{
+    setPosition(0.0);
+}
+
+void PreviewEngine::Voice::setPosition(double frame) noexcept
+{
+    // Already there (a restart before anything played): keep what has been decoded
+    auto target = juce::jlimit(0.0, (double) getLength(), std::floor(frame));
+    if (target != position)
+    {
+        position = target;
+        stream->seek((juce::int64) position);
+    }
+}
+
+void PreviewEngine::Voice::setOutputRate(double newRate) noexcept
+{
+    auto oldRate = getSampleRate();
+    if (newRate <= 0.0 || newRate == oldRate)
+        return;
+
+    stream->setOutputRate(newRate);
+    position = juce::jlimit(0.0, (double) getLength(), std::floor(position * newRate / oldRate));
+    stream->seek((juce::int64) position);
+}
+
+bool PreviewEngine::Voice::render(juce::AudioBuffer<float>& output, int startSample, int numSamples) noexcept
+{
+    // Already at the output rate: a straight copy out of the ring
+    auto remaining = getLength() - (juce::int64) position;
+    if (remaining <= 0)
+        return false;
+
+    auto wanted = (int) juce::jmin((juce::int64) numSamples, remaining);
+    auto ready = stream->peek(output, startSample, wanted);
+
+    // Mono sources go to both sides; anything past the second channel is dropped
+    if (stream->getNumChannels() == 1 && output.getNumChannels() > 1 && ready > 0)
+        output.copyFrom(1, startSample, output, 0, startSample, ready);
+
+    stream->consume(ready);
+    position += ready;
+
+    // The I/O thread has fallen behind; the rest of the block stays silent
+    if (ready < wanted)
+        stream->noteUnderrun();
+
+    return position < getLength();
+}
+
+//==============================================================================
+PreviewEngine::PreviewEngine(juce::AudioFormatManager& formatManager)
+    : formats(formatManager)
+{
+    ioThread.startThread(juce::Thread::Priority::high);
+    fadeStep = (float) (1.0 / (fadeSeconds * outputRate));
+    startTimerHz(30);
+}
+
+PreviewEngine::~PreviewEngine()
+{
+    stopTimer();
+
+    // The audio thread has stopped calling render() by now, so its side can be cleaned up here
+    for (auto& slot : slots)
+        delete slot.voice;
+
+    auto pending = commandFifo.read(commandFifo.getNumReady());
+    pending.forEach([this](int index) { delete commands[index].voice; });
+
+    collectRetiredVoices();
+    loadedVoice.reset();
+    ioThread.stopThread(2000);
+}
+
+//==============================================================================
+std::unique_ptr<juce::AudioFormatReader> PreviewEngine::createReader(const juce::File& audioFile)
+{
+    // Uncompressed formats are mapped rather than read through a stream; decoding a block
+    // is then a copy out of the page cache
+    if (auto* format = formats.findFormatForFileExtension(audioFile.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(audioFile));
+        if (mapped != nullptr && mapped->mapEntireFile())
+            return mapped;
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(audioFile));
+}
+
+bool PreviewEngine::load(const juce::File& audioFile)
+{
+    // Prefetched: the voice starts from memory and the I/O thread opens the file if
+    // playback gets past the cached head
+    if (auto head = cache.find(audioFile))
+    {
+        auto stream = std::make_unique<PreviewStream>(std::move(head),
+                                                      [this](const juce::File& file) { return createReader(file); },
+                                                      hostRate.load());
+        loadedVoice = std::make_unique<Voice>(std::move(stream), ioThread);
+        return true;
+    }
+
+    auto reader = createReader(audioFile);
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+    {
+        juce::Logger::writeToLog("PreviewEngine: Could not create reader for " + audioFile.getFullPathName());
+        return false;
+    }
+
+    loadedVoice = std::make_unique<Voice>(std::make_unique<PreviewStream>(std::move(reader), hostRate.load()), ioThread);
+    return true;
+}
+
+void PreviewEngine::play()
+{
+    if (loadedVoice != nullptr)
+    {
+        loadedVoice->restart();
+        Command command;
+        command.type = Command::Start;
+        command.voice = loadedVoice.get();
+        if (!send(command))
+            return;
+
+        loadedVoice.release(); // Owned by the audio thread now
+        hasHandedOverVoice = true;
+    }
+    else if (hasHandedOverVoice)
+    {
+        Command command;
+        command.type = Command::Restart;
+        if (!send(command))
+            return;
+    }
+    else
+    {
+        juce::Logger::writeToLog("PreviewEngine: No sample loaded");
+        return;
+    }
+
+    requestedPlaying = true;
+    timerCallback();
+}
+
+void PreviewEngine::stop()
+{
+    Command command;
+    command.type = Command::Stop;
+    if (send(command))
+    {
+        requestedPlaying = false;
+        timerCallback();
+    }
+}
+
+void PreviewEngine::seek(double proportion)
+{
+    proportion = juce::jlimit(0.0, 1.0, proportion);
+
+    // Not handed over yet: still ours to change directly
+    if (loadedVoice != nullptr)
+    {
+        loadedVoice->setPosition(proportion * (double) loadedVoice->getLength());
+        return;
+    }
+
+    Command command;
+    command.type = Command::Seek;
+    command.proportion = proportion;
+    send(command);
+}
+
+bool PreviewEngine::isPlaying() const
+{
+    // Until the audio thread has caught up with our commands, report what was asked for
+    if (commandsApplied.load() != commandsSent.load())
+        return requestedPlaying;
+    return playing.load();
+}
+
+double PreviewEngine::getProgress() const
+{
+    if (loadedVoice != nullptr)
+        return loadedVoice->getLength() > 0 ? loadedVoice->getPosition() / (double) loadedVoice->getLength() : 0.0;
+
+    auto total = length.load();
+    return total > 0 ? juce::jlimit(0.0, 1.0, position.load() / (double) total) : 0.0;
+}
+
+double PreviewEngine::getLengthInSeconds() const
+{
+    if (loadedVoice != nullptr)
+        return loadedVoice->getSampleRate() > 0.0 ? (double) loadedVoice->getLength() / loadedVoice->getSampleRate() : 0.0;
+
+    auto rate = frameRate.load();
+    return rate > 0.0 ? (double) length.load() / rate : 0.0;
+}
+
+bool PreviewEngine::send(const Command& command)
+{
+    // Every command retires at most one voice and the pool can hand back the rest, so as
+    // long as the two queues together leave room for that, the audio thread can never
+    // find the retired queue full
+    collectRetiredVoices();
+    if (commandFifo.getNumReady() + retiredFifo.getNumReady() + maxVoices >= queueSize - 1)
+    {
+        if (!reportedQueueFull)
+            juce::Logger::writeToLog("PreviewEngine: Command queue full; is the audio thread running?");
+        reportedQueueFull = true;
+        return false;
+    }
+    reportedQueueFull = false;
+
+    auto scope = commandFifo.write(1);
+    scope.forEach([this, &command](int index) { commands[index] = command; });
+    ++commandsSent;
+    return true;
+}
+
+void PreviewEngine::collectRetiredVoices()
+{
+    auto scope = retiredFifo.read(retiredFifo.getNumReady());
+    scope.forEach([this](int index) {
+        delete retired[index];
+        retired[index] = nullptr;
+    });
+}
+
+void PreviewEngine::timerCallback()
+{
+    collectRetiredVoices();
+
+    auto nowPlaying = isPlaying();
+    if (nowPlaying != lastReportedPlaying)
+    {
+        lastReportedPlaying = nowPlaying;
+        if (onStateChange)
+            onStateChange();
+    }
+}
+
+//==============================================================================
+void PreviewEngine::prepareToPlay(double sampleRate, int maximumBlockSize)
+{
+    juce::ignoreUnused(maximumBlockSize);
+    outputRate = sampleRate;
+    hostRate = sampleRate;
+    fadeStep = (float) (1.0 / (fadeSeconds * sampleRate));
+    for (auto& slot : slots)
+        if (slot.voice != nullptr)
+            slot.voice->setOutputRate(sampleRate);
+}
+
+void PreviewEngine::releaseResources()
+{
+    for (auto& slot : slots)
+        slot.sounding = false;
+    playing = false;
+}
+
+void PreviewEngine::retire(Voice* voice) noexcept
+{
+    if (voice == nullptr)
+        return;
+
+    auto scope = retiredFifo.write(1);
+    scope.forEach([this, voice](int index) { retired[index] = voice; });
+    jassert(scope.blockSize1 + scope.blockSize2 == 1); // send() keeps room for this
+}
+
+void PreviewEngine::startVoice(Voice* voice) noexcept
+{
+    // The old lead fades out under the new one; if it's silent anyway it can go now
+    if (auto* lead = getLead())
+    {
+        if (lead->sounding)
+        {
+            lead->fadeTarget = 0.0f;
+        }
+        else
+        {
+            retire(lead->voice);
+            *lead = {};
+        }
+    }
+
+    // A free slot, or else the quietest of the voices still fading out
+    int chosen = -1;
+    for (int i = 0; i < maxVoices; ++i)
+    {
+        if (slots[i].voice == nullptr)
+        {
+            chosen = i;
+            break;
+        }
+        if (chosen < 0 || slots[i].fade < slots[chosen].fade)
+            chosen = i;
+    }
+
+    retire(slots[chosen].voice);
+    slots[chosen] = { voice, 0.0f, 1.0f, true };
+    leadSlot = chosen;
+    voice->setOutputRate(outputRate); // Only if it was loaded before a rate change
+}
+
+int PreviewEngine::applyCommands() noexcept
+{
+    auto numReady = commandFifo.getNumReady();
+    if (numReady == 0)
+        return 0;
+
+    auto scope = commandFifo.read(numReady);
+    scope.forEach([this](int index) {
+        auto& command = commands[index];
+        auto* lead = getLead();
+        switch (command.type)
+        {
+            case Command::Start:
+                startVoice(command.voice);
+                break;
+
+            case Command::Restart:
+                if (lead != nullptr)
+                {
+                    lead->voice->restart();
+                    *lead = { lead->voice, 0.0f, 1.0f, true };
+                }
+                break;
+
+            case Command::Stop:
+                if (lead != nullptr)
+                    lead->fadeTarget = 0.0f;
+                break;
+
+            case Command::Seek:
+                if (lead != nullptr)
+                {
+                    lead->voice->setPosition(command.proportion * (double) lead->voice->getLength());
+                    lead->fade = 0.0f; // Fade in from the new position rather than jump to it
+                }
+                break;
+        }
+        command.voice = nullptr;
+    });
+    return numReady;
+}
+
+bool PreviewEngine::renderSlot(Slot& slot, juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    auto numChannels = juce::jmin(buffer.getNumChannels(), mixBuffer.getNumChannels());
+
+    for (int done = 0; done < numSamples;)
+    {
+        auto chunk = juce::jmin(numSamples - done, mixBuffer.getNumSamples());
+        mixBuffer.clear(0, chunk);
+        bool more = slot.voice->render(mixBuffer, 0, chunk);
+
+        // Equal-power envelope, linear within each short ramp
+        for (int offset = 0; offset < chunk; offset += framesPerRamp)
+        {
+            auto length = juce::jmin(framesPerRamp, chunk - offset);
+            auto startGain = std::sin(slot.fade * juce::MathConstants<float>::halfPi);
+            auto delta = fadeStep * (float) length;
+            slot.fade = slot.fadeTarget > slot.fade ? juce::jmin(slot.fadeTarget, slot.fade + delta)
+                                                    : juce::jmax(slot.fadeTarget, slot.fade - delta);
+            auto endGain = std::sin(slot.fade * juce::MathConstants<float>::halfPi);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.addFromWithRamp(channel, startSample + done + offset, mixBuffer.getReadPointer(channel, offset),
+                                       length, startGain, endGain);
+
+            if (slot.fade <= 0.0f && slot.fadeTarget <= 0.0f)
+                return false; // Faded out
+        }
+
+        if (!more)
+            return false;
+        done += chunk;
+    }
+    return true;
+}
+
+bool PreviewEngine::render(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    auto numCommands = (juce::uint32) applyCommands();
+
+    bool rendered = false;
+    for (auto& slot : slots)
+    {
+        if (slot.voice == nullptr || !slot.sounding)
+            continue;
+
+        if (!rendered)
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.clear(channel, startSample, numSamples);
+
+        slot.sounding = renderSlot(slot, buffer, startSample, numSamples);
+        rendered = true;
+    }
+
+    // Voices that have faded out go back for deleting; the lead stays for play/seek
+    for (int i = 0; i < maxVoices; ++i)
+    {
+        if (i != leadSlot && slots[i].voice != nullptr && !slots[i].sounding)
+        {
+            retire(slots[i].voice);
+            slots[i] = {};
+        }
+    }
+
+    // State first, then the command count, so isPlaying() never pairs new counts with old state
+    auto* lead = getLead();
+    playing = lead != nullptr && lead->sounding && lead->fadeTarget > 0.0f;
+    if (lead != nullptr)
+    {
+        position = lead->voice->getPosition();
+        length = lead->voice->getLength();
+        frameRate = lead->voice->getSampleRate();
+    }
+    commandsApplied += numCommands;
+    return rendered;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PreviewCache.h"
+#include "PreviewStream.h"
+#include <atomic>
+
+/**
+ * PreviewEngine - auditions one sample at a time without locking the audio thread
+ *
+ * The message thread does everything that can block: it opens the file (memory-mapped
+ * for WAV and AIFF) and wraps it in a Voice, then hands the voice over through a
+ * single-producer/single-consumer command queue. Decoding, and resampling to the host
+ * rate (see SincResampler), happen ahead of playback on a shared I/O thread (see
+ * PreviewStream). The audio thread only drains the queue and copies the voice's frames
+ * out of its ring buffer; it never allocates, frees, locks, touches a file or filters. Voices it has finished with go back through a second queue and are
+ * deleted on the message thread.
+ *
+ * Up to maxVoices voices sound at once, each with its own envelope: starting a new
+ * sample crossfades (equal power, fadeSeconds) from whatever was playing, and stopping
+ * fades out rather than cutting. The pool is a fixed array, so none of this allocates.
+ *
+ * Files named through prefetch() have their first seconds decoded in the background
+ * (see PreviewCache); loading one of those opens nothing, so it can play from the next
+ * audio block.
+ *
+ * Playback state (playing, position, length) is published through atomics. State
+ * changes are reported on the message thread through onStateChange, including when
+ * a voice plays to its end.
+ *
+ * Threading: load/play/stop/seek and the getters are for the message thread; prepare,
+ * release and render for the audio thread (prepare/release while it isn't rendering).
+ */
+class PreviewEngine : private juce::Timer
+{
+public:
+    explicit PreviewEngine(juce::AudioFormatManager& formatManager);
+    ~PreviewEngine() override;
+
+    //==============================================================================
+    // Message thread
+    bool load(const juce::File& audioFile);  // Prepares a voice; play() starts it
+    // What's likely to be loaded next, most likely first; replaces the previous list
+    void prefetch(const juce::Array<juce::File>& files)  { cache.prefetch(files); }
+    PreviewCache& getCache() noexcept                    { return cache; }
+    void play();                             // From the start
+    void stop();
+    void seek(double proportion);            // 0.0 to 1.0
+
+    bool isPlaying() const;
+    double getProgress() const;              // 0.0 to 1.0
+    double getLengthInSeconds() const;
+
+    std::function<void()> onStateChange;
+
+    //==============================================================================
+    // Audio thread
+    void prepareToPlay(double sampleRate, int maximumBlockSize);
+    void releaseResources();
+
+    // Replaces the output with the preview while one is playing (or fading out); returns
+    // false (and leaves the buffer alone) when there is nothing to play
+    bool render(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    // A streamed sample and its playback position, in frames at the output rate; only
+    // the audio thread touches one once it has been handed over
+    class Voice
+    {
+    public:
+        Voice(std::unique_ptr<PreviewStream> source, juce::TimeSliceThread& ioThread);
+        ~Voice();
+
+        void restart() noexcept;
+        void setPosition(double frame) noexcept;
+        // Keeps the position in seconds; the stream refills at the new rate
+        void setOutputRate(double newRate) noexcept;
+        // Renders up to numSamples; returns false once the end has been reached. If the
+        // I/O thread has fallen behind, the rest of the block is left silent.
+        bool render(juce::AudioBuffer<float>& output, int startSample, int numSamples) noexcept;
+
+        juce::int64 getLength() const noexcept   { return stream->getLength(); }
+        double getPosition() const noexcept      { return position; }
+        double getSampleRate() const noexcept    { return stream->getSampleRate(); }
+
+    private:
+        static constexpr int prefillFrames = 8192;
+
+        std::unique_ptr<PreviewStream> stream;
+        juce::TimeSliceThread& ioThread;
+        double position = 0.0;
+    };
+
+    struct Command
+    {
+        enum Type { Start, Restart, Stop, Seek };
+        Type type = Stop;
+        Voice* voice = nullptr;      // Start only; ownership passes to the audio thread
+        double proportion = 0.0;     // Seek only
+    };
+
+    // A voice in the pool and its envelope
+    struct Slot
+    {
+        Voice* voice = nullptr;
+        float fade = 0.0f;          // 0 (silent) to 1; the gain is equal-power shaped
+        float fadeTarget = 0.0f;
+        bool sounding = false;
+    };
+
+    static constexpr int queueSize = 32;
+    static constexpr int maxVoices = 4;
+    static constexpr double fadeSeconds = 0.02;
+    static constexpr int framesPerRamp = 32;    // Gain is linear within one of these
+
+    juce::AudioFormatManager& formats;
+    juce::TimeSliceThread ioThread { "ChopsPreviewIO" };
+    PreviewCache cache { [this](const juce::File& file) { return createReader(file); } };
+
+    // Message thread -> audio thread
+    juce::AbstractFifo commandFifo { queueSize };
+    Command commands[queueSize];
+    // Audio thread -> message thread: voices to delete
+    juce::AbstractFifo retiredFifo { queueSize };
+    Voice* retired[queueSize] = {};
+
+    // Message thread only
+    std::unique_ptr<Voice> loadedVoice;     // Not yet handed over
+    bool hasHandedOverVoice = false;
+    bool requestedPlaying = false;
+    bool lastReportedPlaying = false;
+    bool reportedQueueFull = false;
+    std::atomic<juce::uint32> commandsSent { 0 };
+    std::atomic<double> hostRate { 44100.0 };  // What new voices are resampled to
+
+    // Audio thread only
+    Slot slots[maxVoices];
+    int leadSlot = -1;                      // The one play/stop/seek apply to
+    double outputRate = 44100.0;
+    float fadeStep = 0.0f;                  // Per frame
+    juce::AudioBuffer<float> mixBuffer { 2, 2048 };
+
+    // Published by the audio thread after every block
+    std::atomic<juce::uint32> commandsApplied { 0 };
+    std::atomic<bool> playing { false };
+    std::atomic<double> position { 0.0 };   // In frames at frameRate
+    std::atomic<juce::int64> length { 0 };
+    std::atomic<double> frameRate { 0.0 };
+
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& audioFile);
+    bool send(const Command& command);
+    void collectRetiredVoices();
+    int applyCommands() noexcept;  // Returns how many it applied
+    void retire(Voice* voice) noexcept;
+    void startVoice(Voice* voice) noexcept;
+    Slot* getLead() noexcept                { return leadSlot >= 0 ? &slots[leadSlot] : nullptr; }
+    bool renderSlot(Slot& slot, juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreviewEngine)
+};
@@ -0,0 +1,217 @@
+#include "PreviewStream.h"
+
+PreviewStream::PreviewStream(std::unique_ptr<juce::AudioFormatReader> sourceReader, double rate, int bufferFrames)
+    : reader(std::move(sourceReader)),
+      length(reader->lengthInSamples),
+      sourceRate(reader->sampleRate),
+      ring((int) juce::jlimit(1u, 2u, reader->numChannels), bufferFrames + 1),
+      fifo(bufferFrames + 1),
+      outputRate(rate),
+      sourceBlock(ring.getNumChannels(), framesPerRead)
+{
+    ring.clear();
+    startAt(0);
+}
+
+PreviewStream::PreviewStream(std::shared_ptr<const DecodedHead> cachedHead, PreviewCache::ReaderFactory factory,
+                             double rate, int bufferFrames)
+    : head(std::move(cachedHead)),
+      openReader(std::move(factory)),
+      length(head->lengthInSamples),
+      sourceRate(head->sampleRate),
+      ring(head->audio.getNumChannels(), bufferFrames + 1),
+      fifo(bufferFrames + 1),
+      outputRate(rate),
+      sourceBlock(ring.getNumChannels(), framesPerRead)
+{
+    ring.clear();
+    startAt(0);
+}
+
+juce::int64 PreviewStream::getLength() const noexcept
+{
+    return SincResampler::getOutputLength(length.load(), sourceRate, outputRate.load());
+}
+
+void PreviewStream::prefill(int numFrames)
+{
+    while (numFrames > 0)
+    {
+        auto got = fill(numFrames);
+        if (got <= 0)
+            break;
+        numFrames -= got;
+    }
+}
+
+//==============================================================================
+void PreviewStream::seek(juce::int64 frame) noexcept
+{
+    seekTarget = juce::jlimit((juce::int64) 0, getLength(), frame);
+    ++generation;
+}
+
+int PreviewStream::peek(juce::AudioBuffer<float>& dest, int destStart, int numFrames) noexcept
+{
+    if (producedGeneration.load() != generation.load())
+    {
+        // Decoded for a position we've since left; the producer refills once this is gone
+        fifo.finishedRead(fifo.getNumReady());
+        return 0;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(juce::jmin(numFrames, dest.getNumSamples() - destStart), start1, size1, start2, size2);
+
+    for (int channel = 0; channel < juce::jmin(dest.getNumChannels(), ring.getNumChannels()); ++channel)
+    {
+        if (size1 > 0)
+            dest.copyFrom(channel, destStart, ring, channel, start1, size1);
+        if (size2 > 0)
+            dest.copyFrom(channel, destStart + size1, ring, channel, start2, size2);
+    }
+    return size1 + size2;
+}
+
+void PreviewStream::consume(int numFrames) noexcept
+{
+    fifo.finishedRead(juce::jmin(numFrames, fifo.getNumReady()));
+}
+
+//==============================================================================
+int PreviewStream::useTimeSlice()
+{
+    auto wanted = generation.load();
+    if (wanted != producedGeneration.load())
+    {
+        // Wait for the consumer to drop what we decoded for the old position
+        if (fifo.getNumReady() > 0)
+            return 2;
+
+        startAt(seekTarget.load());
+        producedGeneration = wanted;
+    }
+
+    if (fill(framesPerRead) > 0)
+        return 0;
+
+    // Full, or nothing left to read; a seek needs picking up quickly either way
+    return writePosition < SincResampler::getOutputLength(length.load(), sourceRate, producerRate) ? 5 : 10;
+}
+
+void PreviewStream::startAt(juce::int64 frame)
+{
+    auto rate = outputRate.load();
+    writePosition = frame;
+
+    if (SincResampler::isIdentity(sourceRate, rate))
+    {
+        resampler.reset();
+        sourcePosition = frame;
+    }
+    else
+    {
+        // Building the filter allocates; fine here, this is never the audio thread
+        if (resampler == nullptr || rate != producerRate)
+            resampler = std::make_unique<SincResampler>(sourceRate, rate, ring.getNumChannels());
+
+        sourcePosition = resampler->reset(frame);
+        paddedEnd = false;
+    }
+    producerRate = rate;
+}
+
+int PreviewStream::fill(int maxFrames)
+{
+    auto end = SincResampler::getOutputLength(length.load(), sourceRate, producerRate);
+    auto numFrames = (int) juce::jmin((juce::int64) juce::jmin(maxFrames, fifo.getFreeSpace()), end - writePosition);
+    if (numFrames <= 0)
+        return 0;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numFrames, start1, size1, start2, size2);
+
+    auto written = size1 > 0 ? produce(start1, size1) : 0;
+    if (written == size1 && size2 > 0)
+        written += produce(start2, size2);
+
+    writePosition += written;
+    fifo.finishedWrite(written);
+    return written;
+}
+
+int PreviewStream::produce(int ringStart, int numFrames)
+{
+    if (resampler == nullptr)
+    {
+        auto got = read(ring, ringStart, numFrames, sourcePosition);
+        sourcePosition += got;
+        return got;
+    }
+
+    int done = 0;
+    while (done < numFrames)
+    {
+        done += resampler->process(ring, ringStart + done, numFrames - done);
+        if (done == numFrames)
+            break;
+
+        // It needs more source first
+        auto sourceLeft = length.load() - sourcePosition;
+        if (sourceLeft > 0)
+        {
+            auto wanted = (int) juce::jmin((juce::int64) juce::jmin(resampler->getFreeSpace(), sourceBlock.getNumSamples()),
+                                           sourceLeft);
+            if (wanted <= 0)
+                break;
+
+            auto got = read(sourceBlock, 0, wanted, sourcePosition);
+            resampler->push(sourceBlock, 0, got);
+            sourcePosition += got;
+        }
+        else if (!paddedEnd)
+        {
+            resampler->pushEndPadding();
+            paddedEnd = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return done;
+}
+
+int PreviewStream::read(juce::AudioBuffer<float>& dest, int destStart, int numFrames, juce::int64 position)
+{
+    // Whatever the cached head covers is a copy
+    int done = 0;
+    if (head != nullptr && position < head->getNumFrames())
+    {
+        done = (int) juce::jmin((juce::int64) numFrames, head->getNumFrames() - position);
+        for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+            dest.copyFrom(channel, destStart, head->audio, channel, (int) position, done);
+    }
+
+    if (done == numFrames)
+        return done;
+
+    if (reader == nullptr && openReader)
+    {
+        reader = openReader(head->file);
+        openReader = nullptr; // One attempt
+        if (reader == nullptr)
+        {
+            // Play what we have rather than stall at the end of the head
+            juce::Logger::writeToLog("PreviewStream: Could not open " + head->file.getFullPathName());
+            length = position + done;
+            return done;
+        }
+    }
+
+    if (reader == nullptr)
+        return done;
+
+    reader->read(&dest, destStart + done, numFrames - done, position + done, true, dest.getNumChannels() > 1);
+    return numFrames;
+}
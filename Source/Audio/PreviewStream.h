@@ -0,0 +1,94 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PreviewCache.h"
+#include "SincResampler.h"
+#include <atomic>
+
+/**
+ * PreviewStream - decodes a file ahead of playback into a ring buffer, at the rate it
+ * will be played at
+ *
+ * The file is read, decoded and (if its rate differs from the output's) resampled on
+ * an I/O thread (a TimeSliceThread shared by all streams), so the audio thread only
+ * ever copies frames out of memory, however slow the disk or the codec. The ring holds
+ * bufferFrames frames of up to two channels. Lengths and positions are in frames at
+ * the output rate.
+ *
+ * Single producer, single consumer: the I/O thread writes, and whoever plays the
+ * stream (the audio thread, once a voice has been handed over) reads and seeks.
+ * A seek bumps a generation counter; the consumer drops whatever was decoded for the
+ * old position and the producer refills from the new one once the ring has drained,
+ * so neither side ever waits on the other.
+ *
+ * A stream can also start from a cached DecodedHead: frames inside the head are copied
+ * from memory, and the file is only opened (on the I/O thread) once playback or a seek
+ * goes past it.
+ */
+class PreviewStream : public juce::TimeSliceClient
+{
+public:
+    PreviewStream(std::unique_ptr<juce::AudioFormatReader> sourceReader, double outputRate, int bufferFrames = 32768);
+    // openReader is called on the I/O thread, if and when the head runs out
+    PreviewStream(std::shared_ptr<const DecodedHead> cachedHead, PreviewCache::ReaderFactory openReader,
+                  double outputRate, int bufferFrames = 32768);
+
+    int getNumChannels() const noexcept     { return ring.getNumChannels(); }
+    // Shrinks to the head's length if the rest of the file turns out to be unreadable
+    juce::int64 getLength() const noexcept;
+    double getSampleRate() const noexcept   { return outputRate.load(); }
+    double getSourceRate() const noexcept   { return sourceRate; }
+
+    // Decodes up to numFrames right away; for the loading thread, before the stream is
+    // added to an I/O thread
+    void prefill(int numFrames);
+
+    //==============================================================================
+    // Consumer side; none of these block or allocate
+    void seek(juce::int64 frame) noexcept;
+    // Takes effect with the next seek(), which should follow straight away
+    void setOutputRate(double newRate) noexcept { outputRate = newRate; }
+    // Copies up to numFrames of what's ready into dest (from destStart on), without
+    // consuming them. Returns 0 until the frames for the last seek position start arriving.
+    int peek(juce::AudioBuffer<float>& dest, int destStart, int numFrames) noexcept;
+    void consume(int numFrames) noexcept;
+    int getUnderruns() const noexcept       { return underruns.load(); }
+    void noteUnderrun() noexcept            { ++underruns; }
+
+    //==============================================================================
+    int useTimeSlice() override;
+
+private:
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    std::shared_ptr<const DecodedHead> head;
+    PreviewCache::ReaderFactory openReader;
+    std::atomic<juce::int64> length;        // In source frames
+    const double sourceRate;
+
+    juce::AudioBuffer<float> ring;
+    juce::AbstractFifo fifo;
+
+    // Written by the consumer
+    std::atomic<double> outputRate;
+    std::atomic<juce::int64> seekTarget { 0 };
+    std::atomic<juce::uint32> generation { 0 };
+    // Written by the producer
+    std::atomic<juce::uint32> producedGeneration { 0 };
+    juce::int64 writePosition = 0;          // Next frame into the ring
+    juce::int64 sourcePosition = 0;         // Next frame out of the file
+    double producerRate = 0.0;
+    std::unique_ptr<SincResampler> resampler;   // Only while the rates differ
+    juce::AudioBuffer<float> sourceBlock;
+    bool paddedEnd = false;
+
+    std::atomic<int> underruns { 0 };
+
+    static constexpr int framesPerRead = 4096;
+    void startAt(juce::int64 frame);
+    int fill(int maxFrames);
+    int produce(int ringStart, int numFrames);
+    // Source frames into dest; returns how many it managed
+    int read(juce::AudioBuffer<float>& dest, int destStart, int numFrames, juce::int64 position);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreviewStream)
+};
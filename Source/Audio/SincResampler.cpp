@@ -0,0 +1,227 @@
+#include "SincResampler.h"
+#include <cstring>
+#include <numeric>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    juce::int64 toHz(double rate)
+    {
+        return juce::jmax((juce::int64) 1, (juce::int64) std::llround(rate));
+    }
+
+    // Zeroth-order modified Bessel function of the first kind, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+        {
+            auto half = x / (2.0 * k);
+            term *= half * half;
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+//==============================================================================
+SincResampler::SincResampler(double sourceRate, double targetRate, int numChannels)
+    : sourceHz(toHz(sourceRate)), targetHz(toHz(targetRate))
+{
+    auto divisor = std::gcd(sourceHz, targetHz);
+    step = sourceHz / divisor;
+    modulus = targetHz / divisor;
+
+    // Cutoff relative to the source's Nyquist; below 1 when downsampling. The filter
+    // gets longer by the same factor, so its transition band stays as steep.
+    auto scale = juce::jmin(1.0, (double) modulus / (double) step);
+    halfTaps = ((int) std::ceil(zeroCrossings / scale) + 3) & ~3;  // Whole SIMD registers
+    numTaps = 2 * halfTaps;
+    numPhases = (int) juce::jmin((juce::int64) maxPhases, (juce::int64) (maxCoefficients / numTaps), modulus);
+
+    // Passband to ~0.42 of the lower rate, stopband (-80 dB or so) from its Nyquist
+    const double cutoff = 0.46 * scale;  // Cycles per source frame
+    const double beta = 8.0;
+    const double window = besselI0(beta);
+
+    coefficients.resize((size_t) (numPhases + 1) * (size_t) numTaps);
+    for (int row = 0; row <= numPhases; ++row)
+    {
+        auto* taps = coefficients.data() + (size_t) row * (size_t) numTaps;
+        auto fraction = (double) row / (double) numPhases;
+        double sum = 0.0;
+
+        for (int i = 0; i < numTaps; ++i)
+        {
+            auto x = (double) (i - (halfTaps - 1)) - fraction;  // Distance from the output time
+            auto t = x / (double) halfTaps;
+            auto w = std::abs(t) < 1.0 ? besselI0(beta * std::sqrt(1.0 - t * t)) / window : 0.0;
+            auto arg = 2.0 * cutoff * x;
+            auto sinc = std::abs(arg) < 1.0e-9 ? 1.0 : std::sin(juce::MathConstants<double>::pi * arg)
+                                                       / (juce::MathConstants<double>::pi * arg);
+            auto h = 2.0 * cutoff * sinc * w;
+            taps[i] = (float) h;
+            sum += h;
+        }
+
+        // Unity gain at DC for every phase, so quantised phases don't turn into ripple
+        for (int i = 0; i < numTaps; ++i)
+            taps[i] = (float) (taps[i] / sum);
+    }
+
+    history.setSize(juce::jmax(1, numChannels), 2 * numTaps + maxPushFrames);
+    reset(0);
+}
+
+juce::int64 SincResampler::getOutputLength(juce::int64 sourceLength) const noexcept
+{
+    return (sourceLength * modulus + step - 1) / step;
+}
+
+juce::int64 SincResampler::getOutputLength(juce::int64 sourceLength, double sourceRate, double targetRate) noexcept
+{
+    auto source = toHz(sourceRate), target = toHz(targetRate);
+    auto divisor = std::gcd(source, target);
+    return (sourceLength * (target / divisor) + source / divisor - 1) / (source / divisor);
+}
+
+bool SincResampler::isIdentity(double sourceRate, double targetRate) noexcept
+{
+    return toHz(sourceRate) == toHz(targetRate);
+}
+
+juce::int64 SincResampler::reset(juce::int64 outputFrame)
+{
+    auto position = juce::jmax((juce::int64) 0, outputFrame) * step;
+    auto base = position / modulus;
+    phase = position % modulus;
+
+    history.clear();
+    historyEnd = 0;
+    centre = halfTaps - 1;
+
+    // The filter reaches back halfTaps - 1 frames; before the start of the file that's silence
+    auto first = base - (halfTaps - 1);
+    if (first < 0)
+    {
+        pushSilence((int) -first);
+        return 0;
+    }
+    return first;
+}
+
+//==============================================================================
+int SincResampler::getFreeSpace() const noexcept
+{
+    auto keepFrom = centre - halfTaps + 1;
+    return juce::jmin(maxPushFrames, history.getNumSamples() - (historyEnd - keepFrom));
+}
+
+void SincResampler::push(const juce::AudioBuffer<float>& source, int startFrame, int numFrames) noexcept
+{
+    numFrames = juce::jmin(numFrames, getFreeSpace());
+    if (numFrames <= 0 || source.getNumChannels() == 0)
+        return;
+
+    compact(numFrames);
+    for (int channel = 0; channel < history.getNumChannels(); ++channel)
+        history.copyFrom(channel, historyEnd, source, juce::jmin(channel, source.getNumChannels() - 1), startFrame, numFrames);
+    historyEnd += numFrames;
+}
+
+void SincResampler::pushSilence(int numFrames) noexcept
+{
+    numFrames = juce::jmin(numFrames, getFreeSpace());
+    if (numFrames <= 0)
+        return;
+
+    compact(numFrames);
+    for (int channel = 0; channel < history.getNumChannels(); ++channel)
+        history.clear(channel, historyEnd, numFrames);
+    historyEnd += numFrames;
+}
+
+void SincResampler::compact(int framesNeeded) noexcept
+{
+    if (historyEnd + framesNeeded <= history.getNumSamples())
+        return;
+
+    // Drop what the filter has moved past
+    auto keepFrom = centre - halfTaps + 1;
+    auto numKept = historyEnd - keepFrom;
+    for (int channel = 0; channel < history.getNumChannels(); ++channel)
+    {
+        auto* data = history.getWritePointer(channel);
+        std::memmove(data, data + keepFrom, (size_t) numKept * sizeof(float));
+    }
+    centre -= keepFrom;
+    historyEnd = numKept;
+}
+
+int SincResampler::process(juce::AudioBuffer<float>& dest, int destStart, int numFrames) noexcept
+{
+    auto numChannels = juce::jmin(dest.getNumChannels(), history.getNumChannels());
+    int produced = 0;
+
+    for (; produced < numFrames && centre + halfTaps < historyEnd; ++produced)
+    {
+        auto row = (int) ((phase * numPhases + modulus / 2) / modulus);
+        auto* taps = coefficients.data() + (size_t) row * (size_t) numTaps;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            dest.getWritePointer(channel, destStart + produced)[0]
+                = dot(history.getReadPointer(channel, centre - halfTaps + 1), taps, numTaps);
+
+        phase += step;
+        centre += (int) (phase / modulus);
+        phase %= modulus;
+    }
+    return produced;
+}
+
+float SincResampler::dot(const float* samples, const float* taps, int count) noexcept
+{
+    // count is always a multiple of 8
+#if JUCE_USE_SSE_INTRINSICS
+    auto sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    for (int i = 0; i < count; i += 8)
+    {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(taps + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(taps + i + 4)));
+    }
+    auto sum = _mm_add_ps(sum0, sum1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    auto sum0 = vdupq_n_f32(0.0f), sum1 = vdupq_n_f32(0.0f);
+    for (int i = 0; i < count; i += 8)
+    {
+        sum0 = vmlaq_f32(sum0, vld1q_f32(samples + i), vld1q_f32(taps + i));
+        sum1 = vmlaq_f32(sum1, vld1q_f32(samples + i + 4), vld1q_f32(taps + i + 4));
+    }
+    auto sum = vaddq_f32(sum0, sum1);
+    auto pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+    return dotScalar(samples, taps, count);
+#endif
+}
+
+float SincResampler::dotScalar(const float* samples, const float* taps, int count) noexcept
+{
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    for (int i = 0; i < count; i += 4)
+    {
+        sum0 += samples[i] * taps[i];
+        sum1 += samples[i + 1] * taps[i + 1];
+        sum2 += samples[i + 2] * taps[i + 2];
+        sum3 += samples[i + 3] * taps[i + 3];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
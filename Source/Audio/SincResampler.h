@@ -0,0 +1,70 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+ * SincResampler - band-limited sample rate conversion for previews
+ *
+ * A polyphase windowed-sinc (Kaiser) filter. The rates are taken as whole Hz, so the
+ * conversion is an exact rational one: output frame k always lines up with source
+ * frame k * sourceRate / targetRate, however long it runs, and a seek lands on the
+ * same phase as playing through. For the usual pairs (44.1k <-> 48k, 96k...) every
+ * phase gets its own set of coefficients; unusual pairs share up to maxPhases.
+ *
+ * When downsampling, the cutoff and the filter length scale with the ratio, so
+ * nothing above the new Nyquist folds back. The inner loop is SSE or NEON where
+ * available. Meant for a streaming thread: reset() and the constructor allocate,
+ * push() and process() don't.
+ */
+class SincResampler
+{
+public:
+    SincResampler(double sourceRate, double targetRate, int numChannels);
+
+    double getSourceRate() const noexcept   { return (double) sourceHz; }
+    double getTargetRate() const noexcept   { return (double) targetHz; }
+
+    // Output frames a source of this length turns into
+    juce::int64 getOutputLength(juce::int64 sourceLength) const noexcept;
+    static juce::int64 getOutputLength(juce::int64 sourceLength, double sourceRate, double targetRate) noexcept;
+    static bool isIdentity(double sourceRate, double targetRate) noexcept;
+
+    // Starts over at outputFrame; returns the source frame to push from. Anything before
+    // the start of the source is filled in with silence.
+    juce::int64 reset(juce::int64 outputFrame);
+
+    // Source frames push() can take right now
+    int getFreeSpace() const noexcept;
+    void push(const juce::AudioBuffer<float>& source, int startFrame, int numFrames) noexcept;
+    // For past the end of the source: this much lets the last output frame be produced
+    void pushEndPadding() noexcept          { pushSilence(halfTaps); }
+
+    // Produces up to numFrames from what has been pushed; returns how many
+    int process(juce::AudioBuffer<float>& dest, int destStart, int numFrames) noexcept;
+
+private:
+    static constexpr int zeroCrossings = 32;        // Each side, at the source rate
+    static constexpr int maxPhases = 1024;
+    static constexpr int maxCoefficients = 1 << 18;
+    static constexpr int maxPushFrames = 8192;
+
+    juce::int64 sourceHz, targetHz;
+    juce::int64 step, modulus;           // Source frames per output frame = step / modulus
+
+    int halfTaps, numTaps, numPhases;
+    std::vector<float> coefficients;     // (numPhases + 1) rows of numTaps
+
+    juce::AudioBuffer<float> history;
+    int centre = 0;                      // Source frame under the current output frame
+    juce::int64 phase = 0;               // How far past it, in 1/modulus frames
+    int historyEnd = 0;
+
+    void pushSilence(int numFrames) noexcept;
+    void compact(int framesNeeded) noexcept;
+    static float dot(const float* samples, const float* taps, int numTaps) noexcept;
+    static float dotScalar(const float* samples, const float* taps, int numTaps) noexcept;
+
+    friend class SincResamplerTest;
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SincResampler)
+};
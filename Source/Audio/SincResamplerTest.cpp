@@ -0,0 +1,186 @@
+#include "SincResamplerTest.h"
+#include <cmath>
+
+//==============================================================================
+bool SincResamplerTest::runAllTests()
+{
+    juce::Logger::writeToLog("=== SINC RESAMPLER TEST SUITE ===");
+
+    std::vector<TestResult> results;
+    results.push_back(testSimdMatchesScalar());
+    results.push_back(testSineKeepsFrequencyAndAmplitude(44100.0, 48000.0, 1000.0));
+    results.push_back(testSineKeepsFrequencyAndAmplitude(44100.0, 48000.0, 15000.0));
+    results.push_back(testSineKeepsFrequencyAndAmplitude(48000.0, 44100.0, 1000.0));
+
+    int passedTests = 0;
+    for (const auto& result : results)
+    {
+        if (result.success)
+            ++passedTests;
+        juce::Logger::writeToLog(result.toString());
+    }
+
+    juce::Logger::writeToLog(juce::String::formatted("Tests: %d/%d passed", passedTests, (int) results.size()));
+    return passedTests == (int) results.size();
+}
+
+//==============================================================================
+SincResamplerTest::TestResult SincResamplerTest::testSimdMatchesScalar()
+{
+    TestResult result;
+    result.message = "SIMD dot product matches the scalar one";
+
+#if ! JUCE_USE_SSE_INTRINSICS && ! (defined (__ARM_NEON) || defined (__ARM_NEON__))
+    result.success = true;
+    result.details = "No SIMD path in this build";
+#else
+    // Every tap count the resampler uses is a multiple of 8. The pointers are offset by
+    // one float as well, since history rows start anywhere.
+    juce::Random random(1234);
+    std::vector<float> samples(4096 + 1), taps(4096 + 1);
+    for (auto* data : { &samples, &taps })
+        for (auto& value : *data)
+            value = random.nextFloat() * 2.0f - 1.0f;
+
+    double worst = 0.0;
+    for (int offset = 0; offset < 2; ++offset)
+    {
+        for (int count = 8; count <= 4096; count += 8)
+        {
+            auto simd = SincResampler::dot(samples.data() + offset, taps.data() + offset, count);
+            auto scalar = SincResampler::dotScalar(samples.data() + offset, taps.data() + offset, count);
+
+            // Both round differently; allow for that relative to the size of the terms
+            double magnitude = 0.0;
+            for (int i = 0; i < count; ++i)
+                magnitude += std::abs((double) samples[(size_t) (i + offset)] * taps[(size_t) (i + offset)]);
+
+            auto error = std::abs((double) simd - (double) scalar) / magnitude;
+            worst = juce::jmax(worst, error);
+            if (error > 1.0e-5)
+            {
+                result.details = "Count " + juce::String(count) + ", offset " + juce::String(offset) + ": SIMD "
+                               + juce::String(simd, 7) + ", scalar " + juce::String(scalar, 7);
+                return result;
+            }
+        }
+    }
+
+    result.success = true;
+    result.details = "Worst relative difference " + juce::String(worst, 9);
+#endif
+    return result;
+}
+
+SincResamplerTest::TestResult SincResamplerTest::testSineKeepsFrequencyAndAmplitude(double sourceRate, double targetRate,
+                                                                                       double frequency)
+{
+    TestResult result;
+    result.message = juce::String(frequency / 1000.0, 1) + " kHz sine from " + juce::String(sourceRate / 1000.0, 1)
+                   + " to " + juce::String(targetRate / 1000.0, 1) + " kHz";
+
+    const double amplitude = 0.5;
+    juce::AudioBuffer<float> source(1, (int) sourceRate);
+    for (int i = 0; i < source.getNumSamples(); ++i)
+        source.setSample(0, i, (float) (amplitude * std::sin(juce::MathConstants<double>::twoPi * frequency * i / sourceRate)));
+
+    auto output = resample(source, sourceRate, targetRate);
+    if (output.getNumSamples() != (int) SincResampler::getOutputLength(source.getNumSamples(), sourceRate, targetRate))
+    {
+        result.details = "Produced " + juce::String(output.getNumSamples()) + " frames, expected "
+                       + juce::String(SincResampler::getOutputLength(source.getNumSamples(), sourceRate, targetRate));
+        return result;
+    }
+
+    // Measure away from the ends, where the filter runs into silence. Upward zero
+    // crossings, interpolated, give the frequency; RMS over whole cycles the level.
+    auto* data = output.getReadPointer(0);
+    const int start = output.getNumSamples() / 10, end = output.getNumSamples() - start;
+    double firstCrossing = -1.0, lastCrossing = -1.0;
+    int numCrossings = 0;
+    for (int i = start; i < end; ++i)
+    {
+        if (data[i - 1] < 0.0f && data[i] >= 0.0f)
+        {
+            auto crossing = (i - 1) + data[i - 1] / (data[i - 1] - data[i]);
+            if (firstCrossing < 0.0)
+                firstCrossing = crossing;
+            lastCrossing = crossing;
+            ++numCrossings;
+        }
+    }
+
+    if (numCrossings < 2)
+    {
+        result.details = "No cycles found in the output";
+        return result;
+    }
+
+    auto measuredFrequency = (numCrossings - 1) * targetRate / (lastCrossing - firstCrossing);
+
+    double sumOfSquares = 0.0;
+    auto first = (int) std::ceil(firstCrossing), last = (int) std::floor(lastCrossing);
+    for (int i = first; i <= last; ++i)
+        sumOfSquares += (double) data[i] * data[i];
+    auto measuredAmplitude = std::sqrt(2.0 * sumOfSquares / (last - first + 1));
+    auto levelDb = juce::Decibels::gainToDecibels(measuredAmplitude / amplitude);
+
+    // Output frame k lines up with source time k / targetRate, so the ideal sine is known exactly
+    double worstError = 0.0;
+    for (int i = start; i < end; ++i)
+        worstError = juce::jmax(worstError, std::abs(data[i] - amplitude * std::sin(juce::MathConstants<double>::twoPi
+                                                                                     * frequency * i / targetRate)));
+
+    auto measurements = juce::String(measuredFrequency, 3) + " Hz, " + juce::String(levelDb, 4) + " dB, worst error "
+                      + juce::String(juce::Decibels::gainToDecibels(worstError / amplitude), 1) + " dB";
+
+    if (std::abs(measuredFrequency - frequency) > frequency * 1.0e-5)
+        result.details = "Frequency moved: " + measurements;
+    else if (std::abs(levelDb) > 0.05)
+        result.details = "Level changed: " + measurements;
+    else if (worstError > amplitude * 0.001)
+        result.details = "Waveform differs from the ideal sine: " + measurements;
+    else
+    {
+        result.success = true;
+        result.details = measurements;
+    }
+    return result;
+}
+
+//==============================================================================
+juce::AudioBuffer<float> SincResamplerTest::resample(const juce::AudioBuffer<float>& source, double sourceRate, double targetRate)
+{
+    SincResampler resampler(sourceRate, targetRate, source.getNumChannels());
+    juce::AudioBuffer<float> output(source.getNumChannels(),
+                                    (int) SincResampler::getOutputLength(source.getNumSamples(), sourceRate, targetRate));
+
+    auto sourcePosition = (int) resampler.reset(0);
+    bool paddedEnd = false;
+    int done = 0;
+    while (done < output.getNumSamples())
+    {
+        done += resampler.process(output, done, output.getNumSamples() - done);
+        if (done == output.getNumSamples())
+            break;
+
+        if (sourcePosition < source.getNumSamples())
+        {
+            auto wanted = juce::jmin(resampler.getFreeSpace(), source.getNumSamples() - sourcePosition);
+            resampler.push(source, sourcePosition, wanted);
+            sourcePosition += wanted;
+        }
+        else if (!paddedEnd)
+        {
+            resampler.pushEndPadding();
+            paddedEnd = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    output.setSize(output.getNumChannels(), done, true);
+    return output;
+}
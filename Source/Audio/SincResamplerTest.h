@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SincResampler.h"
+
+/**
+ * Tests for SincResampler
+ *
+ * Checks the SIMD inner loop against the plain one, and that a resampled sine
+ * comes out at the same frequency and level.
+ */
+class SincResamplerTest
+{
+public:
+    struct TestResult
+    {
+        bool success = false;
+        juce::String message;
+        juce::String details;
+
+        juce::String toString() const
+        {
+            juce::String result = success ? "✅ PASS: " : "❌ FAIL: ";
+            result += message;
+            if (details.isNotEmpty())
+                result += "\n   Details: " + details;
+            return result;
+        }
+    };
+
+    bool runAllTests();
+
+    TestResult testSimdMatchesScalar();
+    TestResult testSineKeepsFrequencyAndAmplitude(double sourceRate, double targetRate, double frequency);
+
+private:
+    // Runs a whole source through a resampler the way PreviewStream does
+    static juce::AudioBuffer<float> resample(const juce::AudioBuffer<float>& source, double sourceRate, double targetRate);
+};
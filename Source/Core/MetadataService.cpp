@@ -1,9 +1,53 @@
 #include "MetadataService.h"
 #include "ChordParser.h"
 #include "../Utils/FilenameUtils.h"
+#include "../Utils/ContentHash.h"
+#include "../Utils/RiffChunkReader.h"
+#include "../Utils/AudioHeaderProbe.h"
 #include <fstream>
 #include <algorithm>
 #include <cstring>  // for memcpy
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if ! JUCE_WINDOWS
+ #include <sys/stat.h>
+#endif
+
+namespace
+{
+    void applyAudioFormat(ChopsDatabase::SampleInfo& sampleInfo, const AudioHeaderProbe::Info& format)
+    {
+        sampleInfo.durationMs = format.durationMs;
+        sampleInfo.sampleRate = format.sampleRate;
+        sampleInfo.bitDepth = format.bitDepth;
+        sampleInfo.channels = format.channels;
+    }
+    
+    ChopsDatabase::FileStamp readFileStamp(const juce::File& file, juce::int64 size, juce::Time modified)
+    {
+        ChopsDatabase::FileStamp stamp;
+        stamp.size = size;
+        stamp.modifiedMs = modified.toMilliseconds();
+       #if ! JUCE_WINDOWS
+        struct stat info;
+        if (::stat(file.getFullPathName().toRawUTF8(), &info) == 0)
+        {
+            stamp.inode = (juce::int64) info.st_ino;
+            stamp.device = (juce::int64) info.st_dev;
+        }
+       #endif
+        return stamp;
+    }
+    
+    ChopsDatabase::FileStamp readFileStamp(const juce::File& file)
+    {
+        return readFileStamp(file, file.getSize(), file.getLastModificationTime());
+    }
+}
 
 //==============================================================================
 MetadataService::MetadataService()
@@ -115,17 +159,18 @@ bool MetadataService::readMetadataFromFile(const juce::File& audioFile, ChordMet
         return false;
     }
     
-    juce::String iXMLContent;
-    if (!readIXMLChunk(audioFile, iXMLContent))
+    MetadataChunks chunks;
+    if (!readMetadataChunks(audioFile, chunks))
     {
         // No iXML chunk found - not an error, just means no metadata
         return false;
     }
     
-    return iXMLToMetadata(iXMLContent, metadata);
+    return chunksToMetadata(chunks, metadata);
 }
 
-bool MetadataService::writeMetadataToFile(const juce::File& audioFile, const ChordMetadata& metadata)
+bool MetadataService::writeMetadataToFile(const juce::File& audioFile, const ChordMetadata& metadata,
+                                          juce::int64* bytesWritten)
 {
     if (!audioFile.existsAsFile() || !isAudioFile(audioFile))
     {
@@ -140,7 +185,7 @@ bool MetadataService::writeMetadataToFile(const juce::File& audioFile, const Cho
     }
     
     juce::String iXMLContent = metadataToIXML(metadata);
-    return writeIXMLChunk(audioFile, iXMLContent);
+    return writeMetadataChunks(audioFile, iXMLContent, metadata, bytesWritten);
 }
 
 bool MetadataService::hasMetadata(const juce::File& audioFile)
@@ -205,6 +250,9 @@ bool MetadataService::syncFileWithDatabase(const juce::File& audioFile, ChopsDat
         {
             // File has metadata - add to database
             auto sampleInfo = fileMetadata.toDatabaseSampleInfo(filePath, audioFile.getSize());
+            AudioHeaderProbe::Info format;
+            sampleInfo.contentHash = ContentHash::ofAudioData(audioFile, format);
+            applyAudioFormat(sampleInfo, format);
             int newId = database->insertSample(sampleInfo);
             return newId > 0;
         }
@@ -234,6 +282,9 @@ bool MetadataService::syncFileWithDatabase(const juce::File& audioFile, ChopsDat
                 // Write to file and database
                 bool fileWritten = writeMetadataToFile(audioFile, newMetadata);
                 auto sampleInfo = newMetadata.toDatabaseSampleInfo(filePath, audioFile.getSize());
+                AudioHeaderProbe::Info format;
+                sampleInfo.contentHash = ContentHash::ofAudioData(audioFile, format);
+                applyAudioFormat(sampleInfo, format);
                 int newId = database->insertSample(sampleInfo);
                 
                 return fileWritten && (newId > 0);
@@ -277,12 +328,29 @@ bool MetadataService::updateFileMetadata(const juce::File& audioFile, const Chor
     }
 }
 
+bool MetadataService::writeSampleToFile(const ChopsDatabase::SampleInfo& sample, ChopsDatabase* database,
+                                        juce::int64* bytesWritten)
+{
+    juce::File audioFile(sample.filePath);
+    if (!database || sample.id <= 0 || !audioFile.existsAsFile())
+        return false;
+    
+    // dateModified is kept, so file and row still compare as in sync
+    if (!writeMetadataToFile(audioFile, ChordMetadata::fromDatabaseSampleInfo(sample), bytesWritten))
+        return false;
+    
+    return database->setFileStamp(sample.id, readFileStamp(audioFile));
+}
+
 //==============================================================================
 // iXML Implementation (WAV chunk handling)
 //==============================================================================
 
-bool MetadataService::readIXMLChunk(const juce::File& audioFile, juce::String& iXMLContent)
+bool MetadataService::readMetadataChunks(const juce::File& audioFile, MetadataChunks& chunks,
+                                         AudioHeaderProbe::Info* format)
 {
+    chunks = MetadataChunks();
+    
     if (!audioFile.existsAsFile())
     {
         juce::Logger::writeToLog("MetadataService: File does not exist: " + audioFile.getFullPathName());
@@ -298,60 +366,64 @@ bool MetadataService::readIXMLChunk(const juce::File& audioFile, juce::String& i
             return false;
         }
         
-        // Read entire file into memory for easier parsing
-        juce::MemoryBlock fileData;
-        inputStream.readIntoMemoryBlock(fileData);
-        // FileInputStream closes automatically when it goes out of scope
-        
-        if (fileData.getSize() < 12) // Minimum for RIFF header
+        // Walk chunk headers only; the audio data is never read
+        RiffChunkReader reader(inputStream);
+        if (!reader.isValid())
         {
-            juce::Logger::writeToLog("MetadataService: File too small to be a WAV file");
+            // No iXML in AIFF, FLAC or MP3, but their headers still describe the audio
+            if (format != nullptr)
+                *format = AudioHeaderProbe::probe(inputStream);
+            juce::Logger::writeToLog("MetadataService: Not a valid WAV file: " + audioFile.getFileName());
             return false;
         }
         
-        const char* data = static_cast<const char*>(fileData.getData());
-        size_t fileSize = fileData.getSize();
-        
-        // Verify RIFF/WAVE header
-        if (strncmp(data, "RIFF", 4) != 0 || strncmp(data + 8, "WAVE", 4) != 0)
+        // The same walk picks up 'fmt ' and 'data' for the format
+        AudioHeaderProbe::WaveChunks formatChunks;
+        RiffChunkReader::Chunk chunk, iXMLChunk, binaryChunk;
+        while (reader.next(chunk))
         {
-            juce::Logger::writeToLog("MetadataService: Not a valid WAV file: " + audioFile.getFileName());
-            return false;
+            if (chunk.is("iXML") && !chunks.hasIXML)
+            {
+                iXMLChunk = chunk;
+                chunks.hasIXML = true;
+            }
+            else if (chunk.is(binaryChunkId) && !chunks.hasBinary)
+            {
+                binaryChunk = chunk;
+                chunks.hasBinary = true;
+            }
+            else
+            {
+                formatChunks.add(chunk);
+            }
+            
+            if (chunks.hasIXML && chunks.hasBinary && (format == nullptr || formatChunks.hasFormatAndData()))
+                break;
         }
         
-        // Search for iXML chunk
-        size_t pos = 12; // Start after RIFF header
+        if (format != nullptr)
+            *format = formatChunks.read(reader);
         
-        while (pos + 8 <= fileSize) // Need at least 8 bytes for chunk header
+        if (chunks.hasBinary && !reader.readPayload(binaryChunk, chunks.binary))
+            chunks.hasBinary = false;
+        
+        if (chunks.hasIXML)
         {
-            const char* chunkId = data + pos;
-            uint32_t chunkSize;
-            memcpy(&chunkSize, data + pos + 4, 4);
-            
-            if (strncmp(chunkId, "iXML", 4) == 0)
+            if (!reader.readPayload(iXMLChunk, chunks.iXML))
             {
-                // Found iXML chunk
-                if (pos + 8 + chunkSize <= fileSize)
-                {
-                    const char* chunkData = data + pos + 8;
-                    iXMLContent = juce::String::fromUTF8(chunkData, static_cast<int>(chunkSize));
-                    
-                    juce::Logger::writeToLog("MetadataService: Found iXML chunk (size: " + juce::String(chunkSize) + " bytes)");
-                    return true;
-                }
-                else
-                {
-                    juce::Logger::writeToLog("MetadataService: iXML chunk extends beyond file boundary");
-                    return false;
-                }
+                juce::Logger::writeToLog("MetadataService: Could not read iXML chunk (size: " + juce::String(iXMLChunk.size) + " bytes)");
+                chunks.hasIXML = false;
+                return false;
             }
             
-            // Move to next chunk
-            pos += 8 + chunkSize;
+            // Writers often pad the XML with trailing NULs
+            auto length = chunks.iXML.getSize();
+            while (length > 0 && static_cast<const char*>(chunks.iXML.getData())[length - 1] == 0)
+                --length;
+            chunks.iXML.setSize(length);
             
-            // Align to word boundary
-            if (chunkSize % 2 != 0)
-                pos++;
+            juce::Logger::writeToLog("MetadataService: Found iXML chunk (size: " + juce::String(iXMLChunk.size) + " bytes)");
+            return true;
         }
         
         // No iXML chunk found
@@ -369,7 +441,20 @@ bool MetadataService::readIXMLChunk(const juce::File& audioFile, juce::String& i
     }
 }
 
-bool MetadataService::writeIXMLChunk(const juce::File& audioFile, const juce::String& iXMLContent)
+bool MetadataService::chunksToMetadata(const MetadataChunks& chunks, ChordMetadata& metadata)
+{
+    // The binary copy is only trusted if it was written together with exactly this iXML;
+    // another tool may have edited the XML since
+    if (chunks.hasBinary && binaryToMetadata(chunks.binary, hashOf(chunks.iXML), metadata))
+        return true;
+    
+    return chunks.hasIXML
+        && iXMLToMetadata(juce::String::fromUTF8(static_cast<const char*>(chunks.iXML.getData()), (int) chunks.iXML.getSize()),
+                          metadata);
+}
+
+bool MetadataService::writeMetadataChunks(const juce::File& audioFile, const juce::String& iXMLContent,
+                                          const ChordMetadata& metadata, juce::int64* bytesWritten)
 {
     if (iXMLContent.isEmpty())
     {
@@ -377,135 +462,223 @@ bool MetadataService::writeIXMLChunk(const juce::File& audioFile, const juce::St
         return false;
     }
     
-    // Create backup
-    juce::File backupFile = audioFile.withFileExtension(audioFile.getFileExtension() + ".backup");
-    if (!audioFile.copyFileTo(backupFile))
-    {
-        juce::Logger::writeToLog("MetadataService: Could not create backup for: " + audioFile.getFileName());
-        return false;
-    }
+    juce::MemoryBlock iXML(iXMLContent.toRawUTF8(), iXMLContent.getNumBytesAsUTF8());
+    auto binary = metadataToBinary(metadata, hashOf(iXML));
     
     try
     {
-        // Read original file into memory
-        juce::FileInputStream inputStream(audioFile);
-        if (!inputStream.openedOk())
+        // Find the existing iXML chunk and the binary chunk and JUNK padding reserved right after it
+        juce::int64 regionStart = -1, regionSize = 0;
         {
-            juce::Logger::writeToLog("MetadataService: Could not open file for reading: " + audioFile.getFullPathName());
-            backupFile.deleteFile();
-            return false;
+            juce::FileInputStream inputStream(audioFile);
+            if (!inputStream.openedOk())
+            {
+                juce::Logger::writeToLog("MetadataService: Could not open file for reading: " + audioFile.getFullPathName());
+                return false;
+            }
+            
+            RiffChunkReader reader(inputStream);
+            if (!reader.isValid())
+            {
+                juce::Logger::writeToLog("MetadataService: Not a valid WAV file");
+                return false;
+            }
+            
+            RiffChunkReader::Chunk chunk;
+            if (reader.findChunk("iXML", chunk))
+            {
+                regionStart = chunk.headerOffset;
+                auto regionEnd = chunk.getEnd() + (chunk.size & 1);
+                
+                RiffChunkReader::Chunk following;
+                while (reader.next(following) && following.headerOffset == regionEnd
+                       && (following.is(binaryChunkId) || following.is("JUNK")))
+                    regionEnd = following.getEnd() + (following.size & 1);
+                
+                regionSize = juce::jmin(regionEnd, inputStream.getTotalLength()) - regionStart;
+            }
         }
         
-        juce::MemoryBlock originalData;
-        inputStream.readIntoMemoryBlock(originalData);
-        // FileInputStream closes automatically when it goes out of scope
-        
-        if (originalData.getSize() < 44) // Minimum WAV header size
+        if (regionStart >= 0 && writeChunksInPlace(audioFile, iXML, binary, regionStart, regionSize))
         {
-            juce::Logger::writeToLog("MetadataService: File too small to be a valid WAV file");
-            backupFile.deleteFile();
-            return false;
+            juce::Logger::writeToLog("MetadataService: Updated iXML chunk in place: " + audioFile.getFileName());
+            if (bytesWritten != nullptr)
+                *bytesWritten = regionSize;
+            return true;
         }
         
-        // Verify it's a WAV file
-        const char* data = static_cast<const char*>(originalData.getData());
-        if (strncmp(data, "RIFF", 4) != 0 || strncmp(data + 8, "WAVE", 4) != 0)
+        // No chunk yet, or the padding is used up
+        if (rewriteWithChunks(audioFile, iXML, binary))
         {
-            juce::Logger::writeToLog("MetadataService: Not a valid WAV file");
-            backupFile.deleteFile();
+            juce::Logger::writeToLog("MetadataService: Successfully wrote iXML chunk to: " + audioFile.getFileName());
+            if (bytesWritten != nullptr)
+                *bytesWritten = audioFile.getSize();
+            return true;
+        }
+        return false;
+    }
+    catch (const std::exception& e)
+    {
+        juce::Logger::writeToLog("MetadataService: Exception writing iXML: " + juce::String(e.what()));
+        return false;
+    }
+    catch (...)
+    {
+        juce::Logger::writeToLog("MetadataService: Unknown exception writing iXML");
+        return false;
+    }
+}
+
+bool MetadataService::layoutMetadataChunks(const juce::MemoryBlock& iXML, const juce::MemoryBlock& binary,
+                                           juce::int64 regionSize, bool includeJunkPayload,
+                                           juce::MemoryOutputStream& block)
+{
+    auto iXMLSize = (juce::int64) iXML.getSize();
+    auto binarySize = (juce::int64) binary.getSize();
+    auto spare = regionSize - (8 + iXMLSize + (iXMLSize & 1)) - (8 + binarySize + (binarySize & 1));
+    if (spare < 0)
+        return false;
+    
+    block.write("iXML", 4);
+    block.writeInt((int) iXMLSize);
+    block.write(iXML.getData(), iXML.getSize());
+    if (iXMLSize & 1)
+        block.writeByte(0);
+    
+    // Leftovers too small for a JUNK header become NULs at the end of the binary
+    // chunk, which its reader ignores
+    auto binaryChunkSize = spare >= 8 ? binarySize : binarySize + (binarySize & 1) + spare;
+    block.write(binaryChunkId, 4);
+    block.writeInt((int) binaryChunkSize);
+    block.write(binary.getData(), binary.getSize());
+    block.writeRepeatedByte(0, (size_t) (binaryChunkSize + (binaryChunkSize & 1) - binarySize));
+    
+    if (spare >= 8)
+    {
+        block.write("JUNK", 4);
+        block.writeInt((int) (spare - 8));
+        if (includeJunkPayload)
+            block.writeRepeatedByte(0, (size_t) (spare - 8));
+    }
+    return true;
+}
+
+bool MetadataService::writeChunksInPlace(const juce::File& audioFile, const juce::MemoryBlock& iXML,
+                                         const juce::MemoryBlock& binary, juce::int64 regionStart, juce::int64 regionSize)
+{
+    // The old JUNK payload is left as it is; only its header moves
+    juce::MemoryOutputStream block;
+    if (!layoutMetadataChunks(iXML, binary, regionSize, false, block))
+        return false;
+    
+    juce::FileOutputStream outputStream(audioFile);
+    if (!outputStream.openedOk() || !outputStream.setPosition(regionStart))
+        return false;
+    
+    outputStream.write(block.getData(), block.getDataSize());
+    outputStream.flush(); // fsync
+    
+    if (outputStream.getStatus().failed())
+    {
+        juce::Logger::writeToLog("MetadataService: In-place iXML write failed: " + outputStream.getStatus().getErrorMessage());
+        return false;
+    }
+    return true;
+}
+
+bool MetadataService::rewriteWithChunks(const juce::File& audioFile, const juce::MemoryBlock& iXML,
+                                        const juce::MemoryBlock& binary)
+{
+    // Written next to the original and renamed over it, so a crash leaves one or the other.
+    // Hidden and without an audio extension, so a scan running meanwhile ignores it.
+    juce::TemporaryFile tempFile(audioFile, audioFile.getSiblingFile("." + audioFile.getFileName() + ".chops-tmp"));
+    {
+        juce::FileInputStream inputStream(audioFile);
+        juce::FileOutputStream outputStream(tempFile.getFile());
+        if (!inputStream.openedOk() || !outputStream.openedOk())
+        {
+            juce::Logger::writeToLog("MetadataService: Could not open files to rewrite: " + audioFile.getFileName());
             return false;
         }
         
-        // Prepare iXML chunk data
-        juce::String iXMLUtf8 = iXMLContent.toUTF8();
-        uint32_t iXMLSize = static_cast<uint32_t>(iXMLUtf8.getNumBytesAsUTF8());
-        
-        // Calculate total new file size
-        size_t originalSize = originalData.getSize();
-        size_t newFileSize = originalSize + 8 + iXMLSize + (iXMLSize % 2); // +8 for chunk header, +padding
-        
-        // Create new file content
-        juce::MemoryBlock newData(newFileSize);
-        
-        // Copy original data
-        newData.copyFrom(originalData.getData(), 0, originalSize);
-        
-        // Update RIFF chunk size in header
-        uint32_t newRiffSize = static_cast<uint32_t>(newFileSize - 8);
-        newData.copyFrom(&newRiffSize, 4, sizeof(newRiffSize));
-        
-        // Append iXML chunk
-        char* writePtr = static_cast<char*>(newData.getData()) + originalSize;
-        
-        // iXML chunk ID
-        memcpy(writePtr, "iXML", 4);
-        writePtr += 4;
-        
-        // iXML chunk size
-        memcpy(writePtr, &iXMLSize, 4);
-        writePtr += 4;
+        RiffChunkReader reader(inputStream);
+        if (!reader.isValid() || !inputStream.setPosition(0) || outputStream.writeFromInputStream(inputStream, 12) != 12)
+            return false;
         
-        // iXML data
-        memcpy(writePtr, iXMLUtf8.toUTF8().getAddress(), iXMLSize);
-        writePtr += iXMLSize;
+        // Copy every chunk except our old metadata chunks and their padding
+        RiffChunkReader::Chunk chunk;
+        juce::int64 copiedUpTo = 12, ds64Position = -1;
+        bool afterMetadata = false;
         
-        // Padding byte if needed
-        if (iXMLSize % 2 != 0)
+        while (reader.next(chunk))
         {
-            *writePtr = 0;
+            copiedUpTo = chunk.getEnd() + (chunk.size & 1);
+            bool isMetadata = chunk.is("iXML") || chunk.is(binaryChunkId);
+            bool skip = isMetadata || (afterMetadata && chunk.is("JUNK"));
+            afterMetadata = isMetadata;
+            if (skip)
+                continue;
+            
+            if (chunk.is("ds64"))
+                ds64Position = outputStream.getPosition();
+            
+            outputStream.write(chunk.id, 4);
+            outputStream.writeInt((int) juce::jmin(chunk.size, (juce::int64) 0xffffffff));
+            if (!inputStream.setPosition(chunk.dataOffset)
+                || outputStream.writeFromInputStream(inputStream, chunk.size) != chunk.size)
+            {
+                juce::Logger::writeToLog("MetadataService: Could not copy chunk while rewriting: " + audioFile.getFileName());
+                return false;
+            }
+            if (chunk.size & 1)
+                outputStream.writeByte(0);
         }
         
-        // Write new file
-        juce::FileOutputStream outputStream(audioFile);
-        if (!outputStream.openedOk())
+        // A walk that stopped early means a damaged chunk; don't drop what follows it
+        if (copiedUpTo + 8 <= inputStream.getTotalLength())
         {
-            juce::Logger::writeToLog("MetadataService: Could not open file for writing");
-            // Restore from backup
-            backupFile.moveFileTo(audioFile);
+            juce::Logger::writeToLog("MetadataService: Unreadable chunk at offset " + juce::String(copiedUpTo)
+                                     + ", not rewriting: " + audioFile.getFileName());
             return false;
         }
         
-        bool writeSuccess = outputStream.write(newData.getData(), newData.getSize());
-        outputStream.flush();
+        auto iXMLSize = (juce::int64) iXML.getSize(), binarySize = (juce::int64) binary.getSize();
+        auto regionSize = 8 + iXMLSize + (iXMLSize & 1) + 8 + binarySize + (binarySize & 1) + 8 + iXMLReservedPadding;
+        juce::MemoryOutputStream block((size_t) regionSize);
+        layoutMetadataChunks(iXML, binary, regionSize, true, block);
+        outputStream.write(block.getData(), block.getDataSize());
         
-        if (!writeSuccess)
+        auto riffSize = outputStream.getPosition() - 8;
+        if (reader.isRF64())
         {
-            juce::Logger::writeToLog("MetadataService: Failed to write new file content");
-            // FileOutputStream closes automatically when it goes out of scope
-            // Restore from backup
-            audioFile.deleteFile();
-            backupFile.moveFileTo(audioFile);
-            return false;
+            if (ds64Position < 0 || !outputStream.setPosition(ds64Position + 8))
+                return false;
+            outputStream.writeInt64(riffSize);
+        }
+        else
+        {
+            if (riffSize > 0xffffffff || !outputStream.setPosition(4))
+            {
+                juce::Logger::writeToLog("MetadataService: File too large for RIFF: " + audioFile.getFileName());
+                return false;
+            }
+            outputStream.writeInt((int) riffSize);
         }
         
-        // Delete backup on success
-        backupFile.deleteFile();
-        
-        juce::Logger::writeToLog("MetadataService: Successfully wrote iXML chunk to: " + audioFile.getFileName());
-        return true;
-    }
-    catch (const std::exception& e)
-    {
-        juce::Logger::writeToLog("MetadataService: Exception writing iXML: " + juce::String(e.what()));
-        // Restore from backup on error
-        if (backupFile.existsAsFile())
+        outputStream.flush(); // fsync before the rename makes it visible
+        if (outputStream.getStatus().failed())
         {
-            audioFile.deleteFile();
-            backupFile.moveFileTo(audioFile);
+            juce::Logger::writeToLog("MetadataService: Failed to write new file content: " + outputStream.getStatus().getErrorMessage());
+            return false;
         }
-        return false;
     }
-    catch (...)
+    
+    if (!tempFile.overwriteTargetFileWithTemporary())
     {
-        juce::Logger::writeToLog("MetadataService: Unknown exception writing iXML");
-        // Restore from backup on error
-        if (backupFile.existsAsFile())
-        {
-            audioFile.deleteFile();
-            backupFile.moveFileTo(audioFile);
-        }
+        juce::Logger::writeToLog("MetadataService: Could not replace " + audioFile.getFileName());
         return false;
     }
+    return true;
 }
 
 //==============================================================================
@@ -648,12 +821,224 @@ bool MetadataService::iXMLToMetadata(const juce::String& iXMLContent, ChordMetad
     return metadata.isValid();
 }
 
+// Binary chunk layout (little-endian). Fields are only ever appended; readers skip what
+// they don't know, and an incompatible change would get a new chunk ID.
+//   u16 version, u16 flags (bit 0: favourite), u64 hash of the iXML payload,
+//   u8 rating, u8[3] reserved, u32 colour (ARGB), u32 play count,
+//   i64 date added, i64 date modified, i64 last played (ms since epoch, 0 = unset),
+//   then strings as u16 byte count + UTF-8: root, chord type, display name, bass, inversion,
+//   notes, original filename; then lists as u16 count + strings: extensions, alterations,
+//   added notes, suspensions, tags
+juce::MemoryBlock MetadataService::metadataToBinary(const ChordMetadata& metadata, juce::uint64 iXMLHash)
+{
+    juce::MemoryOutputStream out(256);
+    auto writeString = [&out](const juce::String& text) {
+        auto bytes = (int) juce::jmin(text.getNumBytesAsUTF8(), (size_t) 0xffff);
+        out.writeShort((short) bytes);
+        out.write(text.toRawUTF8(), (size_t) bytes);
+    };
+    auto writeList = [&](const juce::StringArray& list) {
+        auto count = juce::jmin(list.size(), 0xffff);
+        out.writeShort((short) count);
+        for (int i = 0; i < count; ++i)
+            writeString(list[i]);
+    };
+    
+    out.writeShort((short) binaryFormatVersion);
+    out.writeShort((short) (metadata.isFavorite ? 1 : 0));
+    out.writeInt64((juce::int64) iXMLHash);
+    out.writeByte((char) juce::jlimit(0, 5, metadata.rating));
+    out.writeRepeatedByte(0, 3);
+    out.writeInt((int) metadata.color.getARGB());
+    out.writeInt(metadata.playCount);
+    out.writeInt64(metadata.dateAdded.toMilliseconds());
+    out.writeInt64(metadata.dateModified.toMilliseconds());
+    out.writeInt64(metadata.lastPlayed.toMilliseconds());
+    
+    for (auto* text : { &metadata.rootNote, &metadata.chordType, &metadata.chordTypeDisplay, &metadata.bassNote,
+                        &metadata.inversion, &metadata.userNotes, &metadata.originalFilename })
+        writeString(*text);
+    for (auto* list : { &metadata.extensions, &metadata.alterations, &metadata.addedNotes,
+                        &metadata.suspensions, &metadata.tags })
+        writeList(*list);
+    
+    return out.getMemoryBlock();
+}
+
+bool MetadataService::binaryToMetadata(const juce::MemoryBlock& binary, juce::uint64 expectedIXMLHash,
+                                       ChordMetadata& metadata)
+{
+    auto* p = static_cast<const juce::uint8*>(binary.getData());
+    auto* end = p + binary.getSize();
+    bool ok = true;
+    
+    auto take = [&](size_t numBytes) -> const juce::uint8* {
+        if (!ok || (size_t) (end - p) < numBytes) { ok = false; return nullptr; }
+        auto* start = p;
+        p += numBytes;
+        return start;
+    };
+    auto readU16 = [&]() { auto* b = take(2); return b != nullptr ? juce::ByteOrder::littleEndianShort(b) : (juce::uint16) 0; };
+    auto readU32 = [&]() { auto* b = take(4); return b != nullptr ? juce::ByteOrder::littleEndianInt(b) : (juce::uint32) 0; };
+    auto readU64 = [&]() { auto* b = take(8); return b != nullptr ? juce::ByteOrder::littleEndianInt64(b) : (juce::uint64) 0; };
+    auto readString = [&]() {
+        auto length = readU16();
+        auto* b = take(length);
+        return b != nullptr ? juce::String::fromUTF8(reinterpret_cast<const char*>(b), length) : juce::String();
+    };
+    auto readList = [&]() {
+        juce::StringArray list;
+        for (int i = readU16(); i > 0 && ok; --i)
+            list.add(readString());
+        return list;
+    };
+    
+    auto version = readU16();
+    auto flags = readU16();
+    if (!ok || version < 1 || readU64() != expectedIXMLHash)
+        return false;
+    
+    ChordMetadata decoded;
+    decoded.isFavorite = (flags & 1) != 0;
+    auto* rating = take(4);
+    decoded.rating = rating != nullptr ? rating[0] : 0;
+    decoded.color = juce::Colour(readU32());
+    decoded.playCount = (int) readU32();
+    decoded.dateAdded = juce::Time((juce::int64) readU64());
+    decoded.dateModified = juce::Time((juce::int64) readU64());
+    decoded.lastPlayed = juce::Time((juce::int64) readU64());
+    
+    for (auto* text : { &decoded.rootNote, &decoded.chordType, &decoded.chordTypeDisplay, &decoded.bassNote,
+                        &decoded.inversion, &decoded.userNotes, &decoded.originalFilename })
+        *text = readString();
+    for (auto* list : { &decoded.extensions, &decoded.alterations, &decoded.addedNotes,
+                        &decoded.suspensions, &decoded.tags })
+        *list = readList();
+    
+    if (!ok)
+        return false;
+    
+    metadata = std::move(decoded);
+    return true;
+}
+
+juce::uint64 MetadataService::hashOf(const juce::MemoryBlock& block)
+{
+    ContentHash::Hasher hasher;
+    hasher.update(block.getData(), block.getSize());
+    return hasher.getDigest();
+}
+
 //==============================================================================
 // Batch Operations
 //==============================================================================
 
+namespace
+{
+    // Blocking queue between two pipeline stages
+    template <typename T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(size_t maxItems) : capacity(juce::jmax((size_t) 1, maxItems)) {}
+        
+        // Blocks while full; false once the queue has been closed
+        bool push(T item)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+            if (closed)
+                return false;
+            items.push_back(std::move(item));
+            notEmpty.notify_one();
+            return true;
+        }
+        
+        // Blocks while empty; false once the queue is closed and drained
+        bool pop(T& item)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+            return take(item);
+        }
+        
+        bool tryPop(T& item)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return take(item);
+        }
+        
+        // No more pushes; consumers still drain what's queued
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            notFull.notify_all();
+            notEmpty.notify_all();
+        }
+        
+        void cancel()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.clear();
+            closed = true;
+            notFull.notify_all();
+            notEmpty.notify_all();
+        }
+        
+    private:
+        const size_t capacity;
+        std::deque<T> items;
+        bool closed = false;
+        std::mutex mutex;
+        std::condition_variable notFull, notEmpty;
+        
+        bool take(T& item)
+        {
+            if (items.empty())
+                return false;
+            item = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+    };
+}
+
+struct MetadataService::ScanItem
+{
+    juce::File file;
+    int sampleId = 0;               // 0 for files the database doesn't know
+    juce::String movedFrom;         // Set when the walker matched a vanished path by inode
+    ChopsDatabase::FileStamp stamp;
+    bool needsSync = true;          // False for a move of an otherwise unchanged file
+    
+    // Filled in by the reader
+    MetadataChunks chunks;
+    juce::int64 fileSize = 0;
+    juce::Time lastModified;
+    AudioHeaderProbe::Info format;  // Read in the same pass as the iXML chunk
+    
+    // Filled in by the parser
+    ChordMetadata metadata;
+    bool hasMetadata = false;
+    bool hadMetadata = false;       // Before the parser generated any from the filename
+    bool metadataWritten = false;
+    juce::uint64 contentHash = 0;   // Only computed for files the database doesn't know
+    juce::String error;
+};
+
 MetadataService::ScanResult MetadataService::scanAndSyncDirectory(const juce::File& directory, ChopsDatabase* database, 
                                                                   bool recursive, bool writeMetadataToFiles)
+{
+    ScanOptions options;
+    options.recursive = recursive;
+    options.writeMetadataToFiles = writeMetadataToFiles;
+    return scanAndSyncDirectory(directory, database, options);
+}
+
+MetadataService::ScanResult MetadataService::scanAndSyncDirectory(const juce::File& directory, ChopsDatabase* database,
+                                                                  const ScanOptions& options)
 {
     ScanResult result;
     
@@ -664,78 +1049,314 @@ MetadataService::ScanResult MetadataService::scanAndSyncDirectory(const juce::Fi
         return result;
     }
     
-    juce::Array<juce::File> audioFiles;
-    // FIXED: Use correct JUCE API for recursive file search
-    directory.findChildFiles(audioFiles, juce::File::findFiles, recursive, "*");
-    
-    for (const auto& file : audioFiles)
+    // One query up front instead of a lookup per file
+    auto stampedFiles = database->getFileStamps();
+    std::unordered_map<juce::String, int> indexByPath;
+    std::unordered_multimap<juce::int64, int> indexByInode;
+    indexByPath.reserve(stampedFiles.size());
+    for (int i = 0; i < (int) stampedFiles.size(); ++i)
     {
-        if (!isAudioFile(file))
-            continue;
-        
-        result.filesProcessed++;
+        indexByPath.emplace(stampedFiles[(size_t) i].filePath, i);
+        if (stampedFiles[(size_t) i].stamp.hasInode())
+            indexByInode.emplace(stampedFiles[(size_t) i].stamp.inode, i);
+    }
+    
+    auto numCpus = juce::SystemStats::getNumCpus();
+    auto numReaders = options.numReaderThreads > 0 ? options.numReaderThreads : juce::jlimit(2, 8, numCpus);
+    auto numParsers = options.numParserThreads > 0 ? options.numParserThreads : juce::jlimit(1, 4, numCpus / 2);
+    auto capacity = (size_t) options.queueCapacity;
+    
+    BoundedQueue<ScanItem> found(capacity), read(capacity), parsed(capacity);
+    std::atomic<int> filesFound { 0 }, filesUnchanged { 0 }, filesMissing { 0 };
+    std::atomic<int> readersLeft { numReaders }, parsersLeft { numParsers };
+    std::atomic<bool> walkerDone { false };
+    std::vector<std::thread> threads;
+    
+    // The walker only stats; files whose stamp still matches never reach the other stages
+    threads.emplace_back([&] {
+        std::vector<bool> seen(stampedFiles.size(), false);
+        auto isUnchanged = [](const ChopsDatabase::StampedFile& stored, juce::int64 size, juce::int64 modifiedMs) {
+            return stored.stamp.size == size && stored.stamp.modifiedMs == modifiedMs
+                && stored.syncedMs != 0 && stored.dateModifiedMs <= stored.syncedMs && stored.hasAudioFormat;
+        };
         
-        try
+        for (const auto& entry : juce::RangedDirectoryIterator(directory, options.recursive, "*", juce::File::findFiles))
         {
-            ChordMetadata metadata;
-            bool hasMetadata = readMetadataFromFile(file, metadata);
+            if (!isAudioFile(entry.getFile()))
+                continue;
+            ++filesFound;
             
-            if (hasMetadata)
+            ScanItem item;
+            item.file = entry.getFile();
+            auto size = entry.getFileSize();
+            auto modifiedMs = entry.getModificationTime().toMilliseconds();
+            
+            auto known = indexByPath.find(item.file.getFullPathName());
+            if (known != indexByPath.end())
             {
-                result.filesWithMetadata++;
+                auto& stored = stampedFiles[(size_t) known->second];
+                seen[(size_t) known->second] = true;
+                if (isUnchanged(stored, size, modifiedMs))
+                {
+                    ++filesUnchanged;
+                    continue;
+                }
+                item.sampleId = stored.sampleId;
             }
             else
             {
-                result.filesWithoutMetadata++;
-                
-                if (writeMetadataToFiles)
+                // A new path with the inode of a path that has gone away is a rename or move
+                item.stamp = readFileStamp(item.file, size, entry.getModificationTime());
+                auto candidates = item.stamp.hasInode() ? indexByInode.equal_range(item.stamp.inode)
+                                                        : std::make_pair(indexByInode.end(), indexByInode.end());
+                for (auto it = candidates.first; it != candidates.second; ++it)
                 {
-                    // Try to generate metadata from filename
-                    ChordParser parser;
-                    auto parsedData = parser.parseFilename(file.getFileName());
+                    auto& stored = stampedFiles[(size_t) it->second];
+                    if (seen[(size_t) it->second] || stored.stamp.device != item.stamp.device
+                        || juce::File(stored.filePath).exists())
+                        continue;
                     
-                    if (FilenameUtils::isValidParsedData(parsedData))
-                    {
-                        ChordMetadata newMetadata;
-                        newMetadata.rootNote = parsedData.rootNote;
-                        newMetadata.chordType = parsedData.standardizedQuality;
-                        newMetadata.chordTypeDisplay = parsedData.getFullChordName();
-                        newMetadata.extensions = parsedData.extensions;
-                        newMetadata.alterations = parsedData.alterations;
-                        newMetadata.addedNotes = parsedData.addedNotes;
-                        newMetadata.suspensions = parsedData.suspensions;
-                        newMetadata.bassNote = parsedData.determinedBassNote;
-                        newMetadata.inversion = parsedData.inversionTextParsed;
-                        newMetadata.originalFilename = file.getFileName();
-                        newMetadata.dateAdded = juce::Time::getCurrentTime();
-                        newMetadata.dateModified = file.getLastModificationTime();
-                        
-                        if (writeMetadataToFile(file, newMetadata))
-                        {
-                            result.metadataWritten++;
-                            hasMetadata = true;
-                            metadata = newMetadata;
-                        }
-                    }
+                    seen[(size_t) it->second] = true;
+                    item.sampleId = stored.sampleId;
+                    item.movedFrom = stored.filePath;
+                    item.needsSync = !isUnchanged(stored, size, modifiedMs);
+                    break;
                 }
             }
             
-            // Sync with database
-            if (hasMetadata && syncFileWithDatabase(file, database))
+            if (!found.push(std::move(item)))
+                break;
+        }
+        
+        // Files we know about under this directory that weren't there
+        for (size_t i = 0; i < stampedFiles.size(); ++i)
+        {
+            if (seen[i])
+                continue;
+            juce::File file(stampedFiles[i].filePath);
+            if (options.recursive ? file.isAChildOf(directory) : file.getParentDirectory() == directory)
+                ++filesMissing;
+        }
+        
+        walkerDone = true;
+        found.close();
+    });
+    
+    for (int i = 0; i < numReaders; ++i)
+    {
+        threads.emplace_back([&] {
+            ScanItem item;
+            while (found.pop(item))
+            {
+                readScanItem(item);
+                if (!read.push(std::move(item)))
+                    break;
+            }
+            if (--readersLeft == 0)
+                read.close();
+        });
+    }
+    
+    for (int i = 0; i < numParsers; ++i)
+    {
+        threads.emplace_back([&] {
+            ChordParser parser; // Building one is costly; one per thread
+            ScanItem item;
+            while (read.pop(item))
             {
-                result.databaseUpdated++;
+                parseScanItem(item, parser, options.writeMetadataToFiles);
+                if (!parsed.push(std::move(item)))
+                    break;
             }
+            if (--parsersLeft == 0)
+                parsed.close();
+        });
+    }
+    
+    // This thread is the single database writer
+    ScanItem item;
+    while (parsed.pop(item))
+    {
+        if (options.shouldCancel && options.shouldCancel())
+        {
+            result.cancelled = true;
+            found.cancel();
+            read.cancel();
+            parsed.cancel();
+            break;
         }
-        catch (const std::exception& e)
+        
+        bool ownsTransaction = database->beginTransaction();
+        int inBatch = 0;
+        do
         {
+            syncScanItem(item, *database, result);
+        }
+        while (++inBatch < options.batchSize && parsed.tryPop(item));
+        
+        if (ownsTransaction && !database->commitTransaction())
+        {
+            database->rollbackTransaction();
             result.errors++;
-            result.errorMessages.add("Error processing " + file.getFileName() + ": " + e.what());
+            result.errorMessages.add("Failed to commit a batch of " + juce::String(inBatch) + " files");
         }
+        
+        if (options.onProgress)
+            options.onProgress({ filesFound.load(), result.filesProcessed + filesUnchanged.load(), walkerDone.load() });
     }
     
+    for (auto& thread : threads)
+        thread.join();
+    
+    result.filesUnchanged = filesUnchanged.load();
+    result.filesProcessed += result.filesUnchanged;
+    if (!result.cancelled)
+        result.filesMissing = filesMissing.load();
+    
+    if (options.onProgress && !result.cancelled)
+        options.onProgress({ filesFound.load(), result.filesProcessed, true });
+    
     return result;
 }
 
+void MetadataService::readScanItem(ScanItem& item)
+{
+    if (!item.needsSync)
+        return;
+    
+    item.fileSize = item.file.getSize();
+    item.lastModified = item.file.getLastModificationTime();
+    readMetadataChunks(item.file, item.chunks, &item.format);
+}
+
+void MetadataService::parseScanItem(ScanItem& item, ChordParser& parser, bool writeMetadataToFiles)
+{
+    if (!item.needsSync)
+        return;
+    
+    try
+    {
+        item.hasMetadata = chunksToMetadata(item.chunks, item.metadata);
+        item.hadMetadata = item.hasMetadata;
+        
+        if (!item.hasMetadata && writeMetadataToFiles)
+        {
+            // Try to generate metadata from filename
+            auto parsedData = parser.parseFilename(item.file.getFileName());
+            
+            if (FilenameUtils::isValidParsedData(parsedData))
+            {
+                ChordMetadata newMetadata;
+                newMetadata.rootNote = parsedData.rootNote;
+                newMetadata.chordType = parsedData.standardizedQuality;
+                newMetadata.chordTypeDisplay = parsedData.getFullChordName();
+                newMetadata.extensions = parsedData.extensions;
+                newMetadata.alterations = parsedData.alterations;
+                newMetadata.addedNotes = parsedData.addedNotes;
+                newMetadata.suspensions = parsedData.suspensions;
+                newMetadata.bassNote = parsedData.determinedBassNote;
+                newMetadata.inversion = parsedData.inversionTextParsed;
+                newMetadata.originalFilename = item.file.getFileName();
+                newMetadata.dateAdded = juce::Time::getCurrentTime();
+                newMetadata.dateModified = item.lastModified;
+                
+                if (writeMetadataToFile(item.file, newMetadata))
+                {
+                    item.metadataWritten = true;
+                    item.hasMetadata = true;
+                    item.metadata = newMetadata;
+                    item.fileSize = item.file.getSize();
+                    item.lastModified = item.file.getLastModificationTime();
+                }
+            }
+        }
+        
+        // New rows get a content hash; this reads the audio, so it stays off the writer thread
+        if (item.hasMetadata && item.sampleId == 0)
+            item.contentHash = ContentHash::ofAudioData(item.file);
+    }
+    catch (const std::exception& e)
+    {
+        item.error = e.what();
+    }
+}
+
+void MetadataService::syncScanItem(ScanItem& item, ChopsDatabase& database, ScanResult& result)
+{
+    result.filesProcessed++;
+    auto filePath = item.file.getFullPathName();
+    
+    // Keep the row (and its ID, tags, collections) rather than delete + insert
+    if (item.movedFrom.isNotEmpty() && database.moveSampleFile(item.sampleId, filePath, item.stamp))
+        result.filesMoved++;
+    
+    if (!item.needsSync)
+        return;
+    
+    if (item.error.isNotEmpty())
+    {
+        result.errors++;
+        result.errorMessages.add("Error processing " + item.file.getFileName() + ": " + item.error);
+        return;
+    }
+    
+    if (item.hadMetadata)
+        result.filesWithMetadata++;
+    else
+        result.filesWithoutMetadata++;
+    if (item.metadataWritten)
+        result.metadataWritten++;
+    
+    std::unique_ptr<ChopsDatabase::SampleInfo> existingSample;
+    if (item.sampleId > 0)
+        existingSample = database.getSampleById(item.sampleId);
+    
+    bool synced = false;
+    int sampleId = existingSample ? existingSample->id : 0;
+    
+    // Same rules as syncFileWithDatabase, using what the earlier stages already read.
+    // Files without metadata aren't synced, but known ones are still stamped below.
+    if (item.hasMetadata && existingSample)
+    {
+        if (item.lastModified > existingSample->dateModified)
+        {
+            // File is newer - update database
+            auto updatedSample = item.metadata.toDatabaseSampleInfo(filePath, item.fileSize);
+            updatedSample.id = existingSample->id; // Preserve database ID
+            synced = database.updateSample(updatedSample);
+        }
+        else if (existingSample->dateModified > item.lastModified)
+        {
+            // Database is newer - update file
+            synced = writeMetadataToFile(item.file, ChordMetadata::fromDatabaseSampleInfo(*existingSample));
+        }
+        else
+        {
+            synced = true;
+        }
+    }
+    else if (item.hasMetadata)
+    {
+        auto sampleInfo = item.metadata.toDatabaseSampleInfo(filePath, item.fileSize);
+        sampleInfo.contentHash = item.contentHash;
+        applyAudioFormat(sampleInfo, item.format);
+        sampleId = database.insertSample(sampleInfo);
+        synced = sampleId > 0;
+    }
+    
+    // Known rows take the header as read, zeros included, so a file we can't probe isn't probed again
+    if (existingSample)
+        database.setAudioFormat(sampleId, item.format.durationMs, item.format.sampleRate,
+                                item.format.bitDepth, item.format.channels);
+    
+    if (synced)
+        result.databaseUpdated++;
+    
+    // Stamp after any write above, so our own changes don't look like edits next time
+    if (sampleId > 0 && (synced || !item.hasMetadata))
+        database.setFileStamp(sampleId, readFileStamp(item.file));
+}
+
 bool MetadataService::migrateFromFilenameToMetadata(const juce::File& audioFile, ChopsDatabase* database)
 {
     if (!audioFile.existsAsFile() || !database)
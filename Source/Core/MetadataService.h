@@ -2,6 +2,9 @@
 
 #include <JuceHeader.h>
 #include "../Database/ChopsDatabase.h"
+#include "ChordParser.h"
+#include "../Utils/AudioHeaderProbe.h"
+#include <functional>
 
 /**
  * MetadataService - Core service for reading/writing WAV file metadata
@@ -56,12 +59,18 @@ public:
     
     // Core metadata operations
     bool readMetadataFromFile(const juce::File& audioFile, ChordMetadata& metadata);
-    bool writeMetadataToFile(const juce::File& audioFile, const ChordMetadata& metadata);
+    // bytesWritten, if given, receives how much of the file was written (all of it for a rewrite)
+    bool writeMetadataToFile(const juce::File& audioFile, const ChordMetadata& metadata,
+                             juce::int64* bytesWritten = nullptr);
     bool hasMetadata(const juce::File& audioFile);
     
     // Database sync operations
     bool syncFileWithDatabase(const juce::File& audioFile, ChopsDatabase* database);
     bool updateFileMetadata(const juce::File& audioFile, const ChordMetadata& metadata, ChopsDatabase* database);
+    // Database to file only: writes the row's metadata into its file, then re-stamps the row so
+    // the next scan doesn't take our write for an outside edit
+    bool writeSampleToFile(const ChopsDatabase::SampleInfo& sample, ChopsDatabase* database,
+                           juce::int64* bytesWritten = nullptr);
     
     // Batch operations for library scanning
     struct ScanResult
@@ -73,10 +82,42 @@ public:
         int databaseUpdated = 0;
         int errors = 0;
         juce::StringArray errorMessages;
+        bool cancelled = false;
+        
+        // Incremental re-scans (see ChopsDatabase::FileStamp)
+        int filesUnchanged = 0;     // Skipped: same size, mtime and no database edit since the last sync
+        int filesMoved = 0;         // Renamed or moved on disk; matched by inode
+        int filesMissing = 0;       // In the database under this directory but not found; left alone
+    };
+    
+    struct ScanProgress
+    {
+        int filesFound = 0;         // Audio files enumerated so far
+        int filesProcessed = 0;     // Files skipped as unchanged or through the database stage
+        bool enumerationFinished = false;
+    };
+    
+    // The scan is a pipeline: one directory walker, N chunk readers and a parser pool
+    // feed a single database writer that commits in batches. Queues between stages
+    // are bounded, so a slow stage holds back the ones feeding it.
+    struct ScanOptions
+    {
+        bool recursive = true;
+        bool writeMetadataToFiles = true;
+        int numReaderThreads = 0;   // 0 picks a count from the number of CPUs
+        int numParserThreads = 0;
+        int queueCapacity = 256;    // Per stage
+        int batchSize = 256;        // Database writes per transaction
+        
+        // Both are called on the thread running the scan, which is also the database writer
+        std::function<void(const ScanProgress&)> onProgress;
+        std::function<bool()> shouldCancel;
     };
     
     ScanResult scanAndSyncDirectory(const juce::File& directory, ChopsDatabase* database, 
                                   bool recursive = true, bool writeMetadataToFiles = true);
+    ScanResult scanAndSyncDirectory(const juce::File& directory, ChopsDatabase* database,
+                                    const ScanOptions& options);
     
     // Migration helpers (for transitioning from current system)
     bool migrateFromFilenameToMetadata(const juce::File& audioFile, ChopsDatabase* database);
@@ -87,18 +128,53 @@ public:
     bool repairMetadata(const juce::File& audioFile, ChopsDatabase* database);
 
 private:
-    // iXML reading/writing implementation
-    bool readIXMLChunk(const juce::File& audioFile, juce::String& iXMLContent);
-    bool writeIXMLChunk(const juce::File& audioFile, const juce::String& iXMLContent);
+    // Metadata lives in two chunks written side by side: iXML for other tools and people,
+    // and a compact binary copy that is what we read back. The binary chunk records a
+    // hash of the iXML it was written with and is ignored if the iXML has changed since.
+    static constexpr const char* binaryChunkId = "CHPS";
+    static constexpr int binaryFormatVersion = 1;
+    
+    struct MetadataChunks
+    {
+        juce::MemoryBlock iXML;     // Trailing NULs stripped
+        juce::MemoryBlock binary;
+        bool hasIXML = false, hasBinary = false;
+    };
+    
+    // Reads both payloads in one walk over the chunk headers; also fills 'format' when given.
+    // Returns true if there's an iXML chunk.
+    bool readMetadataChunks(const juce::File& audioFile, MetadataChunks& chunks,
+                            AudioHeaderProbe::Info* format = nullptr);
+    bool chunksToMetadata(const MetadataChunks& chunks, ChordMetadata& metadata);
+    bool writeMetadataChunks(const juce::File& audioFile, const juce::String& iXMLContent,
+                             const ChordMetadata& metadata, juce::int64* bytesWritten = nullptr);
+    
+    // Updates are written over the old chunks and the JUNK padding reserved after them;
+    // only when that runs out is the file rewritten (to a temp file, then renamed)
+    static constexpr int iXMLReservedPadding = 2048;
+    static bool layoutMetadataChunks(const juce::MemoryBlock& iXML, const juce::MemoryBlock& binary,
+                                     juce::int64 regionSize, bool includeJunkPayload, juce::MemoryOutputStream& block);
+    bool writeChunksInPlace(const juce::File& audioFile, const juce::MemoryBlock& iXML, const juce::MemoryBlock& binary,
+                            juce::int64 regionStart, juce::int64 regionSize);
+    bool rewriteWithChunks(const juce::File& audioFile, const juce::MemoryBlock& iXML, const juce::MemoryBlock& binary);
     
     // Metadata serialization
     juce::String metadataToIXML(const ChordMetadata& metadata);
     bool iXMLToMetadata(const juce::String& iXMLContent, ChordMetadata& metadata);
+    juce::MemoryBlock metadataToBinary(const ChordMetadata& metadata, juce::uint64 iXMLHash);
+    bool binaryToMetadata(const juce::MemoryBlock& binary, juce::uint64 expectedIXMLHash, ChordMetadata& metadata);
+    static juce::uint64 hashOf(const juce::MemoryBlock& block);
     
     // Helper methods
     bool isAudioFile(const juce::File& file);
     juce::String sanitizeXMLString(const juce::String& input);
     juce::String escapeXMLAttribute(const juce::String& input);
     
+    // Scan pipeline stages; ScanItem is what moves between them
+    struct ScanItem;
+    void readScanItem(ScanItem& item);
+    void parseScanItem(ScanItem& item, ChordParser& parser, bool writeMetadataToFiles);
+    void syncScanItem(ScanItem& item, ChopsDatabase& database, ScanResult& result);
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetadataService)
 };
\ No newline at end of file
@@ -1,12 +1,140 @@
 #include "MetadataServiceTest.h"
+#include "../Utils/RiffChunkReader.h"
+#include "../Utils/ContentHash.h"
 #include <fstream>
 #include <iostream>
 #include <cmath>  // For M_PI and sin
+#include <string_view>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace
+{
+    // Little-endian RIFF bytes written out by hand, so a fixture is exactly what it says
+    struct RiffBytes
+    {
+        juce::MemoryOutputStream out;
+        
+        RiffBytes& id(const char* fourCC)               { out.write(fourCC, 4); return *this; }
+        RiffBytes& u32(juce::uint32 value)              { out.writeInt((int) value); return *this; }
+        RiffBytes& u64(juce::uint64 value)              { out.writeInt64((juce::int64) value); return *this; }
+        RiffBytes& fill(int numBytes, int value = 0)    { out.writeRepeatedByte((juce::uint8) value, (size_t) numBytes); return *this; }
+        
+        // 'fmt ' for mono 16-bit PCM at 44.1 kHz
+        RiffBytes& pcmFormat()
+        {
+            id("fmt ").u32(16);
+            out.writeShort(1);
+            out.writeShort(1);
+            u32(44100).u32(88200);
+            out.writeShort(2);
+            out.writeShort(16);
+            return *this;
+        }
+        
+        // A ramp, so moved or clipped audio changes the content hash
+        RiffBytes& audio(int numBytes)
+        {
+            for (int i = 0; i < numBytes; ++i)
+                out.writeByte((char) (i * 37));
+            return *this;
+        }
+        
+        juce::MemoryBlock getBlock() const              { return out.getMemoryBlock(); }
+    };
+    
+    bool writeFixture(const juce::File& file, const RiffBytes& bytes)
+    {
+        auto block = bytes.getBlock();
+        return file.replaceWithData(block.getData(), block.getSize());
+    }
+    
+    // The 32-bit RIFF size, or the 64-bit one from 'ds64' for RF64
+    juce::int64 readRiffSize(const juce::File& file)
+    {
+        juce::FileInputStream stream(file);
+        RiffChunkReader reader(stream);
+        if (!reader.isValid())
+            return -1;
+        if (!reader.isRF64())
+            return stream.setPosition(4) ? (juce::int64) (juce::uint32) stream.readInt() : -1;
+        
+        RiffChunkReader::Chunk ds64;
+        return reader.findChunk("ds64", ds64) && stream.setPosition(ds64.dataOffset) ? stream.readInt64() : -1;
+    }
+    
+    // "id@headerOffset:size" for every chunk the reader steps through
+    juce::String describeChunks(RiffChunkReader& reader)
+    {
+        juce::StringArray chunks;
+        RiffChunkReader::Chunk chunk;
+        while (reader.next(chunk))
+            chunks.add(juce::String(chunk.id, 4) + "@" + juce::String(chunk.headerOffset) + ":" + juce::String(chunk.size));
+        return chunks.joinIntoString(" ");
+    }
+    
+    // File offset of a chunk's ID, or -1 if the file has no such chunk
+    juce::int64 findChunkHeader(const juce::File& file, const char* chunkId, juce::int64* dataOffset = nullptr)
+    {
+        juce::FileInputStream stream(file);
+        RiffChunkReader reader(stream);
+        RiffChunkReader::Chunk chunk;
+        if (!reader.isValid() || !reader.findChunk(chunkId, chunk))
+            return -1;
+        if (dataOffset != nullptr)
+            *dataOffset = chunk.dataOffset;
+        return chunk.headerOffset;
+    }
+    
+    // File offset of the first occurrence of 'text' in a chunk's payload, or -1
+    juce::int64 findInChunk(const juce::File& file, const char* chunkId, const juce::String& text)
+    {
+        juce::FileInputStream stream(file);
+        RiffChunkReader reader(stream);
+        RiffChunkReader::Chunk chunk;
+        juce::MemoryBlock payload;
+        if (!reader.isValid() || !reader.findChunk(chunkId, chunk) || !reader.readPayload(chunk, payload))
+            return -1;
+        
+        std::string_view haystack(static_cast<const char*>(payload.getData()), payload.getSize());
+        auto position = haystack.find(text.toStdString());
+        return position != std::string_view::npos ? chunk.dataOffset + (juce::int64) position : -1;
+    }
+    
+    // Edits bytes in place, as another tool might
+    bool overwriteBytes(const juce::File& file, juce::int64 offset, const void* data, size_t numBytes)
+    {
+        if (offset < 0)
+            return false;
+        
+        juce::FileOutputStream out(file);
+        if (!out.openedOk() || !out.setPosition(offset) || !out.write(data, numBytes))
+            return false;
+        out.flush();
+        return out.getStatus().wasOk();
+    }
+    
+    bool overwriteText(const juce::File& file, juce::int64 offset, const juce::String& text)
+    {
+        return overwriteBytes(file, offset, text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+    
+    // Every field either chunk carries, so the two decoders can be compared exactly
+    juce::String describeAllFields(const MetadataService::ChordMetadata& m)
+    {
+        juce::StringArray fields { m.rootNote, m.chordType, m.chordTypeDisplay, m.bassNote, m.inversion,
+                                   m.extensions.joinIntoString(","), m.alterations.joinIntoString(","),
+                                   m.addedNotes.joinIntoString(","), m.suspensions.joinIntoString(","),
+                                   m.tags.joinIntoString(","), juce::String(m.rating), m.isFavorite ? "favourite" : "-",
+                                   m.userNotes, m.color.toDisplayString(true), juce::String(m.playCount),
+                                   m.originalFilename, juce::String(m.dateAdded.toMilliseconds()),
+                                   juce::String(m.dateModified.toMilliseconds()), juce::String(m.lastPlayed.toMilliseconds()) };
+        return fields.joinIntoString(" | ");
+    }
+}
+
 //==============================================================================
 MetadataServiceTest::MetadataServiceTest()
 {
@@ -65,6 +193,21 @@ bool MetadataServiceTest::runAllTests(const juce::File& testDirectory)
     juce::Logger::writeToLog("\n=== RUNNING WAV FILE VALIDATION TEST ===");
     results.push_back(testWavFileValidation(testDirectory));
     
+    juce::Logger::writeToLog("\n=== RUNNING RIFF CHUNK READER FIXTURE TEST ===");
+    results.push_back(testRiffChunkReaderFixtures());
+    
+    juce::Logger::writeToLog("\n=== RUNNING CHUNK WRITE TESTS ===");
+    results.push_back(testInPlaceUpdateWithinPadding(testDirectory));
+    results.push_back(testRewriteWhenPaddingExhausted(testDirectory));
+    results.push_back(testOddSizedIXML(testDirectory));
+    results.push_back(testDamagedChunkNotRewritten(testDirectory));
+    results.push_back(testRF64SizeFixup(testDirectory));
+    
+    juce::Logger::writeToLog("\n=== RUNNING BINARY CHUNK TESTS ===");
+    results.push_back(testBinaryAndIXMLAgree(testDirectory));
+    results.push_back(testStaleBinaryFallsBackToIXML(testDirectory));
+    results.push_back(testUnknownBinaryVersionIgnored(testDirectory));
+    
     // Report results
     juce::Logger::writeToLog("\n=== TEST RESULTS SUMMARY ===");
     for (const auto& result : results)
@@ -637,6 +780,466 @@ MetadataServiceTest::TestResult MetadataServiceTest::testWavFileValidation(const
     return result;
 }
 
+MetadataServiceTest::TestResult MetadataServiceTest::testRiffChunkReaderFixtures()
+{
+    TestResult result;
+    result.message = "RiffChunkReader byte-level fixtures";
+    
+    juce::Logger::writeToLog("📝 Walking hand-built RIFF/RF64 files...");
+    
+    struct Fixture
+    {
+        const char* name;
+        juce::MemoryBlock bytes;
+        bool expectRF64;
+        juce::String expectedChunks;
+    };
+    
+    std::vector<Fixture> fixtures;
+    
+    // An odd-sized chunk followed by its pad byte: the next header starts after the pad
+    fixtures.push_back({ "odd chunk, padded",
+        RiffBytes().id("RIFF").u32(4 + 12 + 12).id("WAVE")
+                   .id("abcd").u32(3).fill(3, 'x').fill(1)
+                   .id("data").u32(4).fill(4).getBlock(),
+        false, "abcd@12:3 data@24:4" });
+    
+    // The same, from a writer that left the pad byte out
+    fixtures.push_back({ "odd chunk, unpadded",
+        RiffBytes().id("RIFF").u32(4 + 11 + 12).id("WAVE")
+                   .id("abcd").u32(3).fill(3, 'x')
+                   .id("data").u32(4).fill(4).getBlock(),
+        false, "abcd@12:3 data@23:4" });
+    
+    // RF64: the 32-bit sizes are 0xFFFFFFFF and the real ones are in 'ds64'
+    fixtures.push_back({ "RF64 header",
+        RiffBytes().id("RF64").u32(0xffffffff).id("WAVE")
+                   .id("ds64").u32(28).u64(4 + 36 + 24 + 18).u64(10).u64(5).u32(0)
+                   .id("fmt ").u32(16).fill(16)
+                   .id("data").u32(0xffffffff).fill(10).getBlock(),
+        true, "ds64@12:28 fmt @48:16 data@72:10" });
+    
+    // The last chunk claims more than the file holds: it is cut to what's there
+    fixtures.push_back({ "truncated last chunk",
+        RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE")
+                   .id("fmt ").u32(16).fill(16)
+                   .id("data").u32(1000).fill(10, 0x55).getBlock(),
+        false, "fmt @12:16 data@36:10" });
+    
+    juce::StringArray failures;
+    for (auto& fixture : fixtures)
+    {
+        juce::MemoryInputStream stream(fixture.bytes, false);
+        RiffChunkReader reader(stream);
+        auto chunks = describeChunks(reader);
+        
+        if (!reader.isValid() || reader.isRF64() != fixture.expectRF64 || chunks != fixture.expectedChunks)
+        {
+            failures.add(juce::String(fixture.name) + ": expected [" + fixture.expectedChunks + "], got ["
+                         + chunks + "]" + (reader.isRF64() != fixture.expectRF64 ? " (RF64 flag wrong)" : ""));
+            juce::Logger::writeToLog("   ❌ " + failures[failures.size() - 1]);
+        }
+        else
+        {
+            juce::Logger::writeToLog("   ✅ " + juce::String(fixture.name) + ": " + chunks);
+        }
+    }
+    
+    // Reading the truncated chunk gives the bytes that exist, not the size it claimed
+    {
+        juce::MemoryInputStream stream(fixtures.back().bytes, false);
+        RiffChunkReader reader(stream);
+        RiffChunkReader::Chunk data;
+        juce::MemoryBlock payload;
+        if (!reader.findChunk("data", data) || !reader.readPayload(data, payload) || payload.getSize() != 10
+            || static_cast<const juce::uint8*>(payload.getData())[9] != 0x55)
+        {
+            failures.add("truncated last chunk: payload is not the 10 bytes present");
+            juce::Logger::writeToLog("   ❌ " + failures[failures.size() - 1]);
+        }
+    }
+    
+    result.success = failures.isEmpty();
+    result.details = result.success ? juce::String(fixtures.size()) + " fixtures walked as expected"
+                                    : failures.joinIntoString("; ");
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testInPlaceUpdateWithinPadding(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "In-place update within the JUNK padding";
+    
+    auto file = testDirectory.getChildFile("in_place_test.wav");
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE").pcmFormat().id("data").u32(1000).audio(1000)))
+    {
+        result.details = "Could not write fixture";
+        return result;
+    }
+    
+    // The first write adds the chunks and reserves padding after them
+    auto metadata = createTestMetadata();
+    if (!metadataService.writeMetadataToFile(file, metadata))
+    {
+        result.details = "First write failed";
+        return result;
+    }
+    
+    auto sizeBefore = file.getSize();
+    auto audioBefore = ContentHash::ofAudioData(file);
+    
+    metadata.userNotes += " - now a few hundred bytes longer, which the padding has room for. ";
+    metadata.userNotes += metadata.userNotes;
+    metadata.tags.add("updated");
+    
+    juce::int64 bytesWritten = 0;
+    MetadataService::ChordMetadata readBack;
+    juce::String differences;
+    if (!metadataService.writeMetadataToFile(file, metadata, &bytesWritten))
+        result.details = "Update failed";
+    else if (bytesWritten >= sizeBefore)
+        result.details = "Update rewrote the file (" + juce::String(bytesWritten) + " bytes) instead of writing in place";
+    else if (file.getSize() != sizeBefore)
+        result.details = "File size changed: " + juce::String(sizeBefore) + " -> " + juce::String(file.getSize());
+    else if (ContentHash::ofAudioData(file) != audioBefore)
+        result.details = "Audio bytes changed";
+    else if (!metadataService.readMetadataFromFile(file, readBack) || !compareMetadata(metadata, readBack, differences))
+        result.details = "Read back differs: " + differences;
+    else
+    {
+        result.success = true;
+        result.details = juce::String(bytesWritten) + " of " + juce::String(sizeBefore) + " bytes written";
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testRewriteWhenPaddingExhausted(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "Temp-file rewrite once the padding is used up";
+    
+    auto file = testDirectory.getChildFile("rewrite_test.wav");
+    auto metadata = createTestMetadata();
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE").pcmFormat().id("data").u32(1000).audio(1000))
+        || !metadataService.writeMetadataToFile(file, metadata))
+    {
+        result.details = "Could not set up the fixture";
+        return result;
+    }
+    
+    auto sizeBefore = file.getSize();
+    auto audioBefore = ContentHash::ofAudioData(file);
+    
+    // Well past the 2 KB reserved after the chunks
+    metadata.userNotes = juce::String::repeatedString("Too long to fit. ", 400);
+    
+    juce::int64 bytesWritten = 0;
+    MetadataService::ChordMetadata readBack;
+    juce::String differences;
+    auto tempFile = file.getSiblingFile("." + file.getFileName() + ".chops-tmp");
+    if (!metadataService.writeMetadataToFile(file, metadata, &bytesWritten))
+        result.details = "Write failed";
+    else if (bytesWritten != file.getSize() || file.getSize() <= sizeBefore)
+        result.details = "Expected a whole-file rewrite, wrote " + juce::String(bytesWritten) + " bytes";
+    else if (readRiffSize(file) != file.getSize() - 8)
+        result.details = "RIFF size " + juce::String(readRiffSize(file)) + " for a file of " + juce::String(file.getSize());
+    else if (ContentHash::ofAudioData(file) != audioBefore)
+        result.details = "Audio bytes changed";
+    else if (tempFile.exists())
+        result.details = "Temp file left behind";
+    else if (!metadataService.readMetadataFromFile(file, readBack) || !compareMetadata(metadata, readBack, differences))
+        result.details = "Read back differs: " + differences;
+    else
+    {
+        result.success = true;
+        result.details = "File grew from " + juce::String(sizeBefore) + " to " + juce::String(file.getSize()) + " bytes";
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testOddSizedIXML(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "Odd-sized iXML chunk";
+    
+    auto file = testDirectory.getChildFile("odd_ixml_test.wav");
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE").pcmFormat().id("data").u32(1000).audio(1000)))
+    {
+        result.details = "Could not write fixture";
+        return result;
+    }
+    
+    // One more character at a time until the iXML comes out odd; both writes must read back
+    auto metadata = createTestMetadata();
+    for (int attempt = 0; attempt < 2 && !result.success; ++attempt)
+    {
+        metadata.userNotes += "x";
+        MetadataService::ChordMetadata readBack;
+        juce::String differences;
+        if (!metadataService.writeMetadataToFile(file, metadata)
+            || !metadataService.readMetadataFromFile(file, readBack) || !compareMetadata(metadata, readBack, differences))
+        {
+            result.details = "Write/read failed with " + juce::String(metadata.userNotes.length()) + " characters of notes: " + differences;
+            break;
+        }
+        
+        juce::FileInputStream stream(file);
+        RiffChunkReader reader(stream);
+        RiffChunkReader::Chunk iXML, following;
+        if (!reader.findChunk("iXML", iXML) || !reader.next(following))
+        {
+            result.details = "iXML chunk or the chunk after it is missing";
+            break;
+        }
+        if ((iXML.size & 1) == 0)
+            continue;
+        
+        // The pad byte has to be there, so writers that expect it find the next header
+        if (following.headerOffset != iXML.getEnd() + 1)
+            result.details = "Chunk after the " + juce::String(iXML.size) + "-byte iXML is at "
+                           + juce::String(following.headerOffset) + ", expected " + juce::String(iXML.getEnd() + 1);
+        else if (readRiffSize(file) != file.getSize() - 8)
+            result.details = "RIFF size doesn't cover the pad byte";
+        else
+        {
+            result.success = true;
+            result.details = juce::String(iXML.size) + "-byte iXML padded and read back";
+        }
+    }
+    
+    if (!result.success && result.details.isEmpty())
+        result.details = "Never produced an odd-sized iXML chunk";
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testDamagedChunkNotRewritten(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "Refuses to rewrite a file with a damaged chunk";
+    
+    // After 'data', bytes that aren't a chunk header: a rewrite would drop whatever they are
+    auto file = testDirectory.getChildFile("damaged_chunk_test.wav");
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000 + 32).id("WAVE").pcmFormat()
+                                       .id("data").u32(1000).audio(1000).fill(32, 0x01)))
+    {
+        result.details = "Could not write fixture";
+        return result;
+    }
+    
+    juce::MemoryBlock before;
+    file.loadFileAsData(before);
+    
+    juce::MemoryBlock after;
+    bool written = metadataService.writeMetadataToFile(file, createTestMetadata());
+    file.loadFileAsData(after);
+    
+    if (written)
+        result.details = "Write succeeded on a damaged file";
+    else if (after != before)
+        result.details = "File was modified (" + juce::String((int) before.getSize()) + " -> " + juce::String((int) after.getSize()) + " bytes)";
+    else if (file.getSiblingFile("." + file.getFileName() + ".chops-tmp").exists())
+        result.details = "Temp file left behind";
+    else
+    {
+        result.success = true;
+        result.details = "Write refused, file untouched";
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testRF64SizeFixup(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "RF64 size fix-up through ds64";
+    
+    // The 32-bit sizes are 0xFFFFFFFF; the rewrite must update the 64-bit RIFF size in 'ds64'
+    auto file = testDirectory.getChildFile("rf64_test.wav");
+    if (!writeFixture(file, RiffBytes().id("RF64").u32(0xffffffff).id("WAVE")
+                                       .id("ds64").u32(28).u64(4 + 36 + 24 + 8 + 1000).u64(1000).u64(500).u32(0)
+                                       .pcmFormat().id("data").u32(0xffffffff).audio(1000)))
+    {
+        result.details = "Could not write fixture";
+        return result;
+    }
+    
+    auto audioBefore = ContentHash::ofAudioData(file);
+    auto metadata = createTestMetadata();
+    MetadataService::ChordMetadata readBack;
+    juce::String differences;
+    
+    if (!metadataService.writeMetadataToFile(file, metadata))
+    {
+        result.details = "Write failed";
+    }
+    else
+    {
+        juce::FileInputStream input(file);
+        RiffChunkReader reader(input);
+        RiffChunkReader::Chunk data;
+        bool hasData = reader.findChunk("data", data);
+        
+        if (!reader.isRF64())
+            result.details = "No longer an RF64 file";
+        else if (readRiffSize(file) != file.getSize() - 8)
+            result.details = "ds64 RIFF size " + juce::String(readRiffSize(file)) + " for a file of " + juce::String(file.getSize());
+        else if (!hasData || data.size != 1000)
+            result.details = "data chunk lost its size";
+        else if (ContentHash::ofAudioData(file) != audioBefore)
+            result.details = "Audio bytes changed";
+        else if (!metadataService.readMetadataFromFile(file, readBack) || !compareMetadata(metadata, readBack, differences))
+            result.details = "Read back differs: " + differences;
+        else
+        {
+            result.success = true;
+            result.details = "ds64 RIFF size updated to " + juce::String(readRiffSize(file));
+        }
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testBinaryAndIXMLAgree(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "Binary chunk and iXML decode to the same metadata";
+    
+    auto file = testDirectory.getChildFile("binary_ixml_test.wav");
+    auto metadata = createComplexTestMetadata();
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE").pcmFormat().id("data").u32(1000).audio(1000)) || !metadataService.writeMetadataToFile(file, metadata))
+    {
+        result.details = "Could not set up the fixture";
+        return result;
+    }
+    
+    // Read once with the binary chunk, then again with it renamed out of the way
+    MetadataService::ChordMetadata fromBinary, fromIXML;
+    auto binaryHeader = findChunkHeader(file, "CHPS");
+    bool readBinary = metadataService.readMetadataFromFile(file, fromBinary);
+    
+    if (binaryHeader < 0)
+        result.details = "No binary chunk was written";
+    else if (!readBinary)
+        result.details = "Read with the binary chunk failed";
+    else if (!overwriteText(file, binaryHeader, "JUNK") || findChunkHeader(file, "CHPS") >= 0)
+        result.details = "Could not hide the binary chunk";
+    else if (!metadataService.readMetadataFromFile(file, fromIXML))
+        result.details = "Read from the iXML alone failed";
+    else if (describeAllFields(fromBinary) != describeAllFields(metadata))
+        result.details = "Binary read back differs:\n   wrote " + describeAllFields(metadata) + "\n   read  " + describeAllFields(fromBinary);
+    else if (describeAllFields(fromIXML) != describeAllFields(fromBinary))
+        result.details = "iXML and binary disagree:\n   iXML   " + describeAllFields(fromIXML) + "\n   binary " + describeAllFields(fromBinary);
+    else
+    {
+        result.success = true;
+        result.details = "Both chunks read back every field";
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testStaleBinaryFallsBackToIXML(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "Binary chunk ignored once the iXML has been edited";
+    
+    auto file = testDirectory.getChildFile("stale_binary_test.wav");
+    auto metadata = createTestMetadata();
+    metadata.userNotes = "Written by Chops";
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE").pcmFormat().id("data").u32(1000).audio(1000)) || !metadataService.writeMetadataToFile(file, metadata))
+    {
+        result.details = "Could not set up the fixture";
+        return result;
+    }
+    
+    // Another tool edits the XML; the binary copy still holds the old notes and the old hash
+    MetadataService::ChordMetadata readBack;
+    juce::String differences;
+    auto expected = metadata;
+    expected.userNotes = "Written by Other";
+    
+    if (!overwriteText(file, findInChunk(file, "iXML", "Chops"), "Other"))
+        result.details = "Could not edit the iXML";
+    else if (findInChunk(file, "CHPS", "Chops") < 0)
+        result.details = "Binary chunk doesn't hold the original notes";
+    else if (!metadataService.readMetadataFromFile(file, readBack))
+        result.details = "Read failed";
+    else if (!compareMetadata(expected, readBack, differences))
+        result.details = "Stale binary chunk was used: " + differences;
+    else
+    {
+        result.success = true;
+        result.details = "Hash mismatch detected, iXML edit read back";
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
+MetadataServiceTest::TestResult MetadataServiceTest::testUnknownBinaryVersionIgnored(const juce::File& testDirectory)
+{
+    TestResult result;
+    result.message = "Binary chunk with an unknown version ignored";
+    
+    auto file = testDirectory.getChildFile("binary_version_test.wav");
+    auto metadata = createTestMetadata();
+    metadata.userNotes = "Written by Chops";
+    if (!writeFixture(file, RiffBytes().id("RIFF").u32(4 + 24 + 8 + 1000).id("WAVE").pcmFormat().id("data").u32(1000).audio(1000)) || !metadataService.writeMetadataToFile(file, metadata))
+    {
+        result.details = "Could not set up the fixture";
+        return result;
+    }
+    
+    // Make the binary copy distinguishable from the iXML without touching the hash it records
+    juce::int64 binaryData = -1;
+    if (findChunkHeader(file, "CHPS", &binaryData) < 0 || !overwriteText(file, findInChunk(file, "CHPS", "Chops"), "Other"))
+    {
+        result.details = "Could not edit the binary chunk";
+        file.deleteFile();
+        return result;
+    }
+    
+    auto readNotes = [this, &file]() {
+        MetadataService::ChordMetadata readBack;
+        return metadataService.readMetadataFromFile(file, readBack) ? readBack.userNotes : juce::String("<read failed>");
+    };
+    auto setVersion = [&file, binaryData](juce::uint16 version) {
+        const char bytes[] = { (char) (version & 0xff), (char) (version >> 8) };
+        return overwriteBytes(file, binaryData, bytes, sizeof(bytes));
+    };
+    
+    // Fields are only appended, so a newer writer's chunk is still read; version 0 was never written
+    auto current = readNotes();
+    bool newerPatched = setVersion(2);
+    auto newer = readNotes();
+    bool unknownPatched = setVersion(0);
+    auto unknown = readNotes();
+    
+    if (current != "Written by Other")
+        result.details = "Binary chunk not preferred over the iXML (read '" + current + "')";
+    else if (!newerPatched || newer != "Written by Other")
+        result.details = "Chunk from a newer version not read (read '" + newer + "')";
+    else if (!unknownPatched || unknown != "Written by Chops")
+        result.details = "Version 0 chunk was used instead of the iXML (read '" + unknown + "')";
+    else
+    {
+        result.success = true;
+        result.details = "Version 0 fell back to the iXML";
+    }
+    
+    file.deleteFile();
+    return result;
+}
+
 //==============================================================================
 // Helper Methods (Enhanced)
 //==============================================================================
@@ -783,7 +1386,7 @@ juce::File MetadataServiceTest::createTestWavFileDetailed(const juce::File& dire
         juce::Logger::writeToLog("   Sample rate: " + juce::String(sampleRate) + " Hz");
         juce::Logger::writeToLog("   Channels: " + juce::String(numChannels));
         juce::Logger::writeToLog("   Bit depth: " + juce::String(bitsPerSample) + " bits");
-        juce::Logger::writeToLog("   Duration: " + juce::String(numSamples / sampleRate, 2) + " seconds");
+        juce::Logger::writeToLog("   Duration: " + juce::String((double) numSamples / sampleRate, 2) + " seconds");
         juce::Logger::writeToLog("   Data size: " + juce::String(dataSize) + " bytes");
         juce::Logger::writeToLog("   Total file size: " + juce::String(fileSize + 8) + " bytes");
         
@@ -33,15 +33,28 @@ public:
     // Run all tests
     bool runAllTests(const juce::File& testDirectory);
     
-    // Individual tests
-    TestResult testBasicMetadataWriteRead();
-    TestResult testComplexMetadataWriteRead();
-    TestResult testFileWithoutMetadata();
-    TestResult testInvalidFile();
-    TestResult testMetadataUpdate();
+    // Individual tests; existingWavFile may be empty, in which case one is generated
+    TestResult testBasicMetadataWriteReadDetailed(const juce::File& testDirectory, const juce::File& existingWavFile);
+    TestResult testComplexMetadataWriteReadDetailed(const juce::File& testDirectory, const juce::File& existingWavFile);
+    TestResult testFileWithoutMetadataDetailed(const juce::File& testDirectory);
+    TestResult testInvalidFileDetailed(const juce::File& testDirectory);
+    TestResult testMetadataUpdateDetailed(const juce::File& testDirectory, const juce::File& existingWavFile);
+    TestResult testWavFileValidation(const juce::File& testDirectory);
     
-    // Test with actual WAV file
-    TestResult testWithRealWavFile(const juce::File& wavFile);
+    // Byte-level fixtures, built in memory
+    TestResult testRiffChunkReaderFixtures();
+    
+    // The write path: in-place updates, rewrites and the files they must refuse
+    TestResult testInPlaceUpdateWithinPadding(const juce::File& testDirectory);
+    TestResult testRewriteWhenPaddingExhausted(const juce::File& testDirectory);
+    TestResult testOddSizedIXML(const juce::File& testDirectory);
+    TestResult testDamagedChunkNotRewritten(const juce::File& testDirectory);
+    TestResult testRF64SizeFixup(const juce::File& testDirectory);
+    
+    // The binary chunk against the iXML written beside it
+    TestResult testBinaryAndIXMLAgree(const juce::File& testDirectory);
+    TestResult testStaleBinaryFallsBackToIXML(const juce::File& testDirectory);
+    TestResult testUnknownBinaryVersionIgnored(const juce::File& testDirectory);
     
     // Create a test WAV file
     static juce::File createTestWavFile(const juce::File& directory, const juce::String& filename);
@@ -50,6 +63,12 @@ private:
     MetadataService metadataService;
     
     // Helper methods
+    static juce::File findExistingWavFile();
+    static bool validateWavFileStructure(const juce::File& wavFile);
+    static juce::File createTestWavFileDetailed(const juce::File& directory, const juce::String& filename);
+    static bool compareMetadataDetailed(const MetadataService::ChordMetadata& expected,
+                                        const MetadataService::ChordMetadata& actual,
+                                        juce::String& differences);
     MetadataService::ChordMetadata createTestMetadata();
     MetadataService::ChordMetadata createComplexTestMetadata();
     bool compareMetadata(const MetadataService::ChordMetadata& expected, 
@@ -0,0 +1,254 @@
+#include "MetadataWriteBehind.h"
+
+MetadataWriteBehind::MetadataWriteBehind(DatabaseSyncManager& managerToWatch)
+    : juce::Thread("ChopsMetadataWriteBehind"), manager(managerToWatch)
+{
+    manager.addListener(this);
+}
+
+MetadataWriteBehind::~MetadataWriteBehind()
+{
+    manager.removeListener(this);
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+
+    // Files eventually carry the truth: whatever fits goes out now, the next scan does the rest
+    if (!flush(shutdownFlushMs))
+        juce::Logger::writeToLog("MetadataWriteBehind: Left " + juce::String(getStats().pending)
+                                 + " files for the next scan");
+
+    const juce::ScopedLock fl(flushLock);
+    database.close();
+}
+
+//==============================================================================
+void MetadataWriteBehind::setSettings(const Settings& newSettings)
+{
+    const juce::ScopedLock sl(lock);
+    settings = newSettings;
+}
+
+MetadataWriteBehind::Stats MetadataWriteBehind::getStats() const
+{
+    const juce::ScopedLock sl(lock);
+    auto current = stats;
+    current.pending = (int) pending.size();
+    return current;
+}
+
+void MetadataWriteBehind::noteActivity()
+{
+    lastActivity = juce::Time::getMillisecondCounterHiRes();
+}
+
+void MetadataWriteBehind::sampleMetadataChanged(int sampleId)
+{
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    lastActivity = now;
+    {
+        const juce::ScopedLock sl(lock);
+        auto& entry = pending[sampleId];
+        if (entry.firstEditMs == 0.0)
+            entry.firstEditMs = now;
+        entry.lastEditMs = now;
+        ++stats.editsQueued;
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+    notify();
+}
+
+bool MetadataWriteBehind::flush(int timeoutMs)
+{
+    auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+    std::vector<std::pair<int, Pending>> tooLarge; // Kept out of the queue until the end, or they'd come round again
+    bool ok = true;
+    for (;;)
+    {
+        auto due = takeDueSamples(true);
+        if (due.empty())
+            break;
+
+        if (!writeSamples(due, false, deadline, &tooLarge))
+        {
+            ok = false;
+            break;
+        }
+
+        if (juce::Time::getMillisecondCounterHiRes() >= deadline)
+            break;
+    }
+
+    requeue(tooLarge, 0);
+    return ok && getStats().pending == 0;
+}
+
+//==============================================================================
+void MetadataWriteBehind::run()
+{
+    while (!threadShouldExit())
+    {
+        auto due = takeDueSamples(false);
+        if (!due.empty())
+        {
+            if (!writeSamples(due, true))
+                wait(1000);
+            continue;
+        }
+
+        // Sleep until the earliest sample could be due; new edits wake us through notify()
+        int timeoutMs = -1;
+        {
+            const juce::ScopedLock sl(lock);
+            auto now = juce::Time::getMillisecondCounterHiRes();
+            auto idleAt = lastActivity.load() + settings.idleDelayMs;
+            for (auto& [sampleId, entry] : pending)
+            {
+                auto dueAt = juce::jmin(entry.firstEditMs + settings.maxDelayMs,
+                                        juce::jmax(entry.lastEditMs + settings.coalesceMs, idleAt));
+                auto untilDue = juce::jlimit(1, 1000, (int) (dueAt - now) + 1);
+                timeoutMs = timeoutMs < 0 ? untilDue : juce::jmin(timeoutMs, untilDue);
+            }
+        }
+        wait(timeoutMs);
+    }
+}
+
+std::vector<std::pair<int, MetadataWriteBehind::Pending>> MetadataWriteBehind::takeDueSamples(bool ignoreIdle)
+{
+    std::vector<std::pair<int, Pending>> due;
+    const juce::ScopedLock sl(lock);
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    bool idle = now - lastActivity.load() >= settings.idleDelayMs;
+
+    for (auto it = pending.begin(); it != pending.end() && (int) due.size() < settings.maxFilesPerBatch;)
+    {
+        auto& entry = it->second;
+        bool settled = now - entry.lastEditMs >= settings.coalesceMs;
+        bool overdue = now - entry.firstEditMs >= settings.maxDelayMs;
+        if (ignoreIdle || overdue || (settled && idle))
+        {
+            due.emplace_back(*it);
+            it = pending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return due;
+}
+
+void MetadataWriteBehind::requeue(const std::vector<std::pair<int, Pending>>& samples, size_t from)
+{
+    const juce::ScopedLock sl(lock);
+    for (auto i = from; i < samples.size(); ++i)
+    {
+        // Keep the original first edit, so requeued samples still become overdue on time
+        auto& [sampleId, entry] = samples[i];
+        auto inserted = pending.emplace(sampleId, entry);
+        if (!inserted.second)
+            inserted.first->second.firstEditMs = juce::jmin(inserted.first->second.firstEditMs, entry.firstEditMs);
+    }
+}
+
+bool MetadataWriteBehind::writeSamples(const std::vector<std::pair<int, Pending>>& samples, bool throttled,
+                                       double deadlineMs, std::vector<std::pair<int, Pending>>* tooLarge)
+{
+    const juce::ScopedLock fl(flushLock);
+    if (!ensureConnection())
+    {
+        // Not initialised yet (or the file went away); try again later
+        requeue(samples, 0);
+        return false;
+    }
+
+    Settings current;
+    {
+        const juce::ScopedLock sl(lock);
+        current = settings;
+    }
+
+    auto batchStartedAfter = lastActivity.load();
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        auto now = juce::Time::getMillisecondCounterHiRes();
+        bool overdue = now - samples[i].second.firstEditMs >= current.maxDelayMs;
+        if (throttled && (threadShouldExit() || (lastActivity.load() != batchStartedAfter && !overdue)))
+        {
+            requeue(samples, i);
+            return true;
+        }
+
+        if (deadlineMs > 0.0 && now >= deadlineMs)
+        {
+            requeue(samples, i);
+            return true;
+        }
+
+        // The row as it is now, so edits made since it was queued go out too
+        auto sample = database.getSampleById(samples[i].first);
+        if (sample == nullptr)
+            continue; // Deleted since
+
+        // A rewrite can copy the whole file, which can't be cut short once started
+        if (deadlineMs > 0.0 && tooLarge != nullptr
+            && now + (double) juce::File(sample->filePath).getSize() * 1000.0 / (double) rewriteBytesPerSecond >= deadlineMs)
+        {
+            tooLarge->push_back(samples[i]);
+            continue;
+        }
+
+        juce::int64 bytesWritten = 0;
+        bool ok = metadataService.writeSampleToFile(*sample, &database, &bytesWritten);
+        {
+            const juce::ScopedLock sl(lock);
+            if (ok)
+            {
+                ++stats.filesWritten;
+                stats.bytesWritten += bytesWritten;
+            }
+            else
+            {
+                // Missing or unwritable files aren't retried; the next scan reconciles them
+                ++stats.failures;
+                juce::Logger::writeToLog("MetadataWriteBehind: Could not write " + sample->filePath);
+            }
+        }
+
+        // Pace the I/O: a rewrite of a large file buys a correspondingly long pause
+        if (throttled && current.maxBytesPerSecond > 0 && bytesWritten > 0)
+        {
+            auto pauseUntil = juce::Time::getMillisecondCounterHiRes()
+                            + (double) bytesWritten * 1000.0 / (double) current.maxBytesPerSecond;
+            for (auto left = pauseUntil - juce::Time::getMillisecondCounterHiRes(); left > 0 && !threadShouldExit();
+                 left = pauseUntil - juce::Time::getMillisecondCounterHiRes())
+                juce::Thread::sleep(juce::jmin(50, (int) left + 1));
+        }
+    }
+    return true;
+}
+
+bool MetadataWriteBehind::ensureConnection()
+{
+    auto file = manager.getDatabaseFile();
+    if (file == juce::File() || !file.existsAsFile())
+        return false;
+
+    if (database.isOpen() && file == openDatabaseFile)
+        return true;
+
+    database.close();
+    openDatabaseFile = file;
+    if (!database.open(file.getFullPathName()))
+    {
+        juce::Logger::writeToLog("MetadataWriteBehind: Failed to open " + file.getFullPathName());
+        return false;
+    }
+
+    // Stamp updates shouldn't turn into checkpoints; those happen in DatabaseMaintenance's idle window
+    database.setAutoCheckpoint(0);
+    return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MetadataService.h"
+#include "../Database/DatabaseSyncManager.h"
+#include <map>
+
+/**
+ * MetadataWriteBehind - carries edits made through DatabaseSyncManager (rating, tags,
+ * colour, favourite, notes, undo/redo) back into the audio files' iXML
+ *
+ * The database stays the fast path: an edit only marks its sample dirty here. A
+ * background thread writes a sample's file once its edits have settled (coalesceMs)
+ * and the library has been quiet for idleDelayMs, so a run of clicks on one sample
+ * becomes a single write. Nothing waits longer than maxDelayMs, however busy things
+ * get. Writes go out in small batches, paced to maxBytesPerSecond; activity reported
+ * through noteActivity() ends a batch early and the rest waits for the next quiet spell.
+ *
+ * Each write takes the row as it is at flush time, so the file always gets the latest
+ * values, and re-stamps the row so the next scan doesn't read our write back. Uses its
+ * own read connection. At destruction it writes what fits in shutdownFlushMs; the rows
+ * left over are still newer than their files' stamps, so the next scan reconciles them.
+ */
+class MetadataWriteBehind : private juce::Thread,
+                            private DatabaseSyncManager::Listener
+{
+public:
+    struct Settings
+    {
+        int coalesceMs = 2000;                     // Quiet time on a sample before it is written
+        int idleDelayMs = 1500;                    // Quiet time on the whole library
+        int maxDelayMs = 30 * 1000;                // Written by then even if the library never goes quiet
+        int maxFilesPerBatch = 32;
+        juce::int64 maxBytesPerSecond = 8 * 1024 * 1024;  // Rewrites count the whole file
+    };
+
+    struct Stats
+    {
+        int pending = 0;
+        int editsQueued = 0;
+        int filesWritten = 0;
+        int failures = 0;
+        juce::int64 bytesWritten = 0;
+    };
+
+    explicit MetadataWriteBehind(DatabaseSyncManager& manager);
+    ~MetadataWriteBehind() override;
+
+    void setSettings(const Settings& newSettings);
+    Stats getStats() const;
+
+    // Call from any thread while the user is busy (browsing, previewing); defers flushes
+    void noteActivity();
+
+    // Writes everything pending now, ignoring the idle and bandwidth limits. A file isn't
+    // started unless it looks like it can be rewritten before the timeout. Returns false
+    // if the timeout ran out first; what's left stays queued.
+    bool flush(int timeoutMs = 10000);
+
+private:
+    struct Pending
+    {
+        double firstEditMs = 0.0, lastEditMs = 0.0;
+    };
+
+    // The destructor can run on the host's message thread (plugin removed, project closed)
+    static constexpr int shutdownFlushMs = 250;
+    // flush()'s guess at how fast a rewrite (copy to a temp file, then rename) gets through a file
+    static constexpr juce::int64 rewriteBytesPerSecond = 32 * 1024 * 1024;
+
+    DatabaseSyncManager& manager;
+    MetadataService metadataService;
+
+    ChopsDatabase database;                 // Only touched by whichever thread holds flushLock
+    juce::File openDatabaseFile;
+    juce::CriticalSection flushLock;
+
+    mutable juce::CriticalSection lock;     // Guards everything below
+    Settings settings;
+    std::map<int, Pending> pending;         // Sample ID -> when it was edited
+    Stats stats;
+    std::atomic<double> lastActivity { 0.0 };
+
+    void databaseUpdated() override {}
+    void sampleMetadataChanged(int sampleId) override;
+
+    void run() override;
+    std::vector<std::pair<int, Pending>> takeDueSamples(bool ignoreIdle);
+    void requeue(const std::vector<std::pair<int, Pending>>& samples, size_t from);
+    // False if there's no database to read the rows from; the samples are requeued. With a
+    // deadline, files that wouldn't be done by then go to tooLarge, and once it has passed
+    // the rest are requeued.
+    bool writeSamples(const std::vector<std::pair<int, Pending>>& samples, bool throttled,
+                      double deadlineMs = 0.0, std::vector<std::pair<int, Pending>>* tooLarge = nullptr);
+    bool ensureConnection();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetadataWriteBehind)
+};
@@ -2,6 +2,13 @@
 #include "../Core/ChordTypes.h"
 #include <sqlite3.h>
 #include <algorithm> // For std::remove_if
+#include <array>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
 
 // Helper to convert juce::String to std::string for SQLite
 static std::string toStdString(const juce::String& str)
@@ -15,9 +22,118 @@ static juce::String fromSqliteText(const unsigned char* text)
     return text ? juce::String(reinterpret_cast<const char*>(text)) : juce::String();
 }
 
+// Collapses a (multi-line) SQL statement onto one line for logs and reports
+static juce::String singleLineSql(const juce::String& sql, int maxLength = 160)
+{
+    auto text = juce::StringArray::fromTokens(sql, true).joinIntoString(" ");
+    return text.length() > maxLength ? text.substring(0, maxLength - 3) + "..." : text;
+}
+
+//==============================================================================
+// Per-connection profiling data, fed by the trace hook on whichever thread runs a statement
+struct ChopsDatabase::ProfileState
+{
+    static constexpr size_t latencyWindow = 256;
+    static constexpr size_t maxSlowQueries = 50;
+
+    struct Entry
+    {
+        juce::String sql;
+        int64 calls = 0;
+        double totalMs = 0.0, maxMs = 0.0;
+        std::array<float, latencyWindow> recentMs {};
+        int64 rowsReturned = 0, fullScanSteps = 0, virtualMachineSteps = 0, sorts = 0, autoIndexes = 0;
+    };
+
+    juce::CriticalSection lock;
+    std::unordered_map<juce::uint64, Entry> statements; // Keyed by a hash of the SQL text
+    std::deque<SlowQuery> slowQueries;
+    double slowQueryThresholdMs = 50.0;
+
+    // Rows stepped so far by statements that haven't finished yet
+    std::unordered_map<sqlite3_stmt*, int64> pendingRows;
+    sqlite3_stmt* lastRowStmt = nullptr;
+    int64* lastRowCount = nullptr;
+
+    // Set while we run EXPLAIN for the slow-query log, so those don't get profiled
+    std::atomic<bool> suspended { false };
+    bool countRows = false; // Installs the per-row trace callback
+
+    static juce::uint64 hashSql(const char* sql)
+    {
+        juce::uint64 hash = 14695981039346656037ull;
+        for (; *sql != 0; ++sql)
+            hash = (hash ^ (juce::uint8) *sql) * 1099511628211ull;
+        return hash;
+    }
+
+    void countRow(sqlite3_stmt* stmt)
+    {
+        const juce::ScopedLock sl(lock);
+        if (stmt != lastRowStmt)
+        {
+            lastRowStmt = stmt;
+            lastRowCount = &pendingRows[stmt];
+        }
+        ++*lastRowCount;
+    }
+
+    // Returns true if the statement crossed the slow-query threshold
+    bool record(sqlite3_stmt* stmt, const char* sql, double ms)
+    {
+        auto status = [stmt](int op) { return (int64) sqlite3_stmt_status(stmt, op, 1); };
+        auto hash = hashSql(sql);
+
+        const juce::ScopedLock sl(lock);
+        auto& entry = statements[hash];
+        if (entry.calls == 0)
+            entry.sql = juce::String::fromUTF8(sql);
+
+        entry.recentMs[(size_t) (entry.calls % (int64) latencyWindow)] = (float) ms;
+        ++entry.calls;
+        entry.totalMs += ms;
+        entry.maxMs = juce::jmax(entry.maxMs, ms);
+        entry.fullScanSteps += status(SQLITE_STMTSTATUS_FULLSCAN_STEP);
+        entry.virtualMachineSteps += status(SQLITE_STMTSTATUS_VM_STEP);
+        entry.sorts += status(SQLITE_STMTSTATUS_SORT);
+        entry.autoIndexes += status(SQLITE_STMTSTATUS_AUTOINDEX);
+
+        auto rows = pendingRows.find(stmt);
+        if (rows != pendingRows.end())
+        {
+            entry.rowsReturned += rows->second;
+            pendingRows.erase(rows);
+            lastRowStmt = nullptr;
+        }
+
+        if (slowQueryThresholdMs <= 0.0 || ms < slowQueryThresholdMs)
+            return false;
+
+        SlowQuery slow;
+        char* expanded = sqlite3_expanded_sql(stmt);
+        slow.sql = juce::String::fromUTF8(expanded != nullptr ? expanded : sql);
+        sqlite3_free(expanded);
+        slow.milliseconds = ms;
+        slow.when = juce::Time::getCurrentTime();
+
+        slowQueries.push_back(std::move(slow));
+        while (slowQueries.size() > maxSlowQueries)
+            slowQueries.pop_front();
+        return true;
+    }
+
+    void forgetPendingRows()
+    {
+        const juce::ScopedLock sl(lock);
+        pendingRows.clear();
+        lastRowStmt = nullptr;
+    }
+};
+
 //==============================================================================
 ChopsDatabase::ChopsDatabase()
-    : db(nullptr), searchStmt(nullptr), sampleByPathStmt(nullptr), sampleByIdStmt(nullptr)
+    : db(nullptr), searchStmt(nullptr), sampleByPathStmt(nullptr), sampleByIdStmt(nullptr),
+      profile(std::make_unique<ProfileState>())
 {
 }
 
@@ -51,6 +167,17 @@ bool ChopsDatabase::open(const juce::String& databasePath)
     sqlite3_exec(static_cast<sqlite3*>(db), "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr);
     sqlite3_exec(static_cast<sqlite3*>(db), "PRAGMA synchronous = NORMAL", nullptr, nullptr, nullptr);
     sqlite3_exec(static_cast<sqlite3*>(db), "PRAGMA cache_size = 10000", nullptr, nullptr, nullptr); // Consider making cache size configurable or based on system
+    // Several connections share the file (read, write, search, maintenance); wait briefly for
+    // one another instead of failing, and keep the WAL from staying large after a reset
+    sqlite3_busy_timeout(static_cast<sqlite3*>(db), 2000);
+    sqlite3_exec(static_cast<sqlite3*>(db), "PRAGMA journal_size_limit = 16777216", nullptr, nullptr, nullptr);
+    
+    // Databases created before collections existed get the tables on first open
+    ensureCollectionTables();
+    migrateTimestamps();
+    ensureSampleColumns();
+    sqlite3_update_hook(static_cast<sqlite3*>(db), &ChopsDatabase::rowChangeHook, this);
+    installTraceHook();
     
     prepareStatements();
     
@@ -61,6 +188,8 @@ bool ChopsDatabase::open(const juce::String& databasePath)
 void ChopsDatabase::close()
 {
     finalizeStatements();
+    pendingSmartRefresh.clear();
+    profile->forgetPendingRows();
     
     if (db != nullptr)
     {
@@ -82,8 +211,7 @@ void ChopsDatabase::prepareStatements()
     juce::Logger::writeToLog("Preparing database statements");
     
     int result = sqlite3_prepare_v2(static_cast<sqlite3*>(db), 
-        R"(
-            SELECT s.*, GROUP_CONCAT(t.name, ',') as tag_list
+        ("SELECT " + sampleColumnList() + R"(, GROUP_CONCAT(t.name, ',') as tag_list
             FROM samples s
             LEFT JOIN sample_tags st ON s.id = st.sample_id
             LEFT JOIN tags t ON st.tag_id = t.id
@@ -91,17 +219,48 @@ void ChopsDatabase::prepareStatements()
             AND (?1 = '' OR s.search_text LIKE '%' || ?2 || '%')
             AND (?3 = '' OR s.root_note = ?4)
             AND (?5 = '' OR s.chord_type = ?6)
+            AND (?9 = 0 OR s.duration_ms >= ?9)
+            AND (?10 = 0 OR s.duration_ms <= ?10)
+            AND (?11 = 0 OR s.sample_rate = ?11)
+            AND (?12 = 0 OR s.channels = ?12)
             GROUP BY s.id
             ORDER BY s.root_note, s.chord_type, s.date_added DESC
             LIMIT ?7 OFFSET ?8
-        )", 
+        )").toRawUTF8(),
         -1, reinterpret_cast<sqlite3_stmt**>(&searchStmt), nullptr);
     
     if (result != SQLITE_OK) {
         juce::Logger::writeToLog("Failed to prepare search statement: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
     }
     
-    // ... rest of the method remains the same
+    // Single-row lookups use the same column list as search so parseRow can decode them
+    result = sqlite3_prepare_v2(static_cast<sqlite3*>(db),
+        ("SELECT " + sampleColumnList() + R"(, GROUP_CONCAT(t.name, ',') as tag_list
+            FROM samples s
+            LEFT JOIN sample_tags st ON s.id = st.sample_id
+            LEFT JOIN tags t ON st.tag_id = t.id
+            WHERE s.id = ?
+            GROUP BY s.id
+        )").toRawUTF8(),
+        -1, reinterpret_cast<sqlite3_stmt**>(&sampleByIdStmt), nullptr);
+    
+    if (result != SQLITE_OK) {
+        juce::Logger::writeToLog("Failed to prepare sample-by-ID statement: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+    }
+    
+    result = sqlite3_prepare_v2(static_cast<sqlite3*>(db),
+        ("SELECT " + sampleColumnList() + R"(, GROUP_CONCAT(t.name, ',') as tag_list
+            FROM samples s
+            LEFT JOIN sample_tags st ON s.id = st.sample_id
+            LEFT JOIN tags t ON st.tag_id = t.id
+            WHERE s.file_path = ?
+            GROUP BY s.id
+        )").toRawUTF8(),
+        -1, reinterpret_cast<sqlite3_stmt**>(&sampleByPathStmt), nullptr);
+    
+    if (result != SQLITE_OK) {
+        juce::Logger::writeToLog("Failed to prepare sample-by-path statement: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+    }
 }
 
 void ChopsDatabase::finalizeStatements()
@@ -112,6 +271,117 @@ void ChopsDatabase::finalizeStatements()
 }
 
 //==============================================================================
+//==============================================================================
+// Row mapping
+//
+// Every query that returns whole samples selects sampleColumnList() followed by the
+// tag list, and parseRow reads each field at its position in this table. Adding or
+// reordering columns in schema.sql can't shift what lands in which field.
+struct ChopsDatabase::SampleRowMapping
+{
+    static juce::String text(sqlite3_stmt* stmt, int col)
+    {
+        auto* utf8 = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+        return utf8 != nullptr ? juce::String::fromUTF8(utf8, sqlite3_column_bytes(stmt, col)) : juce::String();
+    }
+
+    // How each column is decoded
+    struct AsInt     { static void read(sqlite3_stmt* s, int c, int& v)               { v = sqlite3_column_int(s, c); } };
+    struct AsInt64   { static void read(sqlite3_stmt* s, int c, juce::int64& v)       { v = sqlite3_column_int64(s, c); } };
+    struct AsHash    { static void read(sqlite3_stmt* s, int c, juce::uint64& v)      { v = (juce::uint64) sqlite3_column_int64(s, c); } };
+    struct AsFlag    { static void read(sqlite3_stmt* s, int c, bool& v)              { v = sqlite3_column_int(s, c) != 0; } };
+    struct AsText    { static void read(sqlite3_stmt* s, int c, juce::String& v)      { v = text(s, c); } };
+    struct AsJson    { static void read(sqlite3_stmt* s, int c, juce::StringArray& v) { v = parseJsonArray(text(s, c)); } };
+    struct AsEpochMs
+    {
+        static void read(sqlite3_stmt* s, int c, juce::Time& v)
+        {
+            v = sqlite3_column_type(s, c) == SQLITE_NULL ? juce::Time() : juce::Time(sqlite3_column_int64(s, c));
+        }
+    };
+    struct AsColour
+    {
+        static void read(sqlite3_stmt* s, int c, juce::Colour& v)
+        {
+            auto hex = text(s, c);
+            v = hex.isNotEmpty() ? juce::Colour::fromString(hex) : juce::Colours::transparentBlack;
+        }
+    };
+
+    template <auto Member, typename Codec>
+    struct Field
+    {
+        const char* column;
+        static void read(sqlite3_stmt* stmt, int col, SampleInfo& info) { Codec::read(stmt, col, info.*Member); }
+    };
+
+    static constexpr auto fields = std::make_tuple(
+        Field<&SampleInfo::id,               AsInt>     { "id" },
+        Field<&SampleInfo::originalFilename, AsText>    { "original_filename" },
+        Field<&SampleInfo::currentFilename,  AsText>    { "current_filename" },
+        Field<&SampleInfo::filePath,         AsText>    { "file_path" },
+        Field<&SampleInfo::fileSize,         AsInt64>   { "file_size" },
+        Field<&SampleInfo::contentHash,      AsHash>    { "content_hash" },
+        Field<&SampleInfo::durationMs,       AsInt>     { "duration_ms" },
+        Field<&SampleInfo::sampleRate,       AsInt>     { "sample_rate" },
+        Field<&SampleInfo::bitDepth,         AsInt>     { "bit_depth" },
+        Field<&SampleInfo::channels,         AsInt>     { "channels" },
+        Field<&SampleInfo::rootNote,         AsText>    { "root_note" },
+        Field<&SampleInfo::chordType,        AsText>    { "chord_type" },
+        Field<&SampleInfo::chordTypeDisplay, AsText>    { "chord_type_display" },
+        Field<&SampleInfo::extensions,       AsJson>    { "extensions" },
+        Field<&SampleInfo::alterations,      AsJson>    { "alterations" },
+        Field<&SampleInfo::addedNotes,       AsJson>    { "added_notes" },
+        Field<&SampleInfo::suspensions,      AsJson>    { "suspensions" },
+        Field<&SampleInfo::bassNote,         AsText>    { "bass_note" },
+        Field<&SampleInfo::inversion,        AsText>    { "inversion" },
+        Field<&SampleInfo::dateAdded,        AsEpochMs> { "date_added" },
+        Field<&SampleInfo::dateModified,     AsEpochMs> { "date_modified" },
+        Field<&SampleInfo::rating,           AsInt>     { "rating" },
+        Field<&SampleInfo::color,            AsColour>  { "color_hex" },
+        Field<&SampleInfo::isFavorite,       AsFlag>    { "is_favorite" },
+        Field<&SampleInfo::playCount,        AsInt>     { "play_count" },
+        Field<&SampleInfo::userNotes,        AsText>    { "user_notes" },
+        Field<&SampleInfo::lastPlayed,       AsEpochMs> { "last_played" }
+    );
+
+    static constexpr int numFields = (int) std::tuple_size_v<decltype(fields)>;
+    static constexpr int tagListColumn = numFields; // GROUP_CONCAT of tag names, always last
+
+    template <size_t... I>
+    static void readFields(sqlite3_stmt* stmt, SampleInfo& info, std::index_sequence<I...>)
+    {
+        (std::tuple_element_t<I, std::remove_const_t<decltype(fields)>>::read(stmt, (int) I, info), ...);
+    }
+
+    // Position of a column in the table, or -1; lets compact readers name columns
+    static constexpr int column(std::string_view name)
+    {
+        return columnIndex(name, std::make_index_sequence<(size_t) numFields>());
+    }
+
+    template <size_t... I>
+    static constexpr int columnIndex(std::string_view name, std::index_sequence<I...>)
+    {
+        int index = -1;
+        ((std::string_view(std::get<I>(fields).column) == name ? (index = (int) I, true) : false) || ...);
+        return index;
+    }
+
+    template <size_t... I>
+    static juce::String columnList(std::index_sequence<I...>)
+    {
+        juce::StringArray names { juce::String("s.") + std::get<I>(fields).column... };
+        return names.joinIntoString(", ");
+    }
+};
+
+const juce::String& ChopsDatabase::sampleColumnList()
+{
+    static const juce::String list = SampleRowMapping::columnList(std::make_index_sequence<SampleRowMapping::numFields>());
+    return list;
+}
+
 ChopsDatabase::SampleInfo ChopsDatabase::parseRow(void* stmtPtr)
 {
     SampleInfo info;
@@ -120,73 +390,11 @@ ChopsDatabase::SampleInfo ChopsDatabase::parseRow(void* stmtPtr)
     if (!stmt) return info;
     
     try {
-        int col = 0;
-        info.id = sqlite3_column_int(stmt, col++);
-        info.originalFilename = fromSqliteText(sqlite3_column_text(stmt, col++));
-        info.currentFilename = fromSqliteText(sqlite3_column_text(stmt, col++));
-        info.filePath = fromSqliteText(sqlite3_column_text(stmt, col++));
-        info.fileSize = sqlite3_column_int64(stmt, col++);
-        
-        info.rootNote = fromSqliteText(sqlite3_column_text(stmt, col++));
-        info.chordType = fromSqliteText(sqlite3_column_text(stmt, col++));
-        info.chordTypeDisplay = fromSqliteText(sqlite3_column_text(stmt, col++));
-        
-        info.extensions = parseJsonArray(fromSqliteText(sqlite3_column_text(stmt, col++)));
-        info.alterations = parseJsonArray(fromSqliteText(sqlite3_column_text(stmt, col++)));
-        info.addedNotes = parseJsonArray(fromSqliteText(sqlite3_column_text(stmt, col++)));
-        info.suspensions = parseJsonArray(fromSqliteText(sqlite3_column_text(stmt, col++)));
-        
-        info.bassNote = fromSqliteText(sqlite3_column_text(stmt, col++));
-        info.inversion = fromSqliteText(sqlite3_column_text(stmt, col++));
-        
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.dateAdded = juce::Time::fromISO8601(fromSqliteText(sqlite3_column_text(stmt, col)));
-        col++;
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.dateModified = juce::Time::fromISO8601(fromSqliteText(sqlite3_column_text(stmt, col)));
-        col++;
-
-        // Skip columns not in SampleInfo struct (as per schema.sql and ChopsDatabase.h)
-        col++; // processing_version (col 16)
-        col++; // search_text (col 17)
-        col++; // duration_ms (col 18)
-        col++; // sample_rate (col 19)
-        col++; // bit_depth (col 20)
-        col++; // channels (col 21)
-        col++; // bpm (col 22)
-        col++; // musical_key (col 23)
-
-        // Resume with SampleInfo fields
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.rating = sqlite3_column_int(stmt, col);
-        col++; // rating (col 24)
-        
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) {
-            auto colorHex = fromSqliteText(sqlite3_column_text(stmt, col));
-            if (colorHex.isNotEmpty()) info.color = juce::Colour::fromString(colorHex);
-        }
-        col++; // color_hex (col 25)
-        
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.isFavorite = sqlite3_column_int(stmt, col) != 0;
-        col++; // is_favorite (col 26)
-        
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.playCount = sqlite3_column_int(stmt, col);
-        col++; // play_count (col 27)
+        SampleRowMapping::readFields(stmt, info, std::make_index_sequence<SampleRowMapping::numFields>());
         
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.userNotes = fromSqliteText(sqlite3_column_text(stmt, col));
-        col++; // user_notes (col 28)
-        
-        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) info.lastPlayed = juce::Time::fromISO8601(fromSqliteText(sqlite3_column_text(stmt, col)));
-        col++; // last_played (col 29)
-
-        // Tags (appended by GROUP_CONCAT, will be the next column after all s.* columns)
-        // col should now be 30 if all s.* columns were present.
-        int totalColumnCount = sqlite3_column_count(stmt);
-        if (col < totalColumnCount && strcmp(sqlite3_column_name(stmt, col), "tag_list") == 0) {
-            if (sqlite3_column_type(stmt, col) != SQLITE_NULL) {
-                auto tagListStr = fromSqliteText(sqlite3_column_text(stmt, col));
-                if (tagListStr.isNotEmpty()) {
-                    info.tags = juce::StringArray::fromTokens(tagListStr, ",", "");
-                }
-            }
-        }
+        auto tagList = SampleRowMapping::text(stmt, SampleRowMapping::tagListColumn);
+        if (tagList.isNotEmpty())
+            info.tags = juce::StringArray::fromTokens(tagList, ",", "");
     }
     catch (const std::exception& e) { // Catch specific exceptions if possible
         juce::Logger::writeToLog("Error parsing database row: " + juce::String(e.what()));
@@ -197,7 +405,6 @@ ChopsDatabase::SampleInfo ChopsDatabase::parseRow(void* stmtPtr)
     return info;
 }
 
-
 juce::StringArray ChopsDatabase::parseJsonArray(const juce::String& json)
 {
     juce::StringArray result;
@@ -251,11 +458,83 @@ juce::String ChopsDatabase::stringArrayToJson(const juce::StringArray& array)
 }
 
 //==============================================================================
-std::vector<ChopsDatabase::SampleInfo> ChopsDatabase::searchSamples(
+bool ChopsDatabase::appendCompactRow(void* stmtPtr, ResultSet& results, BoolFilter hasExtensions, BoolFilter hasAlterations)
+{
+    using Map = SampleRowMapping;
+    constexpr int idCol = Map::column("id"),               originalCol = Map::column("original_filename"),
+                  currentCol = Map::column("current_filename"), pathCol = Map::column("file_path"),
+                  sizeCol = Map::column("file_size"),       hashCol = Map::column("content_hash"),
+                  durationCol = Map::column("duration_ms"), rateCol = Map::column("sample_rate"),
+                  bitDepthCol = Map::column("bit_depth"),   channelsCol = Map::column("channels"),
+                  rootCol = Map::column("root_note"),
+                  chordCol = Map::column("chord_type"),     displayCol = Map::column("chord_type_display"),
+                  extensionsCol = Map::column("extensions"), alterationsCol = Map::column("alterations"),
+                  addedCol = Map::column("added_notes"),    suspensionsCol = Map::column("suspensions"),
+                  bassCol = Map::column("bass_note"),       inversionCol = Map::column("inversion"),
+                  dateAddedCol = Map::column("date_added"), dateModifiedCol = Map::column("date_modified"),
+                  ratingCol = Map::column("rating"),        colourCol = Map::column("color_hex"),
+                  favoriteCol = Map::column("is_favorite"), playCountCol = Map::column("play_count"),
+                  notesCol = Map::column("user_notes"),     lastPlayedCol = Map::column("last_played");
+    static_assert(idCol >= 0 && originalCol >= 0 && currentCol >= 0 && pathCol >= 0 && sizeCol >= 0 && hashCol >= 0
+                  && durationCol >= 0 && rateCol >= 0 && bitDepthCol >= 0 && channelsCol >= 0
+                  && rootCol >= 0 && chordCol >= 0 && displayCol >= 0 && extensionsCol >= 0 && alterationsCol >= 0
+                  && addedCol >= 0 && suspensionsCol >= 0 && bassCol >= 0 && inversionCol >= 0
+                  && dateAddedCol >= 0 && dateModifiedCol >= 0 && ratingCol >= 0 && colourCol >= 0
+                  && favoriteCol >= 0 && playCountCol >= 0 && notesCol >= 0 && lastPlayedCol >= 0,
+                  "Compact row reader names a column missing from SampleRowMapping::fields");
+
+    auto* stmt = static_cast<sqlite3_stmt*>(stmtPtr);
+    auto bytes = [stmt](int col) { return reinterpret_cast<const char*>(sqlite3_column_text(stmt, col)); };
+    auto store = [&](int col) { auto* t = bytes(col); return results.store(t, sqlite3_column_bytes(stmt, col)); };
+    auto intern = [&](int col) { auto* t = bytes(col); return results.intern(t, sqlite3_column_bytes(stmt, col)); };
+    auto passes = [](BoolFilter filter, bool isEmpty) { return filter == DontCare || (filter == Yes) != isEmpty; };
+
+    // Filter before anything row-specific reaches the arena
+    auto extensions = intern(extensionsCol);
+    auto alterations = intern(alterationsCol);
+    if (!passes(hasExtensions, results.isEmptyList(extensions, ResultSet::ListFormat::json))
+        || !passes(hasAlterations, results.isEmptyList(alterations, ResultSet::ListFormat::json)))
+        return false;
+
+    ResultSet::Row row {};
+    row.id = sqlite3_column_int(stmt, idCol);
+    row.originalFilename = store(originalCol);
+    row.currentFilename = store(currentCol);
+    row.filePath = store(pathCol);
+    row.fileSize = sqlite3_column_int64(stmt, sizeCol);
+    row.contentHash = (juce::uint64) sqlite3_column_int64(stmt, hashCol);
+    row.durationMs = sqlite3_column_int(stmt, durationCol);
+    row.sampleRate = sqlite3_column_int(stmt, rateCol);
+    row.bitDepth = (juce::uint8) juce::jlimit(0, 255, sqlite3_column_int(stmt, bitDepthCol));
+    row.channels = (juce::uint8) juce::jlimit(0, 255, sqlite3_column_int(stmt, channelsCol));
+    row.rootNote = intern(rootCol);
+    row.chordType = intern(chordCol);
+    row.chordTypeDisplay = intern(displayCol);
+    row.extensions = extensions;
+    row.alterations = alterations;
+    row.addedNotes = intern(addedCol);
+    row.suspensions = intern(suspensionsCol);
+    row.bassNote = intern(bassCol);
+    row.inversion = intern(inversionCol);
+    row.dateAddedMs = sqlite3_column_int64(stmt, dateAddedCol);   // NULL reads as 0, same as juce::Time()
+    row.dateModifiedMs = sqlite3_column_int64(stmt, dateModifiedCol);
+    row.rating = (juce::uint8) juce::jlimit(0, 255, sqlite3_column_int(stmt, ratingCol));
+    row.colourHex = intern(colourCol);
+    row.isFavorite = sqlite3_column_int(stmt, favoriteCol) != 0;
+    row.playCount = sqlite3_column_int(stmt, playCountCol);
+    row.userNotes = store(notesCol);
+    row.lastPlayedMs = sqlite3_column_int64(stmt, lastPlayedCol);
+    row.tags = intern(Map::tagListColumn);
+
+    results.rows.push_back(row);
+    return true;
+}
+
+ResultSet ChopsDatabase::searchSamples(
     const juce::String& query, const juce::String& rootNote, const juce::String& chordType,
-    BoolFilter hasExtensions, BoolFilter hasAlterations, int limit, int offset)
+    BoolFilter hasExtensions, BoolFilter hasAlterations, int limit, int offset, const FormatFilter& format)
 {
-    std::vector<SampleInfo> results;
+    ResultSet results;
     if (db == nullptr || searchStmt == nullptr) {
         juce::Logger::writeToLog("Database or search statement not available for searchSamples");
         return results;
@@ -271,22 +550,18 @@ std::vector<ChopsDatabase::SampleInfo> ChopsDatabase::searchSamples(
         sqlite3_bind_text(stmt, 6, toStdString(chordType).c_str(), -1, SQLITE_TRANSIENT); // chordType used twice
         sqlite3_bind_int(stmt, 7, limit);
         sqlite3_bind_int(stmt, 8, offset);
+        sqlite3_bind_int(stmt, 9, format.minDurationMs);
+        sqlite3_bind_int(stmt, 10, format.maxDurationMs);
+        sqlite3_bind_int(stmt, 11, format.sampleRate);
+        sqlite3_bind_int(stmt, 12, format.channels);
+        
+        if (limit > 0)
+            results.reserve((size_t) limit);
         
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            results.push_back(parseRow(stmt));
+            appendCompactRow(stmt, results, hasExtensions, hasAlterations);
         }
         sqlite3_reset(stmt); // Reset for next use
-        
-        if (hasExtensions != DontCare || hasAlterations != DontCare) {
-            results.erase(std::remove_if(results.begin(), results.end(),
-                [hasExtensions, hasAlterations](const SampleInfo& info) {
-                    if (hasExtensions == Yes && info.extensions.isEmpty()) return true;
-                    if (hasExtensions == No && !info.extensions.isEmpty()) return true;
-                    if (hasAlterations == Yes && info.alterations.isEmpty()) return true;
-                    if (hasAlterations == No && !info.alterations.isEmpty()) return true;
-                    return false;
-                }), results.end());
-        }
     } catch (...) {
         juce::Logger::writeToLog("Error executing search query");
         sqlite3_reset(stmt); // Ensure reset even on error
@@ -330,6 +605,129 @@ std::unique_ptr<ChopsDatabase::SampleInfo> ChopsDatabase::getSampleById(int samp
     return info;
 }
 
+juce::Array<int> ChopsDatabase::findSampleIdsByContentHash(juce::uint64 contentHash)
+{
+    juce::Array<int> sampleIds;
+    if (db == nullptr || contentHash == 0) return sampleIds;
+    
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), "SELECT id FROM samples WHERE content_hash = ? ORDER BY id",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        return sampleIds;
+    }
+    
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64) contentHash);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+        sampleIds.add(sqlite3_column_int(stmt, 0));
+    sqlite3_finalize(stmt);
+    return sampleIds;
+}
+
+std::vector<ChopsDatabase::StampedFile> ChopsDatabase::getFileStamps()
+{
+    std::vector<StampedFile> files;
+    if (db == nullptr) return files;
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT id, file_path, file_size, file_mtime_ms, file_inode, file_device, date_modified, file_synced_ms, "
+                      "sample_rate IS NOT NULL FROM samples";
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        juce::Logger::writeToLog("Failed to read file stamps: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+        return files;
+    }
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        StampedFile file;
+        file.sampleId = sqlite3_column_int(stmt, 0);
+        file.filePath = fromSqliteText(sqlite3_column_text(stmt, 1));
+        file.stamp.size = sqlite3_column_int64(stmt, 2);
+        file.stamp.modifiedMs = sqlite3_column_int64(stmt, 3);
+        file.stamp.inode = sqlite3_column_int64(stmt, 4);
+        file.stamp.device = sqlite3_column_int64(stmt, 5);
+        file.dateModifiedMs = sqlite3_column_int64(stmt, 6);
+        file.syncedMs = sqlite3_column_int64(stmt, 7);
+        file.hasAudioFormat = sqlite3_column_int(stmt, 8) != 0;
+        files.push_back(std::move(file));
+    }
+    sqlite3_finalize(stmt);
+    return files;
+}
+
+bool ChopsDatabase::setFileStamp(int sampleId, const FileStamp& stamp)
+{
+    if (db == nullptr) return false;
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE samples SET file_size = ?, file_mtime_ms = ?, file_inode = ?, file_device = ?, "
+                      "file_synced_ms = ? WHERE id = ?";
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_int64(stmt, 1, stamp.size);
+    sqlite3_bind_int64(stmt, 2, stamp.modifiedMs);
+    sqlite3_bind_int64(stmt, 3, stamp.inode);
+    sqlite3_bind_int64(stmt, 4, stamp.device);
+    sqlite3_bind_int64(stmt, 5, juce::Time::currentTimeMillis());
+    sqlite3_bind_int(stmt, 6, sampleId);
+    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+bool ChopsDatabase::moveSampleFile(int sampleId, const juce::String& newFilePath, const FileStamp& stamp)
+{
+    if (db == nullptr) return false;
+    
+    sqlite3_stmt* stmt;
+    const char* sql = R"(
+        UPDATE samples SET file_path = ?, current_filename = ?,
+            file_size = ?, file_mtime_ms = ?, file_inode = ?, file_device = ?, file_synced_ms = ?
+        WHERE id = ?
+    )";
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_text(stmt, 1, toStdString(newFilePath).c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, toStdString(juce::File(newFilePath).getFileName()).c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 3, stamp.size);
+    sqlite3_bind_int64(stmt, 4, stamp.modifiedMs);
+    sqlite3_bind_int64(stmt, 5, stamp.inode);
+    sqlite3_bind_int64(stmt, 6, stamp.device);
+    sqlite3_bind_int64(stmt, 7, juce::Time::currentTimeMillis());
+    sqlite3_bind_int(stmt, 8, sampleId);
+    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+    if (!success)
+        juce::Logger::writeToLog("Failed to move sample " + juce::String(sampleId) + ": " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+    return success;
+}
+
+bool ChopsDatabase::setAudioFormat(int sampleId, int durationMs, int sampleRate, int bitDepth, int channels)
+{
+    if (db == nullptr) return false;
+    
+    // Written as given: zeros record that the header was probed and said nothing
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE samples SET duration_ms = ?, sample_rate = ?, bit_depth = ?, channels = ? WHERE id = ?";
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_int(stmt, 1, durationMs);
+    sqlite3_bind_int(stmt, 2, sampleRate);
+    sqlite3_bind_int(stmt, 3, bitDepth);
+    sqlite3_bind_int(stmt, 4, channels);
+    sqlite3_bind_int(stmt, 5, sampleId);
+    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+// Binds duration_ms, sample_rate, bit_depth and channels; all NULL when the format is unknown
+static int bindAudioFormat(sqlite3_stmt* stmt, int col, const ChopsDatabase::SampleInfo& sample)
+{
+    for (int value : { sample.durationMs, sample.sampleRate, sample.bitDepth, sample.channels }) {
+        if (sample.sampleRate > 0)
+            sqlite3_bind_int(stmt, col++, value);
+        else
+            sqlite3_bind_null(stmt, col++);
+    }
+    return col;
+}
+
 //==============================================================================
 int ChopsDatabase::insertSample(const SampleInfo& sample)
 {
@@ -341,12 +739,13 @@ int ChopsDatabase::insertSample(const SampleInfo& sample)
     if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), 
         R"(
             INSERT INTO samples (
-                original_filename, current_filename, file_path, file_size,
+                original_filename, current_filename, file_path, file_size, content_hash,
+                duration_ms, sample_rate, bit_depth, channels,
                 root_note, chord_type, chord_type_display,
                 extensions, alterations, added_notes, suspensions,
-                bass_note, inversion, 
+                bass_note, inversion, date_added, date_modified,
                 search_text, rating, color_hex, is_favorite, play_count, user_notes, last_played
-            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
         )", 
         -1, &stmt, nullptr) != SQLITE_OK) {
         
@@ -360,6 +759,11 @@ int ChopsDatabase::insertSample(const SampleInfo& sample)
         sqlite3_bind_text(stmt, col++, toStdString(sample.currentFilename).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.filePath).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int64(stmt, col++, sample.fileSize);
+        if (sample.contentHash != 0)
+            sqlite3_bind_int64(stmt, col++, (sqlite3_int64) sample.contentHash);
+        else
+            sqlite3_bind_null(stmt, col++);
+        col = bindAudioFormat(stmt, col, sample);
         sqlite3_bind_text(stmt, col++, toStdString(sample.rootNote).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.chordType).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.chordTypeDisplay).c_str(), -1, SQLITE_TRANSIENT);
@@ -370,6 +774,11 @@ int ChopsDatabase::insertSample(const SampleInfo& sample)
         sqlite3_bind_text(stmt, col++, toStdString(sample.bassNote).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.inversion).c_str(), -1, SQLITE_TRANSIENT);
         
+        // Bound explicitly: older databases still carry a text CURRENT_TIMESTAMP default
+        auto now = juce::Time::currentTimeMillis();
+        sqlite3_bind_int64(stmt, col++, sample.dateAdded.toMilliseconds() > 0 ? sample.dateAdded.toMilliseconds() : now);
+        sqlite3_bind_int64(stmt, col++, sample.dateModified.toMilliseconds() > 0 ? sample.dateModified.toMilliseconds() : now);
+        
         juce::String searchText = (sample.originalFilename + " " + sample.currentFilename + " " +
                                   sample.rootNote + " " + sample.chordType + " " +
                                   sample.tags.joinIntoString(" ")).toLowerCase();
@@ -382,7 +791,7 @@ int ChopsDatabase::insertSample(const SampleInfo& sample)
         sqlite3_bind_text(stmt, col++, toStdString(sample.userNotes).c_str(), -1, SQLITE_TRANSIENT);
         
         if (sample.lastPlayed.toMilliseconds() > 0)
-            sqlite3_bind_text(stmt, col++, toStdString(sample.lastPlayed.toISO8601(true)).c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, col++, sample.lastPlayed.toMilliseconds());
         else
             sqlite3_bind_null(stmt, col++);
 
@@ -409,17 +818,20 @@ bool ChopsDatabase::updateSample(const SampleInfo& sample)
     if (db == nullptr || sample.id <= 0) return false;
     
     // Similar to insert, update fields present in SampleInfo
-    // date_modified is set to CURRENT_TIMESTAMP by the query
+    // date_modified is set to the current time
     const char* sql = R"(
         UPDATE samples SET
             original_filename = ?, current_filename = ?, file_path = ?, file_size = ?,
+            content_hash = COALESCE(?, content_hash),
+            duration_ms = COALESCE(?, duration_ms), sample_rate = COALESCE(?, sample_rate),
+            bit_depth = COALESCE(?, bit_depth), channels = COALESCE(?, channels),
             root_note = ?, chord_type = ?, chord_type_display = ?,
             extensions = ?, alterations = ?, added_notes = ?, suspensions = ?,
             bass_note = ?, inversion = ?, search_text = ?,
             rating = ?, color_hex = ?, is_favorite = ?, play_count = ?, user_notes = ?, last_played = ?,
-            date_modified = CURRENT_TIMESTAMP
+            date_modified = ?
         WHERE id = ? 
-    )"; // 20 fields to set + id (21 bindings)
+    )"; // 26 fields to set + id (27 bindings); an unknown hash or format keeps the stored one
 
     sqlite3_stmt* stmt;
     if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -433,6 +845,11 @@ bool ChopsDatabase::updateSample(const SampleInfo& sample)
         sqlite3_bind_text(stmt, col++, toStdString(sample.currentFilename).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.filePath).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int64(stmt, col++, sample.fileSize);
+        if (sample.contentHash != 0)
+            sqlite3_bind_int64(stmt, col++, (sqlite3_int64) sample.contentHash);
+        else
+            sqlite3_bind_null(stmt, col++);
+        col = bindAudioFormat(stmt, col, sample);
         sqlite3_bind_text(stmt, col++, toStdString(sample.rootNote).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.chordType).c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, col++, toStdString(sample.chordTypeDisplay).c_str(), -1, SQLITE_TRANSIENT);
@@ -455,10 +872,11 @@ bool ChopsDatabase::updateSample(const SampleInfo& sample)
         sqlite3_bind_text(stmt, col++, toStdString(sample.userNotes).c_str(), -1, SQLITE_TRANSIENT);
 
         if (sample.lastPlayed.toMilliseconds() > 0)
-            sqlite3_bind_text(stmt, col++, toStdString(sample.lastPlayed.toISO8601(true)).c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, col++, sample.lastPlayed.toMilliseconds());
         else
             sqlite3_bind_null(stmt, col++);
             
+        sqlite3_bind_int64(stmt, col++, juce::Time::currentTimeMillis());
         sqlite3_bind_int(stmt, col++, sample.id);
         
         bool success = sqlite3_step(stmt) == SQLITE_DONE;
@@ -519,14 +937,20 @@ bool ChopsDatabase::addTag(int sampleId, const juce::String& tag)
         sqlite3_finalize(getIdStmt);
         if (tagId < 0) return false;
 
-        // Add sample-tag relationship
-        const char* addRelationSql = "INSERT OR IGNORE INTO sample_tags (sample_id, tag_id) VALUES (?, ?)";
+        // Add sample-tag relationship. date_added is bound explicitly, as in insertSample: older
+        // databases still carry a text CURRENT_TIMESTAMP default. The standalone app's fallback
+        // schema has no such column.
+        const char* addRelationSql = "INSERT OR IGNORE INTO sample_tags (sample_id, tag_id, date_added) VALUES (?, ?, ?)";
+        const char* addRelationNoDateSql = "INSERT OR IGNORE INTO sample_tags (sample_id, tag_id) VALUES (?, ?)";
         sqlite3_stmt* addRelStmt;
-        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), addRelationSql, -1, &addRelStmt, nullptr) != SQLITE_OK) return false;
+        bool withDate = sqlite3_prepare_v2(static_cast<sqlite3*>(db), addRelationSql, -1, &addRelStmt, nullptr) == SQLITE_OK;
+        if (!withDate && sqlite3_prepare_v2(static_cast<sqlite3*>(db), addRelationNoDateSql, -1, &addRelStmt, nullptr) != SQLITE_OK) return false;
         sqlite3_bind_int(addRelStmt, 1, sampleId);
         sqlite3_bind_int(addRelStmt, 2, tagId);
+        if (withDate) sqlite3_bind_int64(addRelStmt, 3, juce::Time::currentTimeMillis());
         bool success = sqlite3_step(addRelStmt) == SQLITE_DONE;
         sqlite3_finalize(addRelStmt);
+        if (success) pendingSmartRefresh.add(sampleId); // Tag criteria depend on sample_tags, not the samples row
         return success;
     } catch (...) { juce::Logger::writeToLog("Error adding tag"); }
     return false;
@@ -544,6 +968,7 @@ bool ChopsDatabase::removeTag(int sampleId, const juce::String& tag)
         sqlite3_bind_text(stmt, 2, toStdString(tag).c_str(), -1, SQLITE_TRANSIENT);
         bool success = sqlite3_step(stmt) == SQLITE_DONE;
         sqlite3_finalize(stmt);
+        if (success) pendingSmartRefresh.add(sampleId);
         return success;
     } catch (...) { juce::Logger::writeToLog("Error removing tag"); }
     return false;
@@ -615,10 +1040,11 @@ bool ChopsDatabase::incrementPlayCount(int sampleId)
 {
     if (db == nullptr) return false;
     try {
-        const char* sql = "UPDATE samples SET play_count = play_count + 1, last_played = CURRENT_TIMESTAMP WHERE id = ?";
+        const char* sql = "UPDATE samples SET play_count = play_count + 1, last_played = ? WHERE id = ?";
         sqlite3_stmt* stmt;
         if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-        sqlite3_bind_int(stmt, 1, sampleId);
+        sqlite3_bind_int64(stmt, 1, juce::Time::currentTimeMillis());
+        sqlite3_bind_int(stmt, 2, sampleId);
         bool success = sqlite3_step(stmt) == SQLITE_DONE;
         sqlite3_finalize(stmt);
         return success;
@@ -682,8 +1108,7 @@ std::vector<ChopsDatabase::SampleInfo> ChopsDatabase::getSamplesByTag(const juce
     std::vector<SampleInfo> results;
     if (db == nullptr || tag.isEmpty()) return results;
     try {
-        const char* sql = R"(
-            SELECT s.*, GROUP_CONCAT(t2.name, ',') as tag_list
+        const juce::String sql = "SELECT " + sampleColumnList() + R"(, GROUP_CONCAT(t2.name, ',') as tag_list
             FROM samples s
             JOIN sample_tags st ON s.id = st.sample_id
             JOIN tags t ON st.tag_id = t.id
@@ -694,7 +1119,7 @@ std::vector<ChopsDatabase::SampleInfo> ChopsDatabase::getSamplesByTag(const juce
             ORDER BY s.root_note, s.chord_type
         )";
         sqlite3_stmt* stmt;
-        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return results;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql.toRawUTF8(), -1, &stmt, nullptr) != SQLITE_OK) return results;
         sqlite3_bind_text(stmt, 1, toStdString(tag).c_str(), -1, SQLITE_TRANSIENT);
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             results.push_back(parseRow(stmt));
@@ -807,7 +1232,8 @@ ChopsDatabase::Statistics ChopsDatabase::getStatistics()
             sqlite3_finalize(stmt);
         }
         // Added last week
-        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), "SELECT COUNT(*) FROM samples WHERE date_added > datetime('now', '-7 days')", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), "SELECT COUNT(*) FROM samples WHERE date_added > ?", -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int64(stmt, 1, (juce::Time::getCurrentTime() - juce::RelativeTime::days(7)).toMilliseconds());
             if (sqlite3_step(stmt) == SQLITE_ROW) stats.addedLastWeek = sqlite3_column_int(stmt, 0);
             sqlite3_finalize(stmt);
         }
@@ -816,6 +1242,544 @@ ChopsDatabase::Statistics ChopsDatabase::getStatistics()
 }
 
 
+//==============================================================================
+// Collections
+
+// Shared predicate for smart collections. Parameters ?1-?8 and ?11-?14 are the criteria (see
+// bindCriteria), ?9 is the collection id and ?10 the sample id for single-row refreshes.
+static const char* smartCriteriaWhere = R"(
+    (?1 = '' OR s.search_text LIKE '%' || ?1 || '%')
+    AND (?2 = '' OR s.root_note = ?2)
+    AND (?3 = '' OR s.chord_type = ?3)
+    AND (?4 = 0 OR (?4 = 1) = (s.extensions IS NOT NULL AND s.extensions != '[]'))
+    AND (?5 = 0 OR (?5 = 1) = (s.alterations IS NOT NULL AND s.alterations != '[]'))
+    AND COALESCE(s.rating, 0) >= ?6
+    AND (?7 = 0 OR s.is_favorite = 1)
+    AND (?8 = '' OR EXISTS (SELECT 1 FROM sample_tags st JOIN tags t ON st.tag_id = t.id
+                            WHERE st.sample_id = s.id AND t.name = ?8))
+    AND (?11 = 0 OR s.duration_ms >= ?11)
+    AND (?12 = 0 OR s.duration_ms <= ?12)
+    AND (?13 = 0 OR s.sample_rate = ?13)
+    AND (?14 = 0 OR s.channels = ?14)
+)";
+
+static void bindCriteria(sqlite3_stmt* stmt, const ChopsDatabase::CollectionCriteria& criteria)
+{
+    sqlite3_bind_text(stmt, 1, toStdString(criteria.query.toLowerCase()).c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, toStdString(criteria.rootNote).c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 3, toStdString(criteria.chordType).c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 4, static_cast<int>(criteria.hasExtensions));
+    sqlite3_bind_int(stmt, 5, static_cast<int>(criteria.hasAlterations));
+    sqlite3_bind_int(stmt, 6, criteria.minRating);
+    sqlite3_bind_int(stmt, 7, criteria.favoritesOnly ? 1 : 0);
+    sqlite3_bind_text(stmt, 8, toStdString(criteria.tag).c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 11, criteria.minDurationMs);
+    sqlite3_bind_int(stmt, 12, criteria.maxDurationMs);
+    sqlite3_bind_int(stmt, 13, criteria.sampleRate);
+    sqlite3_bind_int(stmt, 14, criteria.channels);
+}
+
+// Sample id lists are passed to SQLite as a JSON array and expanded with json_each,
+// so bulk membership edits are one statement rather than one per sample.
+static juce::String idsToJson(const juce::Array<int>& ids)
+{
+    juce::String json = "[";
+    for (int i = 0; i < ids.size(); ++i) {
+        if (i > 0) json += ",";
+        json += juce::String(ids[i]);
+    }
+    return json + "]";
+}
+
+juce::String ChopsDatabase::CollectionCriteria::toJson() const
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty("query", query);
+    obj->setProperty("rootNote", rootNote);
+    obj->setProperty("chordType", chordType);
+    obj->setProperty("hasExtensions", static_cast<int>(hasExtensions));
+    obj->setProperty("hasAlterations", static_cast<int>(hasAlterations));
+    obj->setProperty("minRating", minRating);
+    obj->setProperty("favoritesOnly", favoritesOnly);
+    obj->setProperty("tag", tag);
+    obj->setProperty("minDurationMs", minDurationMs);
+    obj->setProperty("maxDurationMs", maxDurationMs);
+    obj->setProperty("sampleRate", sampleRate);
+    obj->setProperty("channels", channels);
+    return juce::JSON::toString(juce::var(obj), true);
+}
+
+ChopsDatabase::CollectionCriteria ChopsDatabase::CollectionCriteria::fromJson(const juce::String& json)
+{
+    CollectionCriteria criteria;
+    auto parsed = juce::JSON::parse(json);
+    if (!parsed.isObject()) return criteria;
+    
+    auto toBoolFilter = [](const juce::var& v) {
+        int value = static_cast<int>(v);
+        return (value == Yes || value == No) ? static_cast<BoolFilter>(value) : DontCare;
+    };
+    
+    criteria.query = parsed.getProperty("query", "").toString();
+    criteria.rootNote = parsed.getProperty("rootNote", "").toString();
+    criteria.chordType = parsed.getProperty("chordType", "").toString();
+    criteria.hasExtensions = toBoolFilter(parsed.getProperty("hasExtensions", 0));
+    criteria.hasAlterations = toBoolFilter(parsed.getProperty("hasAlterations", 0));
+    criteria.minRating = static_cast<int>(parsed.getProperty("minRating", 0));
+    criteria.favoritesOnly = static_cast<bool>(parsed.getProperty("favoritesOnly", false));
+    criteria.tag = parsed.getProperty("tag", "").toString();
+    criteria.minDurationMs = static_cast<int>(parsed.getProperty("minDurationMs", 0));
+    criteria.maxDurationMs = static_cast<int>(parsed.getProperty("maxDurationMs", 0));
+    criteria.sampleRate = static_cast<int>(parsed.getProperty("sampleRate", 0));
+    criteria.channels = static_cast<int>(parsed.getProperty("channels", 0));
+    return criteria;
+}
+
+void ChopsDatabase::rowChangeHook(void* context, int operation, const char* databaseName,
+                                  const char* tableName, long long rowId)
+{
+    juce::ignoreUnused(databaseName);
+    // Deletes are handled by ON DELETE CASCADE on collection_samples
+    if (operation == SQLITE_DELETE || tableName == nullptr || strcmp(tableName, "samples") != 0) return;
+    static_cast<ChopsDatabase*>(context)->pendingSmartRefresh.add(static_cast<int>(rowId));
+}
+
+bool ChopsDatabase::ensureCollectionTables()
+{
+    if (db == nullptr) return false;
+    const char* sql = R"(
+        CREATE TABLE IF NOT EXISTS collections (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            name TEXT NOT NULL,
+            description TEXT,
+            is_smart INTEGER DEFAULT 0,
+            criteria TEXT,
+            date_created INTEGER
+        );
+        CREATE TABLE IF NOT EXISTS collection_samples (
+            collection_id INTEGER NOT NULL,
+            position INTEGER NOT NULL,
+            sample_id INTEGER NOT NULL,
+            PRIMARY KEY (collection_id, position),
+            UNIQUE (collection_id, sample_id),
+            FOREIGN KEY (collection_id) REFERENCES collections(id) ON DELETE CASCADE,
+            FOREIGN KEY (sample_id) REFERENCES samples(id) ON DELETE CASCADE
+        ) WITHOUT ROWID;
+        CREATE INDEX IF NOT EXISTS idx_collection_samples_sample ON collection_samples(sample_id);
+    )";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(static_cast<sqlite3*>(db), sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        juce::Logger::writeToLog("Failed to create collection tables: " + juce::String(errMsg ? errMsg : "unknown error"));
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+bool ChopsDatabase::ensureSampleColumns()
+{
+    if (db == nullptr) return false;
+    auto* handle = static_cast<sqlite3*>(db);
+    
+    // Columns added after the first release, in the order they were added
+    static const char* const addedColumns[][2] = {
+        { "content_hash",  "INTEGER" },
+        { "file_mtime_ms", "INTEGER" },
+        { "file_inode",    "INTEGER" },
+        { "file_device",   "INTEGER" },
+        { "file_synced_ms", "INTEGER" },
+        // In schema.sql from the start, but missing from databases the standalone app created
+        { "duration_ms",   "INTEGER" },
+        { "sample_rate",   "INTEGER" },
+        { "bit_depth",     "INTEGER" },
+        { "channels",      "INTEGER" },
+    };
+    
+    juce::StringArray existing;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, "SELECT name FROM pragma_table_info('samples')", -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+            existing.add(fromSqliteText(sqlite3_column_text(stmt, 0)));
+        sqlite3_finalize(stmt);
+    }
+    if (existing.isEmpty()) return false; // Schema not created yet; try again on the next open
+    
+    juce::String sql;
+    for (auto& column : addedColumns)
+        if (!existing.contains(column[0]))
+            sql << "ALTER TABLE samples ADD COLUMN " << column[0] << " " << column[1] << ";";
+    sql << "CREATE INDEX IF NOT EXISTS idx_samples_content_hash ON samples(content_hash);"
+        << "CREATE INDEX IF NOT EXISTS idx_samples_file_inode ON samples(file_inode, file_device);"
+        << "CREATE INDEX IF NOT EXISTS idx_samples_duration ON samples(duration_ms);"
+        << "CREATE INDEX IF NOT EXISTS idx_samples_format ON samples(sample_rate, bit_depth, channels);";
+    
+    char* errMsg = nullptr;
+    if (sqlite3_exec(handle, sql.toRawUTF8(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        juce::Logger::writeToLog("Failed to add sample columns: " + juce::String(errMsg ? errMsg : "unknown error"));
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+bool ChopsDatabase::migrateTimestamps()
+{
+    if (db == nullptr) return false;
+    auto* handle = static_cast<sqlite3*>(db);
+    
+    int userVersion = 0;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(handle, "PRAGMA user_version", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) userVersion = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+    if (userVersion >= 1) return true;
+    
+    // Text timestamps (CURRENT_TIMESTAMP or ISO 8601 with offset) become epoch milliseconds.
+    // The declared column types have numeric affinity, so integers are stored as integers.
+    juce::String sql = "BEGIN;";
+    auto convert = [&sql, handle](const char* table, const char* column) {
+        // The standalone app's fallback schema doesn't have every column
+        bool exists = false;
+        sqlite3_stmt* info;
+        if (sqlite3_prepare_v2(handle, "SELECT 1 FROM pragma_table_info(?) WHERE name = ?", -1, &info, nullptr) == SQLITE_OK) {
+            sqlite3_bind_text(info, 1, table, -1, SQLITE_STATIC);
+            sqlite3_bind_text(info, 2, column, -1, SQLITE_STATIC);
+            exists = sqlite3_step(info) == SQLITE_ROW;
+            sqlite3_finalize(info);
+        }
+        if (!exists) return;
+        sql << "UPDATE " << table << " SET " << column << " = CAST(ROUND((julianday(" << column
+            << ") - 2440587.5) * 86400000.0) AS INTEGER) WHERE typeof(" << column << ") = 'text';";
+    };
+    convert("samples", "date_added");
+    convert("samples", "date_modified");
+    convert("samples", "last_played");
+    convert("sample_tags", "date_added");
+    convert("collections", "date_created");
+    if (!sql.contains("UPDATE samples")) return false; // Schema not created yet; try again on the next open
+    sql << "PRAGMA user_version = 1; COMMIT;";
+    
+    char* errMsg = nullptr;
+    if (sqlite3_exec(handle, sql.toRawUTF8(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        juce::Logger::writeToLog("Timestamp migration failed: " + juce::String(errMsg ? errMsg : "unknown error"));
+        sqlite3_free(errMsg);
+        sqlite3_exec(handle, "ROLLBACK", nullptr, nullptr, nullptr);
+        return false;
+    }
+    
+    juce::Logger::writeToLog("Migrated timestamps to epoch milliseconds");
+    return true;
+}
+
+int ChopsDatabase::createCollection(const juce::String& name, const juce::String& description)
+{
+    if (db == nullptr || name.isEmpty()) return -1;
+    try {
+        const char* sql = "INSERT INTO collections (name, description, is_smart, date_created) VALUES (?, ?, 0, ?)";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return -1;
+        sqlite3_bind_text(stmt, 1, toStdString(name).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, toStdString(description).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 3, juce::Time::currentTimeMillis());
+        bool success = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        if (success) return static_cast<int>(sqlite3_last_insert_rowid(static_cast<sqlite3*>(db)));
+        juce::Logger::writeToLog("Error creating collection: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+    } catch (...) { juce::Logger::writeToLog("Error creating collection"); }
+    return -1;
+}
+
+int ChopsDatabase::createSmartCollection(const juce::String& name, const CollectionCriteria& criteria,
+                                         const juce::String& description)
+{
+    if (db == nullptr || name.isEmpty()) return -1;
+    int collectionId = -1;
+    try {
+        const char* sql = "INSERT INTO collections (name, description, is_smart, criteria, date_created) VALUES (?, ?, 1, ?, ?)";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return -1;
+        sqlite3_bind_text(stmt, 1, toStdString(name).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, toStdString(description).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, toStdString(criteria.toJson()).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 4, juce::Time::currentTimeMillis());
+        if (sqlite3_step(stmt) == SQLITE_DONE)
+            collectionId = static_cast<int>(sqlite3_last_insert_rowid(static_cast<sqlite3*>(db)));
+        sqlite3_finalize(stmt);
+    } catch (...) { juce::Logger::writeToLog("Error creating smart collection"); }
+    
+    if (collectionId > 0 && !rebuildSmartCollection(collectionId, criteria)) {
+        deleteCollection(collectionId);
+        return -1;
+    }
+    return collectionId;
+}
+
+bool ChopsDatabase::setSmartCollectionCriteria(int collectionId, const CollectionCriteria& criteria)
+{
+    if (db == nullptr) return false;
+    try {
+        const char* sql = "UPDATE collections SET criteria = ? WHERE id = ? AND is_smart = 1";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+        sqlite3_bind_text(stmt, 1, toStdString(criteria.toJson()).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, collectionId);
+        bool success = sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(static_cast<sqlite3*>(db)) > 0;
+        sqlite3_finalize(stmt);
+        return success && rebuildSmartCollection(collectionId, criteria);
+    } catch (...) { juce::Logger::writeToLog("Error updating smart collection criteria"); }
+    return false;
+}
+
+bool ChopsDatabase::rebuildSmartCollection(int collectionId, const CollectionCriteria& criteria)
+{
+    if (db == nullptr) return false;
+    bool ownsTransaction = sqlite3_get_autocommit(static_cast<sqlite3*>(db)) != 0;
+    if (ownsTransaction && !beginTransaction()) return false;
+    
+    bool success = false;
+    try {
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), "DELETE FROM collection_samples WHERE collection_id = ?",
+                               -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, collectionId);
+            success = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_finalize(stmt);
+        }
+        
+        juce::String sql = "INSERT INTO collection_samples (collection_id, position, sample_id) "
+                           "SELECT ?9, s.id, s.id FROM samples s WHERE " + juce::String(smartCriteriaWhere);
+        if (success && sqlite3_prepare_v2(static_cast<sqlite3*>(db), toStdString(sql).c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+            bindCriteria(stmt, criteria);
+            sqlite3_bind_int(stmt, 9, collectionId);
+            success = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_finalize(stmt);
+        } else {
+            success = false;
+        }
+    } catch (...) {
+        juce::Logger::writeToLog("Error rebuilding smart collection");
+        success = false;
+    }
+    
+    if (!success)
+        juce::Logger::writeToLog("Failed to rebuild smart collection " + juce::String(collectionId) + ": " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+    
+    if (ownsTransaction) {
+        if (success) success = commitTransaction();
+        else rollbackTransaction();
+    }
+    return success;
+}
+
+bool ChopsDatabase::deleteCollection(int collectionId)
+{
+    if (db == nullptr || collectionId <= 0) return false;
+    const char* sql = "DELETE FROM collections WHERE id = ?"; // Membership goes with it via ON DELETE CASCADE
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_int(stmt, 1, collectionId);
+    bool success = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+bool ChopsDatabase::addSamplesToCollection(int collectionId, const juce::Array<int>& sampleIds)
+{
+    if (db == nullptr || sampleIds.isEmpty()) return false;
+    try {
+        // New members are appended after the current last position, in the order given.
+        // Smart collections are excluded - their membership is owned by the criteria.
+        const char* sql = R"(
+            INSERT OR IGNORE INTO collection_samples (collection_id, position, sample_id)
+            SELECT c.id,
+                   (SELECT COALESCE(MAX(position), 0) FROM collection_samples WHERE collection_id = c.id) + j.key + 1,
+                   s.id
+            FROM collections c
+            JOIN json_each(?2) j
+            JOIN samples s ON s.id = j.value
+            WHERE c.id = ?1 AND c.is_smart = 0
+        )";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            juce::Logger::writeToLog("Error preparing addSamplesToCollection: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+            return false;
+        }
+        sqlite3_bind_int(stmt, 1, collectionId);
+        sqlite3_bind_text(stmt, 2, toStdString(idsToJson(sampleIds)).c_str(), -1, SQLITE_TRANSIENT);
+        bool success = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        return success;
+    } catch (...) { juce::Logger::writeToLog("Error adding samples to collection"); }
+    return false;
+}
+
+bool ChopsDatabase::removeSamplesFromCollection(int collectionId, const juce::Array<int>& sampleIds)
+{
+    if (db == nullptr || sampleIds.isEmpty()) return false;
+    try {
+        const char* sql = R"(
+            DELETE FROM collection_samples
+            WHERE collection_id = ?1
+            AND sample_id IN (SELECT value FROM json_each(?2))
+            AND (SELECT is_smart FROM collections WHERE id = ?1) = 0
+        )";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+        sqlite3_bind_int(stmt, 1, collectionId);
+        sqlite3_bind_text(stmt, 2, toStdString(idsToJson(sampleIds)).c_str(), -1, SQLITE_TRANSIENT);
+        bool success = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        return success;
+    } catch (...) { juce::Logger::writeToLog("Error removing samples from collection"); }
+    return false;
+}
+
+std::vector<ChopsDatabase::CollectionInfo> ChopsDatabase::getCollections()
+{
+    std::vector<CollectionInfo> collections;
+    if (db == nullptr) return collections;
+    try {
+        const char* sql = R"(
+            SELECT c.id, c.name, c.description, c.is_smart, c.criteria, c.date_created,
+                   (SELECT COUNT(*) FROM collection_samples cs WHERE cs.collection_id = c.id)
+            FROM collections c
+            ORDER BY c.name
+        )";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return collections;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            CollectionInfo info;
+            info.id = sqlite3_column_int(stmt, 0);
+            info.name = fromSqliteText(sqlite3_column_text(stmt, 1));
+            info.description = fromSqliteText(sqlite3_column_text(stmt, 2));
+            info.isSmart = sqlite3_column_int(stmt, 3) != 0;
+            if (info.isSmart) info.criteria = CollectionCriteria::fromJson(fromSqliteText(sqlite3_column_text(stmt, 4)));
+            if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) info.dateCreated = juce::Time(sqlite3_column_int64(stmt, 5));
+            info.sampleCount = sqlite3_column_int(stmt, 6);
+            collections.push_back(info);
+        }
+        sqlite3_finalize(stmt);
+    } catch (...) { juce::Logger::writeToLog("Error getting collections"); }
+    return collections;
+}
+
+juce::Array<int> ChopsDatabase::getCollectionSampleIds(int collectionId)
+{
+    juce::Array<int> ids;
+    if (db == nullptr) return ids;
+    try {
+        const char* sql = "SELECT sample_id FROM collection_samples WHERE collection_id = ? ORDER BY position";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql, -1, &stmt, nullptr) != SQLITE_OK) return ids;
+        sqlite3_bind_int(stmt, 1, collectionId);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            ids.add(sqlite3_column_int(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    } catch (...) { juce::Logger::writeToLog("Error getting collection sample ids"); }
+    return ids;
+}
+
+std::vector<ChopsDatabase::SampleInfo> ChopsDatabase::getCollectionSamples(int collectionId, int limit, int offset)
+{
+    std::vector<SampleInfo> results;
+    if (db == nullptr) return results;
+    try {
+        // Walks the (collection_id, position) primary key, so smart collections are not re-queried
+        const juce::String sql = "SELECT " + sampleColumnList() + R"(, GROUP_CONCAT(t.name, ',') as tag_list
+            FROM collection_samples cs
+            JOIN samples s ON s.id = cs.sample_id
+            LEFT JOIN sample_tags st ON s.id = st.sample_id
+            LEFT JOIN tags t ON st.tag_id = t.id
+            WHERE cs.collection_id = ?
+            GROUP BY cs.position
+            ORDER BY cs.position
+            LIMIT ? OFFSET ?
+        )";
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), sql.toRawUTF8(), -1, &stmt, nullptr) != SQLITE_OK) return results;
+        sqlite3_bind_int(stmt, 1, collectionId);
+        sqlite3_bind_int(stmt, 2, limit);
+        sqlite3_bind_int(stmt, 3, offset);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            results.push_back(parseRow(stmt));
+        }
+        sqlite3_finalize(stmt);
+    } catch (...) { juce::Logger::writeToLog("Error getting collection samples"); }
+    return results;
+}
+
+bool ChopsDatabase::refreshSmartCollections()
+{
+    if (db == nullptr || pendingSmartRefresh.isEmpty()) return true;
+    
+    juce::SortedSet<int> changedIds;
+    changedIds.swapWith(pendingSmartRefresh);
+    
+    std::vector<std::pair<int, CollectionCriteria>> smartCollections;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), "SELECT id, criteria FROM collections WHERE is_smart = 1",
+                           -1, &stmt, nullptr) != SQLITE_OK) return false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        smartCollections.emplace_back(sqlite3_column_int(stmt, 0),
+                                      CollectionCriteria::fromJson(fromSqliteText(sqlite3_column_text(stmt, 1))));
+    }
+    sqlite3_finalize(stmt);
+    if (smartCollections.empty()) return true;
+    
+    // Each changed row is dropped from every smart collection and re-inserted if it still
+    // matches. Position is the sample id, so re-insertion keeps the original order.
+    sqlite3_stmt* removeStmt = nullptr;
+    sqlite3_stmt* insertStmt = nullptr;
+    juce::String insertSql = "INSERT OR IGNORE INTO collection_samples (collection_id, position, sample_id) "
+                             "SELECT ?9, s.id, s.id FROM samples s WHERE s.id = ?10 AND " + juce::String(smartCriteriaWhere);
+    if (sqlite3_prepare_v2(static_cast<sqlite3*>(db), "DELETE FROM collection_samples WHERE collection_id = ? AND sample_id = ?",
+                           -1, &removeStmt, nullptr) != SQLITE_OK
+        || sqlite3_prepare_v2(static_cast<sqlite3*>(db), toStdString(insertSql).c_str(), -1, &insertStmt, nullptr) != SQLITE_OK) {
+        juce::Logger::writeToLog("Error preparing smart collection refresh: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+        sqlite3_finalize(removeStmt);
+        sqlite3_finalize(insertStmt);
+        return false;
+    }
+    
+    bool ownsTransaction = sqlite3_get_autocommit(static_cast<sqlite3*>(db)) != 0;
+    if (ownsTransaction) beginTransaction();
+    
+    bool success = true;
+    try {
+        for (const auto& [collectionId, criteria] : smartCollections) {
+            bindCriteria(insertStmt, criteria);
+            sqlite3_bind_int(insertStmt, 9, collectionId);
+            sqlite3_bind_int(removeStmt, 1, collectionId);
+            
+            for (int sampleId : changedIds) {
+                sqlite3_bind_int(removeStmt, 2, sampleId);
+                sqlite3_bind_int(insertStmt, 10, sampleId);
+                if (sqlite3_step(removeStmt) != SQLITE_DONE || sqlite3_step(insertStmt) != SQLITE_DONE) success = false;
+                sqlite3_reset(removeStmt);
+                sqlite3_reset(insertStmt);
+            }
+        }
+    } catch (...) {
+        juce::Logger::writeToLog("Error refreshing smart collections");
+        success = false;
+    }
+    
+    sqlite3_finalize(removeStmt);
+    sqlite3_finalize(insertStmt);
+    
+    if (ownsTransaction) {
+        if (success) success = commitTransaction();
+        else rollbackTransaction();
+    }
+    if (!success) {
+        juce::Logger::writeToLog("Smart collection refresh failed, will retry on next write");
+        for (int sampleId : changedIds) pendingSmartRefresh.add(sampleId);
+    }
+    return success;
+}
+
 //==============================================================================
 // Transaction support
 bool ChopsDatabase::beginTransaction() { /* ... unchanged ... */ return db && sqlite3_exec(static_cast<sqlite3*>(db), "BEGIN TRANSACTION", nullptr, nullptr, nullptr) == SQLITE_OK; }
@@ -849,6 +1813,290 @@ bool ChopsDatabase::analyze() { /* ... unchanged, but add try-catch ... */
     return false;
 }
 
+ChopsDatabase::CheckpointResult ChopsDatabase::checkpoint()
+{
+    CheckpointResult result;
+    if (db == nullptr) return result;
+    
+    int rc = sqlite3_wal_checkpoint_v2(static_cast<sqlite3*>(db), nullptr, SQLITE_CHECKPOINT_PASSIVE,
+                                       &result.walFrames, &result.checkpointedFrames);
+    result.ok = rc == SQLITE_OK;
+    if (!result.ok && rc != SQLITE_BUSY)
+        juce::Logger::writeToLog("WAL checkpoint failed: " + juce::String(sqlite3_errmsg(static_cast<sqlite3*>(db))));
+    return result;
+}
+
+void ChopsDatabase::setAutoCheckpoint(int pages)
+{
+    if (db != nullptr)
+        sqlite3_wal_autocheckpoint(static_cast<sqlite3*>(db), juce::jmax(0, pages));
+}
+
+juce::int64 ChopsDatabase::getDataVersion()
+{
+    if (db == nullptr) return -1;
+    auto* handle = static_cast<sqlite3*>(db);
+    
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(handle, "PRAGMA data_version", -1, &stmt, nullptr) != SQLITE_OK) return -1;
+    
+    juce::int64 version = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+bool ChopsDatabase::runWithBudget(const juce::String& sql, double budgetMs, juce::StringArray* rows)
+{
+    if (db == nullptr) return false;
+    auto* handle = static_cast<sqlite3*>(db);
+    
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(handle, sql.toRawUTF8(), -1, &stmt, nullptr) != SQLITE_OK) {
+        juce::Logger::writeToLog("Failed to prepare '" + sql + "': " + juce::String(sqlite3_errmsg(handle)));
+        return false;
+    }
+    
+    // The progress handler runs every 1000 VM instructions; a non-zero return interrupts
+    double deadline = juce::Time::getMillisecondCounterHiRes() + budgetMs;
+    sqlite3_progress_handler(handle, 1000, [](void* context) -> int {
+        return juce::Time::getMillisecondCounterHiRes() > *static_cast<double*>(context) ? 1 : 0;
+    }, &deadline);
+    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+        if (rows != nullptr)
+            rows->add(fromSqliteText(sqlite3_column_text(stmt, 0)));
+    
+    sqlite3_progress_handler(handle, 0, nullptr, nullptr);
+    sqlite3_finalize(stmt);
+    
+    if (rc == SQLITE_DONE)
+        return true;
+    if (rc != SQLITE_INTERRUPT)
+        juce::Logger::writeToLog("'" + sql + "' failed: " + juce::String(sqlite3_errmsg(handle)));
+    return false;
+}
+
+void ChopsDatabase::releaseReadLocks()
+{
+    if (db == nullptr) return;
+    auto* handle = static_cast<sqlite3*>(db);
+    if (sqlite3_get_autocommit(handle) == 0) return; // Inside an explicit transaction
+    
+    for (auto* stmt = sqlite3_next_stmt(handle, nullptr); stmt != nullptr; stmt = sqlite3_next_stmt(handle, stmt))
+        if (sqlite3_stmt_busy(stmt))
+            sqlite3_reset(stmt);
+}
+
+void ChopsDatabase::interrupt()
+{
+    if (db != nullptr)
+        sqlite3_interrupt(static_cast<sqlite3*>(db));
+}
+
+void ChopsDatabase::setTraceCallback(TraceCallback callback)
+{
+    traceCallback = std::move(callback);
+    installTraceHook();
+}
+
+void ChopsDatabase::installTraceHook()
+{
+    if (db == nullptr) return;
+    
+    // Statement timing is always on; row tracing costs a callback and a lock per row returned
+    unsigned mask = SQLITE_TRACE_PROFILE;
+    if (profile->countRows)
+        mask |= SQLITE_TRACE_ROW;
+    sqlite3_trace_v2(static_cast<sqlite3*>(db), mask, &ChopsDatabase::traceHook, this);
+}
+
+int ChopsDatabase::traceHook(unsigned type, void* context, void* stmtPtr, void* detail)
+{
+    auto* self = static_cast<ChopsDatabase*>(context);
+    auto* stmt = static_cast<sqlite3_stmt*>(stmtPtr);
+    if (self->profile->suspended.load(std::memory_order_relaxed))
+        return 0;
+    
+    if (type == SQLITE_TRACE_ROW) {
+        self->profile->countRow(stmt);
+        return 0;
+    }
+    
+    if (type != SQLITE_TRACE_PROFILE)
+        return 0;
+    
+    const char* sql = sqlite3_sql(stmt);
+    if (sql == nullptr) sql = "";
+    double ms = static_cast<double>(*static_cast<sqlite3_int64*>(detail)) / 1.0e6;
+    
+    if (self->profile->record(stmt, sql, ms))
+        juce::Logger::writeToLog("Slow query (" + juce::String(ms, 1) + " ms): " + singleLineSql(juce::String::fromUTF8(sql)));
+    
+    if (self->traceCallback)
+        self->traceCallback(juce::String::fromUTF8(sql), ms);
+    return 0;
+}
+
+//==============================================================================
+// Profiling
+ChopsDatabase::Profile ChopsDatabase::getProfile()
+{
+    Profile result;
+    std::vector<size_t> needPlans;
+    
+    {
+        const juce::ScopedLock sl(profile->lock);
+        result.slowQueryThresholdMs = profile->slowQueryThresholdMs;
+        result.rowsCounted = profile->countRows;
+        
+        for (const auto& [hash, entry] : profile->statements) {
+            StatementProfile stats;
+            stats.sql = entry.sql;
+            stats.calls = entry.calls;
+            stats.totalMs = entry.totalMs;
+            stats.maxMs = entry.maxMs;
+            stats.rowsReturned = entry.rowsReturned;
+            stats.fullScanSteps = entry.fullScanSteps;
+            stats.virtualMachineSteps = entry.virtualMachineSteps;
+            stats.sorts = entry.sorts;
+            stats.autoIndexes = entry.autoIndexes;
+            
+            auto window = (size_t) juce::jmin(entry.calls, (int64) ProfileState::latencyWindow);
+            std::vector<float> recent(entry.recentMs.begin(), entry.recentMs.begin() + (std::ptrdiff_t) window);
+            if (!recent.empty()) {
+                auto rank = (size_t) std::ceil(0.99 * (double) recent.size()) - 1;
+                std::nth_element(recent.begin(), recent.begin() + (std::ptrdiff_t) rank, recent.end());
+                stats.p99Ms = recent[rank];
+            }
+            result.statements.push_back(std::move(stats));
+        }
+        
+        result.slowQueries.assign(profile->slowQueries.begin(), profile->slowQueries.end());
+        for (size_t i = 0; i < result.slowQueries.size(); ++i)
+            if (result.slowQueries[i].queryPlan.isEmpty())
+                needPlans.push_back(i);
+    }
+    
+    std::sort(result.statements.begin(), result.statements.end(),
+              [](const StatementProfile& a, const StatementProfile& b) { return a.totalMs > b.totalMs; });
+    
+    if (db == nullptr)
+        return result;
+    
+    auto* handle = static_cast<sqlite3*>(db);
+    
+    // Plans are captured here rather than in the trace hook, which mustn't run statements
+    if (!needPlans.empty()) {
+        profile->suspended = true;
+        for (auto index : needPlans) {
+            auto& slow = result.slowQueries[index];
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(handle, ("EXPLAIN QUERY PLAN " + slow.sql).toRawUTF8(), -1, &stmt, nullptr) != SQLITE_OK) {
+                slow.queryPlan = "(plan unavailable: " + juce::String(sqlite3_errmsg(handle)) + ")";
+                continue;
+            }
+            
+            std::map<int, int> depthById;
+            juce::StringArray lines;
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                auto depth = depthById[sqlite3_column_int(stmt, 1)] + 1;
+                depthById[sqlite3_column_int(stmt, 0)] = depth;
+                lines.add(juce::String::repeatedString("  ", depth - 1) + fromSqliteText(sqlite3_column_text(stmt, 3)));
+            }
+            sqlite3_finalize(stmt);
+            slow.queryPlan = lines.joinIntoString("\n");
+        }
+        profile->suspended = false;
+        
+        // Store the plans so each statement is only explained once
+        const juce::ScopedLock sl(profile->lock);
+        for (auto index : needPlans)
+            for (auto& stored : profile->slowQueries)
+                if (stored.when == result.slowQueries[index].when && stored.sql == result.slowQueries[index].sql)
+                    stored.queryPlan = result.slowQueries[index].queryPlan;
+    }
+    
+    int current = 0, highwater = 0;
+    if (sqlite3_db_status(handle, SQLITE_DBSTATUS_CACHE_HIT, &current, &highwater, 0) == SQLITE_OK)
+        result.cacheHits = current;
+    if (sqlite3_db_status(handle, SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 0) == SQLITE_OK)
+        result.cacheMisses = current;
+    if (sqlite3_db_status(handle, SQLITE_DBSTATUS_CACHE_USED, &current, &highwater, 0) == SQLITE_OK)
+        result.cacheBytes = current;
+    
+    auto lookups = result.cacheHits + result.cacheMisses;
+    result.cacheHitRatio = lookups > 0 ? (double) result.cacheHits / (double) lookups : 0.0;
+    
+    const char* filename = sqlite3_db_filename(handle, "main");
+    if (filename != nullptr && *filename != 0) {
+        juce::File wal(juce::String::fromUTF8(filename) + "-wal");
+        result.walBytes = wal.existsAsFile() ? wal.getSize() : 0;
+    }
+    
+    return result;
+}
+
+void ChopsDatabase::resetProfile()
+{
+    {
+        const juce::ScopedLock sl(profile->lock);
+        profile->statements.clear();
+        profile->slowQueries.clear();
+    }
+    
+    if (db != nullptr) {
+        int current = 0, highwater = 0;
+        sqlite3_db_status(static_cast<sqlite3*>(db), SQLITE_DBSTATUS_CACHE_HIT, &current, &highwater, 1);
+        sqlite3_db_status(static_cast<sqlite3*>(db), SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 1);
+    }
+}
+
+void ChopsDatabase::setSlowQueryThreshold(double milliseconds)
+{
+    const juce::ScopedLock sl(profile->lock);
+    profile->slowQueryThresholdMs = milliseconds;
+}
+
+void ChopsDatabase::setRowCountingEnabled(bool shouldCountRows)
+{
+    if (profile->countRows == shouldCountRows) return;
+    profile->countRows = shouldCountRows;
+    profile->forgetPendingRows();
+    installTraceHook();
+}
+
+juce::String ChopsDatabase::Profile::toString(int maxStatements) const
+{
+    auto megabytes = [](int64 bytes) { return juce::String::formatted("%.2f MB", (double) bytes / (1024.0 * 1024.0)); };
+    
+    juce::String text;
+    text << "Page cache: " << cacheHits << " hits, " << cacheMisses << " misses ("
+         << juce::String(cacheHitRatio * 100.0, 1) << "%), " << megabytes(cacheBytes) << "\n";
+    text << "WAL size: " << megabytes(walBytes) << "\n";
+    
+    text << "Statements by total time:\n";
+    for (size_t i = 0; i < statements.size() && (int) i < maxStatements; ++i) {
+        const auto& s = statements[i];
+        text << "  " << s.calls << "x, " << juce::String(s.totalMs, 1) << " ms total, p99 "
+             << juce::String(s.p99Ms, 2) << " ms, max " << juce::String(s.maxMs, 2) << " ms, "
+             << (rowsCounted ? juce::String(s.rowsReturned) + " rows, " : juce::String()) << s.fullScanSteps << " scanned"
+             << (s.sorts > 0 ? ", sorts" : "") << (s.autoIndexes > 0 ? ", auto-index" : "")
+             << ": " << singleLineSql(s.sql) << "\n";
+    }
+    
+    if (slowQueryThresholdMs > 0.0) {
+        text << "Slow queries (>= " << juce::String(slowQueryThresholdMs, 0) << " ms): " << (int) slowQueries.size() << "\n";
+        for (const auto& slow : slowQueries) {
+            text << "  " << slow.when.toString(false, true, true, true) << "  " << juce::String(slow.milliseconds, 1)
+                 << " ms: " << singleLineSql(slow.sql) << "\n";
+            for (const auto& line : juce::StringArray::fromLines(slow.queryPlan))
+                text << "      " << line << "\n";
+        }
+    }
+    return text;
+}
+
 juce::String ChopsDatabase::getDatabaseInfo()
 {
     // ... (implementation from previous correct version, ensure sqlite3_prepare_v2 checks results) ...
@@ -871,6 +2119,7 @@ juce::String ChopsDatabase::getDatabaseInfo()
         auto statsData = getStatistics(); // Renamed to avoid conflict with struct name
         info += "Total Samples: " + juce::String(statsData.totalSamples) + "\n";
         info += "Total Tags: " + juce::String(getAllTags().size()) + "\n"; // Can be slow if many tags
+        info += getProfile().toString(5);
     } catch (...) { info += "Error retrieving some database info.\n"; }
     return info;
 }
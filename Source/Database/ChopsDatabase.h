@@ -3,6 +3,9 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <memory>
+#include <functional>
+
+class ResultSet;
 
 class ChopsDatabase
 {
@@ -21,6 +24,13 @@ public:
         juce::String currentFilename;
         juce::String filePath;
         int64 fileSize = 0;
+        juce::uint64 contentHash = 0; // Of the audio data (ContentHash::ofAudioData); 0 if unknown
+        
+        // From the file header (AudioHeaderProbe); 0 if unknown
+        int durationMs = 0;
+        int sampleRate = 0;
+        int bitDepth = 0;
+        int channels = 0;
         
         juce::String rootNote;
         juce::String chordType;
@@ -51,20 +61,45 @@ public:
     
     enum BoolFilter { DontCare, Yes, No };
     
-    // Search and retrieval
-    std::vector<SampleInfo> searchSamples(
+    // Audio format bounds for searches; 0 leaves a field unconstrained
+    struct FormatFilter
+    {
+        // Spelt out rather than member initialisers so it can be a default argument below
+        FormatFilter() noexcept : minDurationMs(0), maxDurationMs(0), sampleRate(0), channels(0) {}
+        
+        int minDurationMs, maxDurationMs;
+        int sampleRate;
+        int channels;
+        
+        // For in-memory rows. 0 means not probed yet and, like a NULL column, fails any bound
+        bool matches(int durationMs, int rate, int numChannels) const
+        {
+            return (minDurationMs == 0 || durationMs >= minDurationMs)
+                && (maxDurationMs == 0 || (durationMs > 0 && durationMs <= maxDurationMs))
+                && (sampleRate == 0 || rate == sampleRate)
+                && (channels == 0 || numChannels == channels);
+        }
+    };
+    
+    // Search and retrieval. Rows come back compact; see ResultSet.h
+    ResultSet searchSamples(
         const juce::String& query = "",
         const juce::String& rootNote = "",
         const juce::String& chordType = "",
         BoolFilter hasExtensions = DontCare,
         BoolFilter hasAlterations = DontCare,
         int limit = 100,
-        int offset = 0
+        int offset = 0,
+        const FormatFilter& format = {}
     );
     
     std::unique_ptr<SampleInfo> getSampleByPath(const juce::String& filePath);
     std::unique_ptr<SampleInfo> getSampleById(int sampleId);
     
+    // Single indexed lookup used at ingest; returns the IDs of every sample with identical
+    // audio data, oldest first. Some may be rows whose file has since gone.
+    juce::Array<int> findSampleIdsByContentHash(juce::uint64 contentHash);
+    
     // Sample management
     int insertSample(const SampleInfo& sample);
     bool updateSample(const SampleInfo& sample);
@@ -80,6 +115,41 @@ public:
     bool incrementPlayCount(int sampleId);
     bool setNotes(int sampleId, const juce::String& notes);
     
+    // File stamps: what a sample's file looked like when it was last synced, so a
+    // re-scan can skip files that haven't changed and follow renames by inode
+    struct FileStamp
+    {
+        juce::int64 size = 0;
+        juce::int64 modifiedMs = 0;
+        juce::int64 inode = 0, device = 0;  // 0 where the platform doesn't provide them
+        
+        bool hasInode() const { return inode != 0; }
+        bool operator==(const FileStamp& other) const
+        {
+            return size == other.size && modifiedMs == other.modifiedMs
+                && inode == other.inode && device == other.device;
+        }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+    
+    struct StampedFile
+    {
+        int sampleId = 0;
+        juce::String filePath;
+        FileStamp stamp;                    // All zero until the first stamped sync
+        juce::int64 syncedMs = 0;           // When the stamp was taken
+        juce::int64 dateModifiedMs = 0;     // Of the row; later than syncedMs means an edit since
+        bool hasAudioFormat = false;        // Header probed; rows from before that need one more pass
+    };
+    
+    // Every sample's path and stamp, in one query
+    std::vector<StampedFile> getFileStamps();
+    bool setFileStamp(int sampleId, const FileStamp& stamp); // Also records the sync time
+    // For a file that was renamed or moved on disk: updates path, current filename and stamp
+    bool moveSampleFile(int sampleId, const juce::String& newFilePath, const FileStamp& stamp);
+    // Header facts only; unlike updateSample this doesn't count as an edit (date_modified is kept)
+    bool setAudioFormat(int sampleId, int durationMs, int sampleRate, int bitDepth, int channels);
+    
     // Tag management
     juce::StringArray getTags(int sampleId);
     juce::StringArray getAllTags();
@@ -114,6 +184,56 @@ public:
     juce::StringArray getDistinctRootNotes();
     juce::StringArray getDistinctChordTypes();
     
+    // Collections
+    // Manual collections keep an explicit, ordered membership list. Smart collections store
+    // their criteria and keep a materialized membership that is refreshed incrementally as
+    // sample rows change, so opening one is a range read on collection_samples.
+    struct CollectionCriteria
+    {
+        juce::String query;
+        juce::String rootNote;
+        juce::String chordType;
+        BoolFilter hasExtensions = DontCare;
+        BoolFilter hasAlterations = DontCare;
+        int minRating = 0;
+        bool favoritesOnly = false;
+        juce::String tag;
+        int minDurationMs = 0;      // 0 = no bound
+        int maxDurationMs = 0;
+        int sampleRate = 0;         // 0 = any
+        int channels = 0;
+        
+        juce::String toJson() const;
+        static CollectionCriteria fromJson(const juce::String& json);
+    };
+    
+    struct CollectionInfo
+    {
+        int id = 0;
+        juce::String name;
+        juce::String description;
+        bool isSmart = false;
+        CollectionCriteria criteria;
+        int sampleCount = 0;
+        juce::Time dateCreated;
+    };
+    
+    int createCollection(const juce::String& name, const juce::String& description = "");
+    int createSmartCollection(const juce::String& name, const CollectionCriteria& criteria,
+                              const juce::String& description = "");
+    bool setSmartCollectionCriteria(int collectionId, const CollectionCriteria& criteria);
+    bool deleteCollection(int collectionId);
+    
+    bool addSamplesToCollection(int collectionId, const juce::Array<int>& sampleIds);
+    bool removeSamplesFromCollection(int collectionId, const juce::Array<int>& sampleIds);
+    
+    std::vector<CollectionInfo> getCollections();
+    juce::Array<int> getCollectionSampleIds(int collectionId);
+    std::vector<SampleInfo> getCollectionSamples(int collectionId, int limit = -1, int offset = 0);
+    
+    // Applies sample rows changed since the last call to every smart collection
+    bool refreshSmartCollections();
+    
     // Transaction support
     bool beginTransaction();
     bool commitTransaction();
@@ -123,6 +243,84 @@ public:
     bool vacuum();
     bool analyze();
     juce::String getDatabaseInfo();
+    
+    // Primitives for DatabaseMaintenance. checkpoint() is passive: it copies what it can
+    // from the WAL without waiting on readers or writers.
+    struct CheckpointResult
+    {
+        bool ok = false;
+        int walFrames = 0;
+        int checkpointedFrames = 0;
+    };
+    CheckpointResult checkpoint();
+    void setAutoCheckpoint(int pages); // 0 disables SQLite's commit-time checkpoints
+    // Changes whenever another connection, in this process or any other, commits to the
+    // database. Only comparable between calls on the same open connection; -1 if closed.
+    juce::int64 getDataVersion();
+    
+    // Runs one statement, collecting the first column of each row, and abandons it once
+    // budgetMs has passed. Returns false on error or if the budget ran out.
+    bool runWithBudget(const juce::String& sql, double budgetMs, juce::StringArray* rows = nullptr);
+    
+    // Resets statements left mid-step, so an idle connection doesn't pin an old WAL
+    // snapshot and hold back checkpoints. Only call between queries.
+    void releaseReadLocks();
+    
+    // Aborts whatever statement is running on this connection; safe to call from any
+    // thread while the database is open. The interrupted query returns partial results.
+    void interrupt();
+    
+    // Called after every statement completes with its SQL text (parameters unexpanded)
+    // and wall time. Used by the benchmark to collect query plans; pass nullptr to disable.
+    using TraceCallback = std::function<void(const juce::String& sql, double milliseconds)>;
+    void setTraceCallback(TraceCallback callback);
+    
+    // Profiling. Every statement run on this connection is timed and counted, keyed by
+    // its SQL text (SQLite times statements to the millisecond). Statements slower than the
+    // threshold are kept (last 50) with their bound parameters; their query plans are
+    // captured when the profile is read. Counting returned rows means a callback per row,
+    // so it is off unless setRowCountingEnabled() turns it on.
+    struct StatementProfile
+    {
+        juce::String sql;
+        int64 calls = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+        double p99Ms = 0.0;            // Over the most recent calls
+        int64 rowsReturned = 0;        // Only while row counting is enabled
+        int64 fullScanSteps = 0;       // Rows stepped in full table scans
+        int64 virtualMachineSteps = 0;
+        int64 sorts = 0;
+        int64 autoIndexes = 0;
+    };
+    
+    struct SlowQuery
+    {
+        juce::String sql;              // With parameters expanded
+        double milliseconds = 0.0;
+        juce::Time when;
+        juce::String queryPlan;
+    };
+    
+    struct Profile
+    {
+        std::vector<StatementProfile> statements; // Most total time first
+        std::vector<SlowQuery> slowQueries;       // Oldest first
+        int64 cacheHits = 0;
+        int64 cacheMisses = 0;
+        double cacheHitRatio = 0.0;
+        int64 cacheBytes = 0;
+        int64 walBytes = 0;
+        double slowQueryThresholdMs = 0.0;
+        bool rowsCounted = false;
+        
+        juce::String toString(int maxStatements = 10) const;
+    };
+    
+    Profile getProfile();
+    void resetProfile();
+    void setSlowQueryThreshold(double milliseconds); // <= 0 disables the slow-query log
+    void setRowCountingEnabled(bool shouldCountRows);
 
 private:
     void* db;
@@ -133,9 +331,38 @@ private:
     void prepareStatements();
     void finalizeStatements();
     
+    TraceCallback traceCallback;
+    void installTraceHook();
+    
+    struct ProfileState;
+    std::unique_ptr<ProfileState> profile;
+    static int traceHook(unsigned type, void* context, void* stmt, void* detail);
+    
+    // Sample ids touched since the last refreshSmartCollections(), fed by the update hook
+    juce::SortedSet<int> pendingSmartRefresh;
+    static void rowChangeHook(void* context, int operation, const char* databaseName,
+                              const char* tableName, long long rowId);
+    bool ensureCollectionTables();
+    bool rebuildSmartCollection(int collectionId, const CollectionCriteria& criteria);
+    
+    // Timestamps are stored as integer milliseconds since the Unix epoch (UTC);
+    // converts databases written with text timestamps. Gated on PRAGMA user_version.
+    bool migrateTimestamps();
+    // Adds newer samples columns (content hash, file stamps) and their indexes to older libraries
+    bool ensureSampleColumns();
+    
+    // Compile-time table mapping SELECT columns onto SampleInfo fields (see the .cpp)
+    struct SampleRowMapping;
+    static const juce::String& sampleColumnList();
+    
     SampleInfo parseRow(void* stmt);
-    juce::StringArray parseJsonArray(const juce::String& json);
-    juce::String stringArrayToJson(const juce::StringArray& array);
+    // Decodes the current row straight into the set's arena; false if a filter rejected it
+    static bool appendCompactRow(void* stmt, ResultSet& results, BoolFilter hasExtensions, BoolFilter hasAlterations);
+    friend class ResultSet;
+    static juce::StringArray parseJsonArray(const juce::String& json);
+    static juce::String stringArrayToJson(const juce::StringArray& array);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChopsDatabase)
-};
\ No newline at end of file
+};
+
+#include "ResultSet.h"
@@ -0,0 +1,290 @@
+#include "DatabaseMaintenance.h"
+
+DatabaseMaintenance::DatabaseMaintenance() : juce::Thread("ChopsMaintenance")
+{
+}
+
+DatabaseMaintenance::~DatabaseMaintenance()
+{
+    signalThreadShouldExit();
+    {
+        const juce::ScopedLock cl(connectionLock);
+        database.interrupt();
+    }
+    notify();
+    stopThread(4000);
+
+    const juce::ScopedLock cl(connectionLock);
+    database.close();
+}
+
+//==============================================================================
+void DatabaseMaintenance::setDatabase(const juce::File& newDatabaseFile)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        databaseFile = newDatabaseFile;
+        reopenRequested = true;
+    }
+
+    noteActivity();
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+
+    notify();
+}
+
+void DatabaseMaintenance::setSettings(const Settings& newSettings)
+{
+    const juce::ScopedLock sl(lock);
+    settings = newSettings;
+}
+
+DatabaseMaintenance::Settings DatabaseMaintenance::getSettings() const
+{
+    const juce::ScopedLock sl(lock);
+    return settings;
+}
+
+void DatabaseMaintenance::noteActivity()
+{
+    lastActivity = juce::Time::getMillisecondCounterHiRes();
+
+    // Give the write lock back straight away rather than at the end of the budget
+    if (taskRunning.load())
+    {
+        const juce::ScopedLock cl(connectionLock);
+        database.interrupt();
+    }
+}
+
+DatabaseMaintenance::Report DatabaseMaintenance::getReport() const
+{
+    const juce::ScopedLock sl(lock);
+    return report;
+}
+
+juce::String DatabaseMaintenance::Report::toString() const
+{
+    juce::String text;
+    text << "Maintenance: " << passes << " passes";
+    if (passes > 0)
+        text << ", last " << lastPass.toString(false, true, true, true);
+    text << "\n";
+    text << "  Checkpoints: " << checkpoints << " (" << walFramesPending << " WAL frames pending)\n";
+    text << "  Optimize runs: " << optimizeRuns << ", pages vacuumed: " << pagesVacuumed << "\n";
+    text << "  Tables checked: " << tablesChecked << ", problems: " << integrityProblems
+         << ", over budget: " << budgetOverruns << "\n";
+    if (lastProblem.isNotEmpty())
+        text << "  Last problem: " << lastProblem << "\n";
+    return text;
+}
+
+//==============================================================================
+void DatabaseMaintenance::run()
+{
+    while (!threadShouldExit())
+    {
+        bool reopen;
+        int idleDelayMs;
+        {
+            const juce::ScopedLock sl(lock);
+            reopen = std::exchange(reopenRequested, false);
+            idleDelayMs = settings.idleDelayMs;
+        }
+
+        if (reopen)
+            reopenConnection();
+
+        auto idleFor = juce::Time::getMillisecondCounterHiRes() - lastActivity.load();
+        if (database.isOpen() && idleFor >= idleDelayMs)
+            runPass();
+
+        wait(1000);
+    }
+
+    // SQLite recommends a last optimize before closing long-lived connections
+    if (database.isOpen())
+        database.runWithBudget("PRAGMA optimize", 100.0);
+}
+
+void DatabaseMaintenance::reopenConnection()
+{
+    juce::File file;
+    {
+        const juce::ScopedLock sl(lock);
+        file = databaseFile;
+    }
+
+    const juce::ScopedLock cl(connectionLock);
+    database.close();
+    tables.clear();
+    tableBudgets.clear();
+    nextTable = 0;
+    warnedAboutPinnedWal = false;
+    lastWalFrames = lastCheckpointedFrames = -1;
+    lastCheckpoint = lastOptimize = lastVacuum = lastIntegrityCheck = 0.0;
+
+    if (file == juce::File() || !file.existsAsFile())
+        return;
+
+    if (!database.open(file.getFullPathName()))
+    {
+        juce::Logger::writeToLog("Maintenance: Failed to open " + file.getFullPathName());
+        return;
+    }
+
+    // Our optimize/vacuum commits shouldn't turn into a checkpoint outside the idle window
+    database.setAutoCheckpoint(0);
+    database.runWithBudget("SELECT name FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%' ORDER BY name",
+                           1000.0, &tables);
+}
+
+void DatabaseMaintenance::runPass()
+{
+    Settings current;
+    {
+        const juce::ScopedLock sl(lock);
+        current = settings;
+    }
+
+    auto passStartedAfter = lastActivity.load();
+    auto interrupted = [this, passStartedAfter] {
+        return threadShouldExit() || lastActivity.load() != passStartedAfter;
+    };
+    auto due = [](double last, int intervalMs) {
+        return last == 0.0 || juce::Time::getMillisecondCounterHiRes() - last >= intervalMs;
+    };
+
+    bool didWork = false;
+
+    if (due(lastCheckpoint, current.checkpointIntervalMs))
+    {
+        lastCheckpoint = juce::Time::getMillisecondCounterHiRes();
+        auto result = database.checkpoint();
+        // A WAL that was already copied reports the same counts until a writer resets it
+        bool newFrames = result.walFrames != lastWalFrames || result.checkpointedFrames != lastCheckpointedFrames;
+        lastWalFrames = result.walFrames;
+        lastCheckpointedFrames = result.checkpointedFrames;
+
+        if (result.ok && result.walFrames > 0 && newFrames)
+        {
+            didWork = true;
+
+            const juce::ScopedLock sl(lock);
+            ++report.checkpoints;
+            report.walFramesPending = result.walFrames - result.checkpointedFrames;
+        }
+
+        // A connection still inside a read transaction keeps these frames from being copied
+        if (result.ok && result.walFrames > result.checkpointedFrames && result.walFrames > current.autoCheckpointPages)
+        {
+            if (!std::exchange(warnedAboutPinnedWal, true))
+                juce::Logger::writeToLog("Maintenance: WAL checkpoint held back by an open read transaction ("
+                                         + juce::String(result.walFrames - result.checkpointedFrames) + " frames)");
+        }
+        else
+        {
+            warnedAboutPinnedWal = false;
+        }
+    }
+
+    if (!interrupted() && due(lastOptimize, current.optimizeIntervalMs))
+    {
+        lastOptimize = juce::Time::getMillisecondCounterHiRes();
+        // analysis_limit keeps any ANALYZE that optimize decides to run approximate and quick
+        database.runWithBudget("PRAGMA analysis_limit = 400", current.budgetMs);
+        if (runTask("PRAGMA optimize", current.budgetMs))
+        {
+            didWork = true;
+            const juce::ScopedLock sl(lock);
+            ++report.optimizeRuns;
+        }
+    }
+
+    if (!interrupted() && due(lastVacuum, current.vacuumIntervalMs))
+    {
+        lastVacuum = juce::Time::getMillisecondCounterHiRes();
+        // Only libraries created with auto_vacuum = INCREMENTAL can give pages back this way
+        auto freePages = queryInt("PRAGMA freelist_count");
+        if (queryInt("PRAGMA auto_vacuum") == 2 && freePages >= current.freePagesBeforeVacuum)
+        {
+            runTask("PRAGMA incremental_vacuum(" + juce::String(current.vacuumPagesPerPass) + ")", current.budgetMs);
+            auto freed = freePages - queryInt("PRAGMA freelist_count");
+            if (freed > 0)
+            {
+                didWork = true;
+                const juce::ScopedLock sl(lock);
+                report.pagesVacuumed += freed;
+            }
+        }
+    }
+
+    if (!interrupted() && !tables.isEmpty() && due(lastIntegrityCheck, current.integrityCheckIntervalMs))
+    {
+        checkNextTable();
+        didWork = true;
+    }
+
+    if (didWork)
+    {
+        const juce::ScopedLock sl(lock);
+        ++report.passes;
+        report.lastPass = juce::Time::getCurrentTime();
+    }
+}
+
+void DatabaseMaintenance::checkNextTable()
+{
+    auto table = tables[nextTable];
+    auto budget = tableBudgets.count(table) > 0 ? tableBudgets[table] : getSettings().budgetMs;
+
+    juce::StringArray problems;
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    bool finished = runTask("PRAGMA integrity_check(\"" + table.replace("\"", "\"\"") + "\")", budget, &problems);
+    auto elapsed = juce::Time::getMillisecondCounterHiRes() - startTime;
+
+    if (!finished)
+    {
+        // Interrupted by activity: retry at the next idle pass. Out of time: retry the same
+        // table next interval with a bigger budget, up to a limit.
+        if (elapsed >= budget)
+        {
+            lastIntegrityCheck = juce::Time::getMillisecondCounterHiRes();
+            tableBudgets[table] = juce::jmin(budget * 2.0, 4000.0);
+            const juce::ScopedLock sl(lock);
+            ++report.budgetOverruns;
+        }
+        return;
+    }
+
+    lastIntegrityCheck = juce::Time::getMillisecondCounterHiRes();
+    nextTable = (nextTable + 1) % tables.size();
+    problems.removeString("ok");
+
+    const juce::ScopedLock sl(lock);
+    ++report.tablesChecked;
+    if (!problems.isEmpty())
+    {
+        report.integrityProblems += problems.size();
+        report.lastProblem = table + ": " + problems[0];
+        juce::Logger::writeToLog("Maintenance: integrity check of " + table + " found "
+                                 + juce::String(problems.size()) + " problem(s): " + problems.joinIntoString("; "));
+    }
+}
+
+//==============================================================================
+bool DatabaseMaintenance::runTask(const juce::String& sql, double budgetMs, juce::StringArray* rows)
+{
+    taskRunning = true;
+    bool ok = database.runWithBudget(sql, budgetMs, rows);
+    taskRunning = false;
+    return ok;
+}
+
+int DatabaseMaintenance::queryInt(const juce::String& sql)
+{
+    juce::StringArray rows;
+    return database.runWithBudget(sql, 100.0, &rows) && !rows.isEmpty() ? rows[0].getIntValue() : 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChopsDatabase.h"
+#include <map>
+
+/**
+ * DatabaseMaintenance - keeps a library database healthy during long sessions
+ *
+ * Once nothing has touched the database for a few seconds, a background thread
+ * works through whatever is due: a passive WAL checkpoint, PRAGMA optimize,
+ * incremental vacuum of free pages and an integrity check of one table (and its
+ * indexes) at a time. Every statement runs under a time budget, and any activity
+ * reported through noteActivity() interrupts the task that is running, so
+ * maintenance never competes with the user for the write lock.
+ *
+ * Uses its own connection. SQLite's commit-time checkpoints stay enabled on the
+ * other connections only as a backstop (see autoCheckpointPages).
+ */
+class DatabaseMaintenance : private juce::Thread
+{
+public:
+    struct Settings
+    {
+        int idleDelayMs = 5000;                       // Quiet time before a pass starts
+        int checkpointIntervalMs = 10 * 1000;
+        int optimizeIntervalMs = 60 * 60 * 1000;
+        int vacuumIntervalMs = 5 * 60 * 1000;
+        int integrityCheckIntervalMs = 20 * 60 * 1000;
+        double budgetMs = 250.0;                      // Per statement
+        int freePagesBeforeVacuum = 256;
+        int vacuumPagesPerPass = 1024;
+        int autoCheckpointPages = 8192;               // For connections that write; see header comment
+    };
+
+    struct Report
+    {
+        int passes = 0;
+        int checkpoints = 0;
+        int walFramesPending = 0;     // Left in the WAL after the last checkpoint
+        int optimizeRuns = 0;
+        int pagesVacuumed = 0;
+        int tablesChecked = 0;
+        int integrityProblems = 0;
+        int budgetOverruns = 0;
+        juce::String lastProblem;
+        juce::Time lastPass;
+
+        juce::String toString() const;
+    };
+
+    DatabaseMaintenance();
+    ~DatabaseMaintenance() override;
+
+    // Starts maintaining this file; an empty File stops maintenance and closes the connection
+    void setDatabase(const juce::File& databaseFile);
+
+    void setSettings(const Settings& newSettings);
+    Settings getSettings() const;
+
+    // Call from any thread whenever the app reads or writes; restarts the idle timer
+    void noteActivity();
+
+    Report getReport() const;
+
+private:
+    juce::File databaseFile;
+    bool reopenRequested = false;
+    Settings settings;
+
+    ChopsDatabase database;
+    juce::StringArray tables;
+    int nextTable = 0;
+    std::map<juce::String, double> tableBudgets; // Grows for tables that didn't fit the default
+    bool warnedAboutPinnedWal = false;
+    int lastWalFrames = -1, lastCheckpointedFrames = -1;
+
+    std::atomic<double> lastActivity { 0.0 };
+    std::atomic<bool> taskRunning { false };
+    double lastCheckpoint = 0.0, lastOptimize = 0.0, lastVacuum = 0.0, lastIntegrityCheck = 0.0;
+
+    Report report;
+    mutable juce::CriticalSection lock;     // Guards the file, settings and report
+    juce::CriticalSection connectionLock;   // Held while opening/closing, so interrupt() never races it
+
+    void run() override;
+    void reopenConnection();
+    void runPass();
+
+    bool runTask(const juce::String& sql, double budgetMs, juce::StringArray* rows = nullptr);
+    int queryInt(const juce::String& sql);
+    void checkNextTable();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DatabaseMaintenance)
+};
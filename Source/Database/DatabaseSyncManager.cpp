@@ -1,35 +1,85 @@
 #include "DatabaseSyncManager.h"
+#include "LibrarySnapshot.h"
+#include "../Shared/SharedConfig.h"
 
 DatabaseSyncManager::DatabaseSyncManager() { startTimer(1000); }
 DatabaseSyncManager::~DatabaseSyncManager() { stopTimer(); }
 
-bool DatabaseSyncManager::initialize(const juce::File& dbPath) {
+bool DatabaseSyncManager::initialize(const juce::File& dbPath, Role newRole) {
     juce::ScopedLock lock(writeLock);
     databaseFile = dbPath;
+    role = newRole;
+    initialized = false;
+    sampleCache.clear();
+    readDatabase.close(); writeDatabase.close();
+    snapshotFile = ChopsConfig::getLibrarySnapshotFile(databaseFile);
     juce::Logger::writeToLog("DSM: Init with DB: " + databaseFile.getFullPathName());
     if (!databaseFile.existsAsFile()) { juce::Logger::writeToLog("DSM Err: DB file missing: " + databaseFile.getFullPathName()); return false; }
+    snapshotPublisher.setDatabase(databaseFile, snapshotFile);
+    if (role == Role::browser) {
+        // Searches go to the snapshot; SQLite is opened when an edit or a lookup needs it
+        lastSnapshotTime = LibrarySnapshot::readCreationTime(snapshotFile);
+        initialized = true;
+        juce::Logger::writeToLog("DSM: Initialized for browsing.");
+        return true;
+    }
     if (!readDatabase.open(databaseFile.getFullPathName())) { juce::Logger::writeToLog("DSM Err: Fail open read-DB: " + databaseFile.getFullPathName()); return false; }
-    if (!writeDatabase.open(databaseFile.getFullPathName())) { juce::Logger::writeToLog("DSM Err: Fail open write-DB: " + databaseFile.getFullPathName()); readDatabase.close(); return false; }
-    lastModificationTime = databaseFile.existsAsFile() ? databaseFile.getLastModificationTime() : juce::Time(0);
-    juce::Logger::writeToLog("DSM: Initialized. Last mod: " + lastModificationTime.toString (true, true));
+    if (!openWriteDatabase()) { juce::Logger::writeToLog("DSM Err: Fail open write-DB: " + databaseFile.getFullPathName()); readDatabase.close(); return false; }
+    readDataVersion = readDatabase.getDataVersion();
+    maintenance.setDatabase(databaseFile);
+    snapshotPublisher.claim();
+    initialized = true;
+    juce::Logger::writeToLog("DSM: Initialized.");
+    return true;
+}
+
+bool DatabaseSyncManager::openWriteDatabase() {
+    if (writeDatabase.isOpen()) return true;
+    if (!databaseFile.existsAsFile() || !writeDatabase.open(databaseFile.getFullPathName())) return false;
+    // Checkpoints normally happen while idle; commit-time ones only as a backstop
+    if (role == Role::owner) writeDatabase.setAutoCheckpoint(maintenance.getSettings().autoCheckpointPages);
     return true;
 }
 
-void DatabaseSyncManager::reloadReadDatabase() {
+ChopsDatabase& DatabaseSyncManager::reader() {
+    if (role == Role::owner) return readDatabase;
+    juce::ScopedLock lock(writeLock);
+    if (initialized) openWriteDatabase();
+    return writeDatabase;
+}
+
+void DatabaseSyncManager::reloadReadDatabase(bool afterOwnWrite) {
+    // Every write path ends here, so this is where smart collections pick up changed rows
+    // and the snapshot gets republished. Another process's writes reach the publisher on their own.
+    if (writeDatabase.isOpen()) writeDatabase.refreshSmartCollections();
+    if (afterOwnWrite) snapshotPublisher.requestPublish();
+    maintenance.noteActivity();
+    if (role == Role::browser) return; // Reads share the write connection, which already sees its own writes
     juce::Logger::writeToLog("DSM: Reloading read DB...");
     juce::String dbPath = databaseFile.getFullPathName();
     readDatabase.close(); 
     if (!readDatabase.open(dbPath)) juce::Logger::writeToLog("DSM Err: Failed reload read DB from " + dbPath);
     else juce::Logger::writeToLog("DSM: Read DB reloaded.");
+    readDataVersion = readDatabase.getDataVersion(); // A new connection starts its own count
 }
 
 void DatabaseSyncManager::notifyListenersDatabaseUpdated() { listeners.call(&Listener::databaseUpdated); }
 
+std::unique_ptr<ChopsDatabase::SampleInfo> DatabaseSyncManager::getSample(int id) {
+    if (auto cached = sampleCache.getById(id)) return cached;
+    auto si = reader().getSampleById(id); if (si) sampleCache.put(*si); return si;
+}
+std::unique_ptr<ChopsDatabase::SampleInfo> DatabaseSyncManager::getSampleByPath(const juce::String& path) {
+    if (auto cached = sampleCache.getByPath(path)) return cached;
+    auto si = reader().getSampleByPath(path); if (si) sampleCache.put(*si); return si;
+}
+
 int DatabaseSyncManager::insertProcessedSample(const ChopsDatabase::SampleInfo& sampleInfo) {
     juce::ScopedLock lock(writeLock);
-    if (!writeDatabase.isOpen()) { juce::Logger::writeToLog("DSM Err: Write DB not open for insert."); return -1; }
+    if (!openWriteDatabase()) { juce::Logger::writeToLog("DSM Err: Write DB not open for insert."); return -1; }
     int newId = writeDatabase.insertSample(sampleInfo);
     if (newId > 0) {
+        sampleCache.invalidatePath(sampleInfo.filePath);
         logAction("sample_inserted", newId, juce::var(), juce::var(sampleInfo.originalFilename)); 
         reloadReadDatabase();
         listeners.call(&Listener::databaseUpdated); 
@@ -39,66 +89,109 @@ int DatabaseSyncManager::insertProcessedSample(const ChopsDatabase::SampleInfo&
     return newId;
 }
 
+void DatabaseSyncManager::helperWritesCommitted() {
+    juce::ScopedLock lock(writeLock);
+    sampleCache.clear(); // The helper may have touched any row
+    reloadReadDatabase();
+    listeners.call(&Listener::databaseUpdated);
+}
+
+bool DatabaseSyncManager::applyBatch(const std::function<bool(ChopsDatabase&)>& writes) {
+    juce::ScopedLock lock(writeLock);
+    if (!openWriteDatabase()) { juce::Logger::writeToLog("DSM Err: Write DB not open for batch."); return false; }
+    bool ok = writes(writeDatabase);
+    sampleCache.clear(); // The batch may have touched any row
+    reloadReadDatabase();
+    listeners.call(&Listener::databaseUpdated);
+    return ok;
+}
+
 bool DatabaseSyncManager::addTag(int id, const juce::String& tag) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()||tag.isEmpty()) return false;
-    auto oldT = readDatabase.getTags(id); bool ok = writeDatabase.addTag(id,tag);
-    if(ok){logAction("tag_added",id,juce::var(oldT.joinIntoString(";;")),juce::var(tag)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()||tag.isEmpty()) return false;
+    auto si=getSample(id); auto oldT=si?si->tags:reader().getTags(id); bool ok = writeDatabase.addTag(id,tag);
+    if(ok){sampleCache.update(id,[&](ChopsDatabase::SampleInfo& s){s.tags.addIfNotAlreadyThere(tag);}); logAction("tag_added",id,juce::var(oldT.joinIntoString(";;")),juce::var(tag)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 bool DatabaseSyncManager::removeTag(int id, const juce::String& tag) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()||tag.isEmpty()) return false;
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()||tag.isEmpty()) return false;
     bool ok = writeDatabase.removeTag(id,tag);
-    if(ok){logAction("tag_removed",id,juce::var(tag),juce::var()); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    if(ok){sampleCache.update(id,[&](ChopsDatabase::SampleInfo& s){s.tags.removeString(tag);}); logAction("tag_removed",id,juce::var(tag),juce::var()); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 bool DatabaseSyncManager::setRating(int id, int r) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()) return false;
-    auto si=readDatabase.getSampleById(id); int oldR=si?si->rating:0;
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()) return false;
+    auto si=getSample(id); int oldR=si?si->rating:0;
     bool ok = writeDatabase.setRating(id,r);
-    if(ok){logAction("rating_changed",id,juce::var(oldR),juce::var(r)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    if(ok){sampleCache.update(id,[r](ChopsDatabase::SampleInfo& s){s.rating=r;}); logAction("rating_changed",id,juce::var(oldR),juce::var(r)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 bool DatabaseSyncManager::setColor(int id, const juce::Colour& c) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()) return false;
-    auto si=readDatabase.getSampleById(id); juce::String oCStr=si?si->color.toDisplayString(true):juce::Colours::transparentBlack.toDisplayString(true);
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()) return false;
+    auto si=getSample(id); juce::String oCStr=si?si->color.toDisplayString(true):juce::Colours::transparentBlack.toDisplayString(true);
     bool ok = writeDatabase.setColor(id,c);
-    if(ok){logAction("color_changed",id,juce::var(oCStr),juce::var(c.toDisplayString(true))); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    if(ok){sampleCache.update(id,[c](ChopsDatabase::SampleInfo& s){s.color=c;}); logAction("color_changed",id,juce::var(oCStr),juce::var(c.toDisplayString(true))); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 bool DatabaseSyncManager::toggleFavorite(int id) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()) return false;
-    auto si=readDatabase.getSampleById(id); if(!si)return false; bool wasF=si->isFavorite;
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()) return false;
+    auto si=getSample(id); if(!si)return false; bool wasF=si->isFavorite;
     bool ok=wasF?writeDatabase.removeFromFavorites(id):writeDatabase.addToFavorites(id);
-    if(ok){logAction("favorite_toggled",id,juce::var(wasF),juce::var(!wasF)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    if(ok){sampleCache.update(id,[wasF](ChopsDatabase::SampleInfo& s){s.isFavorite=!wasF;}); logAction("favorite_toggled",id,juce::var(wasF),juce::var(!wasF)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 bool DatabaseSyncManager::incrementPlayCount(int id) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()) return false;
-    auto si=readDatabase.getSampleById(id); int oC=si?si->playCount:0;
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()) return false;
+    auto si=getSample(id); int oC=si?si->playCount:0;
     bool ok=writeDatabase.incrementPlayCount(id);
-    if(ok){logAction("play_count_incremented",id,juce::var(oC),juce::var(oC+1)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    if(ok){sampleCache.update(id,[](ChopsDatabase::SampleInfo& s){++s.playCount; s.lastPlayed=juce::Time::getCurrentTime();}); logAction("play_count_incremented",id,juce::var(oC),juce::var(oC+1)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 bool DatabaseSyncManager::setNotes(int id, const juce::String& n) {
-    juce::ScopedLock lock(writeLock); if (!writeDatabase.isOpen()) return false;
-    auto si=readDatabase.getSampleById(id); juce::String oN=si?si->userNotes:"";
+    juce::ScopedLock lock(writeLock); if (!openWriteDatabase()) return false;
+    auto si=getSample(id); juce::String oN=si?si->userNotes:"";
     bool ok=writeDatabase.setNotes(id,n);
-    if(ok){logAction("notes_changed",id,juce::var(oN),juce::var(n)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
+    if(ok){sampleCache.update(id,[&n](ChopsDatabase::SampleInfo& s){s.userNotes=n;}); logAction("notes_changed",id,juce::var(oN),juce::var(n)); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,id);} return ok;
 }
 
 bool DatabaseSyncManager::addTagsToMultiple(const juce::Array<int>& ids, const juce::String& tag) {
-    juce::ScopedLock l(writeLock); if(!writeDatabase.isOpen()||ids.isEmpty()||tag.isEmpty())return false;
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase()||ids.isEmpty()||tag.isEmpty())return false;
     if(!writeDatabase.beginTransaction())return false; bool ok=true;
     for(int id:ids)if(!writeDatabase.addTag(id,tag)){ok=false;break;}
-    if(ok){writeDatabase.commitTransaction(); reloadReadDatabase(); for(int id:ids)listeners.call(&Listener::sampleMetadataChanged,id); listeners.call(&Listener::databaseUpdated);}
+    if(ok){writeDatabase.commitTransaction(); for(int id:ids)sampleCache.update(id,[&](ChopsDatabase::SampleInfo& s){s.tags.addIfNotAlreadyThere(tag);}); reloadReadDatabase(); for(int id:ids)listeners.call(&Listener::sampleMetadataChanged,id); listeners.call(&Listener::databaseUpdated);}
     else writeDatabase.rollbackTransaction(); return ok;
 }
 bool DatabaseSyncManager::setRatingForMultiple(const juce::Array<int>& ids, int r) {
-    juce::ScopedLock l(writeLock); if(!writeDatabase.isOpen()||ids.isEmpty())return false;
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase()||ids.isEmpty())return false;
     if(!writeDatabase.beginTransaction())return false; bool ok=true;
     for(int id:ids)if(!writeDatabase.setRating(id,r)){ok=false;break;}
-    if(ok){writeDatabase.commitTransaction(); reloadReadDatabase(); for(int id:ids)listeners.call(&Listener::sampleMetadataChanged,id); listeners.call(&Listener::databaseUpdated);}
+    if(ok){writeDatabase.commitTransaction(); for(int id:ids)sampleCache.update(id,[r](ChopsDatabase::SampleInfo& s){s.rating=r;}); reloadReadDatabase(); for(int id:ids)listeners.call(&Listener::sampleMetadataChanged,id); listeners.call(&Listener::databaseUpdated);}
     else writeDatabase.rollbackTransaction(); return ok;
 }
 
-int DatabaseSyncManager::createCollection(const juce::String& n, const juce::String& d){juce::ignoreUnused(n,d);return -1;}
-bool DatabaseSyncManager::addToCollection(int cId,int sId){juce::ignoreUnused(cId,sId);return false;}
-bool DatabaseSyncManager::removeFromCollection(int cId,int sId){juce::ignoreUnused(cId,sId);return false;}
-juce::Array<int> DatabaseSyncManager::getCollections(){return{};}
+int DatabaseSyncManager::createCollection(const juce::String& n, const juce::String& d) {
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase()||n.isEmpty())return -1;
+    int id=writeDatabase.createCollection(n,d); if(id>0){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);} return id;
+}
+int DatabaseSyncManager::createSmartCollection(const juce::String& n, const ChopsDatabase::CollectionCriteria& c, const juce::String& d) {
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase()||n.isEmpty())return -1;
+    writeDatabase.refreshSmartCollections(); // Flush pending row changes before materializing
+    int id=writeDatabase.createSmartCollection(n,c,d); if(id>0){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);} return id;
+}
+bool DatabaseSyncManager::setSmartCollectionCriteria(int cId, const ChopsDatabase::CollectionCriteria& c) {
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase())return false;
+    writeDatabase.refreshSmartCollections();
+    bool ok=writeDatabase.setSmartCollectionCriteria(cId,c); if(ok){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);} return ok;
+}
+bool DatabaseSyncManager::deleteCollection(int cId) {
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase())return false;
+    bool ok=writeDatabase.deleteCollection(cId); if(ok){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);} return ok;
+}
+bool DatabaseSyncManager::addToCollection(int cId,int sId){return addSamplesToCollection(cId,juce::Array<int>{sId});}
+bool DatabaseSyncManager::removeFromCollection(int cId,int sId){return removeSamplesFromCollection(cId,juce::Array<int>{sId});}
+bool DatabaseSyncManager::addSamplesToCollection(int cId, const juce::Array<int>& ids) {
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase()||ids.isEmpty())return false;
+    bool ok=writeDatabase.addSamplesToCollection(cId,ids); if(ok){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);} return ok;
+}
+bool DatabaseSyncManager::removeSamplesFromCollection(int cId, const juce::Array<int>& ids) {
+    juce::ScopedLock l(writeLock); if(!openWriteDatabase()||ids.isEmpty())return false;
+    bool ok=writeDatabase.removeSamplesFromCollection(cId,ids); if(ok){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);} return ok;
+}
+std::vector<ChopsDatabase::CollectionInfo> DatabaseSyncManager::getCollections(){return reader().getCollections();}
+juce::Array<int> DatabaseSyncManager::getCollectionSampleIds(int cId){return reader().getCollectionSampleIds(cId);}
 
 void DatabaseSyncManager::logAction(const juce::String& type, int id, const juce::var& ov, const juce::var& nv) {
     undoStack.add({type,id,ov,nv,juce::Time::getCurrentTime()});
@@ -107,7 +200,7 @@ void DatabaseSyncManager::logAction(const juce::String& type, int id, const juce
 }
 
 bool DatabaseSyncManager::undo() {
-    juce::ScopedLock lock(writeLock); if (!canUndo()||!writeDatabase.isOpen()) return false;
+    juce::ScopedLock lock(writeLock); if (!canUndo()||!openWriteDatabase()) return false;
     Action action = undoStack.getLast(); // Get copy
     bool success = false;
     if (action.type=="tag_added") success=writeDatabase.removeTag(action.sampleId, action.newValue.toString());
@@ -116,11 +209,11 @@ bool DatabaseSyncManager::undo() {
     else if (action.type=="color_changed") success=writeDatabase.setColor(action.sampleId, juce::Colour::fromString(action.oldValue.toString()));
     else if (action.type=="favorite_toggled"){bool origFav=(bool)action.newValue; if(origFav)success=writeDatabase.removeFromFavorites(action.sampleId); else success=writeDatabase.addToFavorites(action.sampleId);}
     else if (action.type=="notes_changed") success=writeDatabase.setNotes(action.sampleId, action.oldValue.toString());
-    if(success){undoStack.removeLast(); redoStack.add(action); if(redoStack.size()>maxUndoLevels)redoStack.remove(0); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,action.sampleId); listeners.call(&Listener::databaseUpdated);}
+    if(success){sampleCache.invalidate(action.sampleId); undoStack.removeLast(); redoStack.add(action); if(redoStack.size()>maxUndoLevels)redoStack.remove(0); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,action.sampleId); listeners.call(&Listener::databaseUpdated);}
     return success;
 }
 bool DatabaseSyncManager::redo() {
-    juce::ScopedLock lock(writeLock); if (!canRedo()||!writeDatabase.isOpen()) return false;
+    juce::ScopedLock lock(writeLock); if (!canRedo()||!openWriteDatabase()) return false;
     Action action = redoStack.getLast(); // Get copy
     bool success = false;
     if (action.type=="tag_added") success=writeDatabase.addTag(action.sampleId, action.newValue.toString());
@@ -129,7 +222,7 @@ bool DatabaseSyncManager::redo() {
     else if (action.type=="color_changed") success=writeDatabase.setColor(action.sampleId, juce::Colour::fromString(action.newValue.toString()));
     else if (action.type=="favorite_toggled"){bool targetFav=(bool)action.newValue; if(targetFav)success=writeDatabase.addToFavorites(action.sampleId); else success=writeDatabase.removeFromFavorites(action.sampleId);}
     else if (action.type=="notes_changed") success=writeDatabase.setNotes(action.sampleId, action.newValue.toString());
-    if(success){redoStack.removeLast(); undoStack.add(action); if(undoStack.size()>maxUndoLevels)undoStack.remove(0); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,action.sampleId); listeners.call(&Listener::databaseUpdated);}
+    if(success){sampleCache.invalidate(action.sampleId); redoStack.removeLast(); undoStack.add(action); if(undoStack.size()>maxUndoLevels)undoStack.remove(0); reloadReadDatabase(); listeners.call(&Listener::sampleMetadataChanged,action.sampleId); listeners.call(&Listener::databaseUpdated);}
     return success;
 }
 
@@ -139,18 +232,30 @@ void DatabaseSyncManager::processWriteQueue() {
     bool changed=false;
     for(const auto&op:writeQueue) if(op.operation()) changed=true; // op.callback could be used
     writeQueue.clear();
-    if(changed){reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);}
+    if(changed){sampleCache.clear(); reloadReadDatabase(); listeners.call(&Listener::databaseUpdated);}
 }
 void DatabaseSyncManager::timerCallback() {
     if(writeQueue.size()>0){juce::ScopedLock lock(writeLock); processWriteQueue();}
-    if(databaseFile.existsAsFile()){
-        juce::Time currentModTime=databaseFile.getLastModificationTime();
-        if(currentModTime > lastModificationTime){
-            juce::Logger::writeToLog("DSM: External DB mod detected.");
-            juce::ScopedLock lock(writeLock); 
-            lastModificationTime = currentModTime;
-            reloadReadDatabase();
+    if(role==Role::browser){
+        writeDatabase.releaseReadLocks();
+        // Whoever publishes has folded in every commit, ours and other processes' alike
+        auto created=LibrarySnapshot::readCreationTime(snapshotFile);
+        if(created!=lastSnapshotTime){
+            juce::ScopedLock lock(writeLock);
+            lastSnapshotTime=created;
+            sampleCache.clear();
             listeners.call(&Listener::databaseUpdated);
         }
+        return;
+    }
+    readDatabase.releaseReadLocks(); // An idle read connection mustn't hold back checkpoints
+    // Other processes' commits sit in the WAL, so the file's mtime only moves on a checkpoint
+    // (often our own). data_version moves on every commit made on another connection.
+    if(readDatabase.isOpen() && readDatabase.getDataVersion()!=readDataVersion){
+        juce::Logger::writeToLog("DSM: External DB mod detected.");
+        juce::ScopedLock lock(writeLock); 
+        sampleCache.clear(); // Another connection wrote rows we know nothing about
+        reloadReadDatabase(false);
+        listeners.call(&Listener::databaseUpdated);
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,9 @@
 
 #include <JuceHeader.h>
 #include "ChopsDatabase.h" // Make sure this path is correct from this file's location
+#include "SampleCache.h"
+#include "DatabaseMaintenance.h"
+#include "SnapshotPublisher.h"
 
 class DatabaseSyncManager : public juce::Timer
 {
@@ -9,11 +12,36 @@ public:
     DatabaseSyncManager();
     ~DatabaseSyncManager() override;
     
-    bool initialize(const juce::File& databasePath);
+    // The owner (the standalone app) keeps the library: it reads through SQLite, runs
+    // maintenance and publishes the snapshot. Browsers (plugin instances) read the
+    // snapshot instead and open a single connection only once something needs SQLite.
+    enum class Role { owner, browser };
     
-    ChopsDatabase* getReadDatabase() const { return const_cast<ChopsDatabase*>(&readDatabase); }
+    bool initialize(const juce::File& databasePath, Role role = Role::owner);
+    bool isInitialized() const { juce::ScopedLock lock(writeLock); return initialized; }
+    
+    // For a browser this opens its connection if it isn't already
+    ChopsDatabase* getReadDatabase() const { return &const_cast<DatabaseSyncManager*>(this)->reader(); }
+    // For helpers that keep a connection of their own (maintenance, file write-behind)
+    juce::File getDatabaseFile() const { juce::ScopedLock lock(writeLock); return databaseFile; }
+    // Helpers that write through their own connection (folder ingest) call this on the message
+    // thread once those writes have committed; they're then published like writes made here
+    void helperWritesCommitted();
+    
+    // Cached lookups; prefer these to getReadDatabase()->getSampleById for single rows
+    std::unique_ptr<ChopsDatabase::SampleInfo> getSample(int sampleId);
+    std::unique_ptr<ChopsDatabase::SampleInfo> getSampleByPath(const juce::String& filePath);
+    SampleCache::Stats getSampleCacheStats() const { return sampleCache.getStats(); }
+    
+    // Background upkeep runs while the library is idle; reads that bypass this class
+    // (searches on other connections) should report themselves so it stays out of the way
+    void noteActivity() { maintenance.noteActivity(); }
+    DatabaseMaintenance::Report getMaintenanceReport() const { return maintenance.getReport(); }
 
     int insertProcessedSample(const ChopsDatabase::SampleInfo& sampleInfo); 
+    // Runs a batch of writes on the write connection (e.g. MetadataService::scanAndSyncDirectory),
+    // then publishes them like any other change. Returns what 'writes' returned.
+    bool applyBatch(const std::function<bool(ChopsDatabase&)>& writes);
     bool addTag(int sampleId, const juce::String& tag);
     bool removeTag(int sampleId, const juce::String& tag);
     bool setRating(int sampleId, int rating);
@@ -26,9 +54,15 @@ public:
     bool setRatingForMultiple(const juce::Array<int>& sampleIds, int rating);
     
     int createCollection(const juce::String& name, const juce::String& description = "");
+    int createSmartCollection(const juce::String& name, const ChopsDatabase::CollectionCriteria& criteria, const juce::String& description = "");
+    bool setSmartCollectionCriteria(int collectionId, const ChopsDatabase::CollectionCriteria& criteria);
+    bool deleteCollection(int collectionId);
     bool addToCollection(int collectionId, int sampleId);
     bool removeFromCollection(int collectionId, int sampleId);
-    juce::Array<int> getCollections();
+    bool addSamplesToCollection(int collectionId, const juce::Array<int>& sampleIds);
+    bool removeSamplesFromCollection(int collectionId, const juce::Array<int>& sampleIds);
+    std::vector<ChopsDatabase::CollectionInfo> getCollections();
+    juce::Array<int> getCollectionSampleIds(int collectionId);
     
     bool canUndo() const { return !undoStack.isEmpty(); }
     bool canRedo() const { return !redoStack.isEmpty(); }
@@ -51,8 +85,15 @@ private:
     ChopsDatabase readDatabase;
     ChopsDatabase writeDatabase;
     juce::CriticalSection writeLock;
+    SampleCache sampleCache; // Patched or invalidated by every write below
+    DatabaseMaintenance maintenance;
+    SnapshotPublisher snapshotPublisher; // Asked to republish after every write here; see the class for who does
     juce::File databaseFile;
-    juce::Time lastModificationTime;
+    Role role = Role::owner;
+    bool initialized = false;
+    juce::int64 readDataVersion = -1;    // Owner: readDatabase's data_version when it was last reloaded
+    juce::File snapshotFile;
+    juce::Time lastSnapshotTime;         // Browser: creation time of the snapshot last announced
     
     struct Action {
         juce::String type; int sampleId; juce::var oldValue; juce::var newValue; juce::Time timestamp;
@@ -68,7 +109,9 @@ private:
     
     void timerCallback() override;
     juce::ListenerList<Listener> listeners;
-    void reloadReadDatabase(); 
+    void reloadReadDatabase(bool afterOwnWrite = true); 
+    ChopsDatabase& reader();     // readDatabase, or for a browser its one connection
+    bool openWriteDatabase();    // A browser's connection is opened on first use
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DatabaseSyncManager)
 };
\ No newline at end of file
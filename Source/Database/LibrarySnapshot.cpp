@@ -0,0 +1,503 @@
+#include "LibrarySnapshot.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+static_assert(sizeof(LibrarySnapshot::StringRef) == 8, "Snapshot layout changed - bump formatVersion");
+static_assert(sizeof(LibrarySnapshot::Facet) == 16, "Snapshot layout changed - bump formatVersion");
+static_assert(sizeof(LibrarySnapshot::Row) == 184, "Snapshot layout changed - bump formatVersion");
+static_assert(sizeof(LibrarySnapshot::Header) == 104, "Snapshot layout changed - bump formatVersion");
+
+static constexpr char snapshotMagic[4] = { 'C', 'H', 'S', 'N' };
+
+//==============================================================================
+namespace
+{
+    // Accumulates UTF-8 strings, sharing storage between identical values
+    struct StringPoolBuilder
+    {
+        juce::MemoryOutputStream data;
+        std::unordered_map<std::string, LibrarySnapshot::StringRef> seen;
+
+        LibrarySnapshot::StringRef add(const juce::String& text)
+        {
+            std::string utf8 = text.toStdString();
+            if (utf8.empty()) return {};
+
+            auto it = seen.find(utf8);
+            if (it != seen.end()) return it->second;
+
+            LibrarySnapshot::StringRef ref;
+            ref.offset = static_cast<juce::uint32>(data.getDataSize());
+            ref.length = static_cast<juce::uint32>(utf8.size());
+            data.write(utf8.data(), utf8.size());
+            seen.emplace(std::move(utf8), ref);
+            return ref;
+        }
+    };
+
+    struct FacetBuilder
+    {
+        juce::StringArray names;
+        std::vector<std::vector<juce::uint32>> rows;
+
+        juce::uint16 add(const juce::String& name, juce::uint32 rowIndex)
+        {
+            int index = names.indexOf(name);
+            if (index < 0)
+            {
+                index = names.size();
+                names.add(name);
+                rows.emplace_back();
+            }
+            rows[(size_t) index].push_back(rowIndex);
+            return static_cast<juce::uint16>(index);
+        }
+    };
+
+    void padTo8(juce::MemoryOutputStream& out)
+    {
+        while (out.getDataSize() % 8 != 0)
+            out.writeByte(0);
+    }
+}
+
+//==============================================================================
+bool LibrarySnapshot::publish(ChopsDatabase& database, const juce::File& snapshotFile)
+{
+    if (!database.isOpen()) return false;
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    auto samples = database.searchSamples("", "", "", ChopsDatabase::DontCare, ChopsDatabase::DontCare, -1, 0);
+
+    StringPoolBuilder pool;
+    FacetBuilder rootFacetBuilder, chordFacetBuilder;
+    std::vector<Row> rowData(samples.size());
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const auto& sample = samples[i];
+        auto& row = rowData[i];
+        auto rowIndex = static_cast<juce::uint32>(i);
+
+        row = {};
+        row.id = sample.id;
+        row.flags = (sample.isFavorite ? flagFavorite : 0u)
+                  | (sample.extensions.isEmpty() ? 0u : flagExtensions)
+                  | (sample.alterations.isEmpty() ? 0u : flagAlterations);
+        row.fileSize = sample.fileSize;
+        row.dateAddedMs = sample.dateAdded.toMilliseconds();
+        row.dateModifiedMs = sample.dateModified.toMilliseconds();
+        row.lastPlayedMs = sample.lastPlayed.toMilliseconds();
+        row.contentHash = sample.contentHash;
+        row.durationMs = sample.durationMs;
+        row.sampleRate = sample.sampleRate;
+        row.bitDepth = static_cast<juce::uint16>(sample.bitDepth);
+        row.channels = static_cast<juce::uint16>(sample.channels);
+        row.colourArgb = sample.color.getARGB();
+        row.rating = sample.rating;
+        row.playCount = sample.playCount;
+        row.rootFacet = rootFacetBuilder.add(sample.rootNote, rowIndex);
+        row.chordFacet = chordFacetBuilder.add(sample.chordType, rowIndex);
+
+        // Matches the search_text column written by ChopsDatabase::insertSample
+        juce::String searchable = (sample.originalFilename + " " + sample.currentFilename + " " +
+                                   sample.rootNote + " " + sample.chordType + " " +
+                                   sample.tags.joinIntoString(" ")).toLowerCase();
+
+        row.strings[originalFilename] = pool.add(sample.originalFilename);
+        row.strings[currentFilename] = pool.add(sample.currentFilename);
+        row.strings[filePath] = pool.add(sample.filePath);
+        row.strings[chordTypeDisplay] = pool.add(sample.chordTypeDisplay);
+        row.strings[bassNote] = pool.add(sample.bassNote);
+        row.strings[inversion] = pool.add(sample.inversion);
+        row.strings[extensions] = pool.add(sample.extensions.joinIntoString(","));
+        row.strings[alterations] = pool.add(sample.alterations.joinIntoString(","));
+        row.strings[addedNotes] = pool.add(sample.addedNotes.joinIntoString(","));
+        row.strings[suspensions] = pool.add(sample.suspensions.joinIntoString(","));
+        row.strings[tags] = pool.add(sample.tags.joinIntoString(","));
+        row.strings[userNotes] = pool.add(sample.userNotes);
+        row.strings[searchText] = pool.add(searchable);
+    }
+
+    if (rootFacetBuilder.names.size() > 0xffff || chordFacetBuilder.names.size() > 0xffff)
+    {
+        juce::Logger::writeToLog("Snapshot: too many distinct root notes or chord types to publish");
+        return false;
+    }
+
+    // Prebuilt orders: by id for lookups, by date added for "recent" views
+    std::vector<juce::uint32> idOrder(rowData.size()), dateOrder(rowData.size());
+    for (size_t i = 0; i < rowData.size(); ++i)
+        idOrder[i] = dateOrder[i] = static_cast<juce::uint32>(i);
+
+    std::sort(idOrder.begin(), idOrder.end(),
+              [&rowData](juce::uint32 a, juce::uint32 b) { return rowData[a].id < rowData[b].id; });
+    std::stable_sort(dateOrder.begin(), dateOrder.end(),
+                     [&rowData](juce::uint32 a, juce::uint32 b) { return rowData[a].dateAddedMs > rowData[b].dateAddedMs; });
+
+    auto buildFacets = [&pool](const FacetBuilder& builder, std::vector<Facet>& facets, std::vector<juce::uint32>& postingList)
+    {
+        for (int i = 0; i < builder.names.size(); ++i)
+        {
+            Facet facet;
+            facet.name = pool.add(builder.names[i]);
+            facet.postingStart = static_cast<juce::uint32>(postingList.size());
+            facet.postingCount = static_cast<juce::uint32>(builder.rows[(size_t) i].size());
+            postingList.insert(postingList.end(), builder.rows[(size_t) i].begin(), builder.rows[(size_t) i].end());
+            facets.push_back(facet);
+        }
+    };
+
+    std::vector<Facet> rootFacetData, chordFacetData;
+    std::vector<juce::uint32> postingData;
+    buildFacets(rootFacetBuilder, rootFacetData, postingData);
+    buildFacets(chordFacetBuilder, chordFacetData, postingData);
+
+    //==============================================================================
+    Header fileHeader = {};
+    std::copy(std::begin(snapshotMagic), std::end(snapshotMagic), fileHeader.magic);
+    fileHeader.version = formatVersion;
+    fileHeader.headerSize = sizeof(Header);
+    fileHeader.rowSize = sizeof(Row);
+    fileHeader.rowCount = static_cast<juce::uint32>(rowData.size());
+    fileHeader.rootFacetCount = static_cast<juce::uint32>(rootFacetData.size());
+    fileHeader.chordFacetCount = static_cast<juce::uint32>(chordFacetData.size());
+    fileHeader.postingCount = static_cast<juce::uint32>(postingData.size());
+    fileHeader.createdMs = juce::Time::currentTimeMillis();
+
+    juce::MemoryOutputStream out;
+    out.write(&fileHeader, sizeof(fileHeader)); // Rewritten with offsets below
+
+    auto writeSection = [&out](const void* data, size_t numBytes) -> juce::uint64
+    {
+        padTo8(out);
+        auto offset = static_cast<juce::uint64>(out.getDataSize());
+        if (numBytes > 0) out.write(data, numBytes);
+        return offset;
+    };
+
+    fileHeader.rowsOffset = writeSection(rowData.data(), rowData.size() * sizeof(Row));
+    fileHeader.byIdOffset = writeSection(idOrder.data(), idOrder.size() * sizeof(juce::uint32));
+    fileHeader.byDateAddedOffset = writeSection(dateOrder.data(), dateOrder.size() * sizeof(juce::uint32));
+    fileHeader.rootFacetsOffset = writeSection(rootFacetData.data(), rootFacetData.size() * sizeof(Facet));
+    fileHeader.chordFacetsOffset = writeSection(chordFacetData.data(), chordFacetData.size() * sizeof(Facet));
+    fileHeader.postingsOffset = writeSection(postingData.data(), postingData.size() * sizeof(juce::uint32));
+    fileHeader.stringPoolOffset = writeSection(pool.data.getData(), pool.data.getDataSize());
+    fileHeader.stringPoolSize = pool.data.getDataSize();
+
+    juce::MemoryBlock block(out.getData(), out.getDataSize());
+    block.copyFrom(&fileHeader, 0, sizeof(fileHeader));
+
+    // Write beside the target and rename, so mapped readers never see a partial file
+    juce::TemporaryFile temp(snapshotFile);
+    if (!temp.getFile().replaceWithData(block.getData(), block.getSize()) || !temp.overwriteTargetFileWithTemporary())
+    {
+        juce::Logger::writeToLog("Snapshot: failed to write " + snapshotFile.getFullPathName());
+        return false;
+    }
+
+    juce::Logger::writeToLog("Snapshot: published " + juce::String(rowData.size()) + " samples ("
+                             + juce::String(block.getSize() / 1024) + " KB) in "
+                             + juce::String(juce::Time::getMillisecondCounterHiRes() - startTime, 1) + " ms");
+    return true;
+}
+
+//==============================================================================
+bool LibrarySnapshot::open(const juce::File& snapshotFile)
+{
+    close();
+
+    if (!snapshotFile.existsAsFile()) return false;
+
+    auto modificationTime = snapshotFile.getLastModificationTime();
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(snapshotFile, juce::MemoryMappedFile::readOnly, false);
+    if (mapped->getData() == nullptr || mapped->getSize() < sizeof(Header))
+    {
+        juce::Logger::writeToLog("Snapshot: could not map " + snapshotFile.getFullPathName());
+        return false;
+    }
+
+    auto* base = static_cast<const char*>(mapped->getData());
+    header = reinterpret_cast<const Header*>(base);
+
+    if (!validateLayout(mapped->getSize()))
+    {
+        juce::Logger::writeToLog("Snapshot: ignoring invalid or outdated snapshot " + snapshotFile.getFullPathName());
+        header = nullptr;
+        return false;
+    }
+
+    rows = reinterpret_cast<const Row*>(base + header->rowsOffset);
+    byId = reinterpret_cast<const juce::uint32*>(base + header->byIdOffset);
+    byDateAdded = reinterpret_cast<const juce::uint32*>(base + header->byDateAddedOffset);
+    rootFacets = reinterpret_cast<const Facet*>(base + header->rootFacetsOffset);
+    chordFacets = reinterpret_cast<const Facet*>(base + header->chordFacetsOffset);
+    postings = reinterpret_cast<const juce::uint32*>(base + header->postingsOffset);
+    stringPool = base + header->stringPoolOffset;
+
+    mappedFile = std::move(mapped);
+    sourceFile = snapshotFile;
+    openedModificationTime = modificationTime;
+    return true;
+}
+
+void LibrarySnapshot::close()
+{
+    header = nullptr;
+    rows = nullptr;
+    byId = byDateAdded = postings = nullptr;
+    rootFacets = chordFacets = nullptr;
+    stringPool = nullptr;
+    mappedFile.reset();
+}
+
+bool LibrarySnapshot::isOutOfDate() const
+{
+    if (!sourceFile.existsAsFile())
+        return false;
+    if (sourceFile.getLastModificationTime() != openedModificationTime || header == nullptr)
+        return true;
+
+    // Modification times can be whole seconds, and edits republish more often than that
+    juce::FileInputStream in(sourceFile);
+    Header current;
+    return in.openedOk() && in.read(&current, sizeof(current)) == (int) sizeof(current)
+        && current.createdMs != header->createdMs;
+}
+
+juce::Time LibrarySnapshot::readCreationTime(const juce::File& snapshotFile)
+{
+    juce::FileInputStream in(snapshotFile);
+    Header current;
+    if (!in.openedOk() || in.read(&current, sizeof(current)) != (int) sizeof(current)
+        || !std::equal(std::begin(snapshotMagic), std::end(snapshotMagic), current.magic))
+        return {};
+
+    return juce::Time(current.createdMs);
+}
+
+bool LibrarySnapshot::validateLayout(size_t fileSize) const
+{
+    if (!std::equal(std::begin(snapshotMagic), std::end(snapshotMagic), header->magic)) return false;
+    if (header->version != formatVersion || header->headerSize != sizeof(Header) || header->rowSize != sizeof(Row)) return false;
+
+    auto fits = [fileSize](juce::uint64 offset, juce::uint64 numBytes) {
+        return offset % 8 == 0 && offset <= fileSize && numBytes <= fileSize - offset;
+    };
+
+    juce::uint64 n = header->rowCount;
+    if (!fits(header->rowsOffset, n * sizeof(Row))
+        || !fits(header->byIdOffset, n * sizeof(juce::uint32))
+        || !fits(header->byDateAddedOffset, n * sizeof(juce::uint32))
+        || !fits(header->rootFacetsOffset, header->rootFacetCount * (juce::uint64) sizeof(Facet))
+        || !fits(header->chordFacetsOffset, header->chordFacetCount * (juce::uint64) sizeof(Facet))
+        || !fits(header->postingsOffset, header->postingCount * (juce::uint64) sizeof(juce::uint32))
+        || !fits(header->stringPoolOffset, header->stringPoolSize))
+        return false;
+
+    // Indices and string references are trusted after this, so check them once up front
+    auto* base = reinterpret_cast<const char*>(header);
+    auto* rowPtr = reinterpret_cast<const Row*>(base + header->rowsOffset);
+    auto* postingPtr = reinterpret_cast<const juce::uint32*>(base + header->postingsOffset);
+    auto refOk = [this](const StringRef& ref) { return (juce::uint64) ref.offset + ref.length <= header->stringPoolSize; };
+    auto facetsOk = [&](juce::uint64 offset, juce::uint32 count) {
+        auto* facets = reinterpret_cast<const Facet*>(base + offset);
+        for (juce::uint32 i = 0; i < count; ++i)
+        {
+            if (!refOk(facets[i].name) || (juce::uint64) facets[i].postingStart + facets[i].postingCount > header->postingCount)
+                return false;
+        }
+        return true;
+    };
+
+    for (juce::uint64 i = 0; i < n; ++i)
+    {
+        if (rowPtr[i].rootFacet >= header->rootFacetCount || rowPtr[i].chordFacet >= header->chordFacetCount) return false;
+        for (const auto& ref : rowPtr[i].strings)
+            if (!refOk(ref)) return false;
+    }
+    for (juce::uint32 i = 0; i < header->postingCount; ++i)
+        if (postingPtr[i] >= n) return false;
+
+    auto* idPtr = reinterpret_cast<const juce::uint32*>(base + header->byIdOffset);
+    auto* datePtr = reinterpret_cast<const juce::uint32*>(base + header->byDateAddedOffset);
+    for (juce::uint64 i = 0; i < n; ++i)
+        if (idPtr[i] >= n || datePtr[i] >= n) return false;
+
+    return facetsOk(header->rootFacetsOffset, header->rootFacetCount)
+        && facetsOk(header->chordFacetsOffset, header->chordFacetCount);
+}
+
+//==============================================================================
+int LibrarySnapshot::getNumSamples() const
+{
+    return header != nullptr ? static_cast<int>(header->rowCount) : 0;
+}
+
+juce::Time LibrarySnapshot::getCreationTime() const
+{
+    return header != nullptr ? juce::Time(header->createdMs) : juce::Time();
+}
+
+juce::String LibrarySnapshot::getString(const StringRef& ref) const
+{
+    if (ref.length == 0) return {};
+    return juce::String::fromUTF8(stringPool + ref.offset, static_cast<int>(ref.length));
+}
+
+bool LibrarySnapshot::stringContains(const StringRef& ref, const std::string& lowerNeedle) const
+{
+    if (lowerNeedle.empty()) return true;
+    std::string_view haystack(stringPool + ref.offset, ref.length);
+    return haystack.find(lowerNeedle) != std::string_view::npos;
+}
+
+int LibrarySnapshot::findFacet(const Facet* facets, juce::uint32 count, const juce::String& name) const
+{
+    std::string utf8 = name.toStdString();
+    for (juce::uint32 i = 0; i < count; ++i)
+    {
+        if (std::string_view(stringPool + facets[i].name.offset, facets[i].name.length) == utf8)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+ChopsDatabase::SampleInfo LibrarySnapshot::getSampleAtRow(int rowIndex) const
+{
+    ChopsDatabase::SampleInfo info;
+    if (header == nullptr || rowIndex < 0 || rowIndex >= static_cast<int>(header->rowCount)) return info;
+
+    const auto& row = rows[rowIndex];
+    auto list = [this, &row](StringField field) { return juce::StringArray::fromTokens(getString(row.strings[field]), ",", ""); };
+
+    info.id = row.id;
+    info.originalFilename = getString(row.strings[originalFilename]);
+    info.currentFilename = getString(row.strings[currentFilename]);
+    info.filePath = getString(row.strings[filePath]);
+    info.fileSize = row.fileSize;
+    info.contentHash = row.contentHash;
+    info.durationMs = row.durationMs;
+    info.sampleRate = row.sampleRate;
+    info.bitDepth = row.bitDepth;
+    info.channels = row.channels;
+    info.rootNote = getString(rootFacets[row.rootFacet].name);
+    info.chordType = getString(chordFacets[row.chordFacet].name);
+    info.chordTypeDisplay = getString(row.strings[chordTypeDisplay]);
+    info.extensions = list(extensions);
+    info.alterations = list(alterations);
+    info.addedNotes = list(addedNotes);
+    info.suspensions = list(suspensions);
+    info.bassNote = getString(row.strings[bassNote]);
+    info.inversion = getString(row.strings[inversion]);
+    info.dateAdded = juce::Time(row.dateAddedMs);
+    info.dateModified = juce::Time(row.dateModifiedMs);
+    info.tags = list(tags);
+    info.rating = row.rating;
+    info.color = juce::Colour(row.colourArgb);
+    info.isFavorite = (row.flags & flagFavorite) != 0;
+    info.playCount = row.playCount;
+    info.userNotes = getString(row.strings[userNotes]);
+    info.lastPlayed = juce::Time(row.lastPlayedMs);
+    return info;
+}
+
+//==============================================================================
+std::vector<ChopsDatabase::SampleInfo> LibrarySnapshot::searchSamples(
+    const juce::String& query, const juce::String& rootNote, const juce::String& chordType,
+    ChopsDatabase::BoolFilter hasExtensions, ChopsDatabase::BoolFilter hasAlterations,
+    int limit, int offset, const ChopsDatabase::FormatFilter& format) const
+{
+    std::vector<ChopsDatabase::SampleInfo> results;
+    if (header == nullptr || limit == 0) return results;
+
+    int rootFacet = -1, chordFacet = -1;
+    if (rootNote.isNotEmpty() && (rootFacet = findFacet(rootFacets, header->rootFacetCount, rootNote)) < 0) return results;
+    if (chordType.isNotEmpty() && (chordFacet = findFacet(chordFacets, header->chordFacetCount, chordType)) < 0) return results;
+
+    std::string needle = query.toLowerCase().toStdString();
+
+    auto flagMatches = [](juce::uint32 flags, juce::uint32 flag, ChopsDatabase::BoolFilter filter) {
+        if (filter == ChopsDatabase::Yes) return (flags & flag) != 0;
+        if (filter == ChopsDatabase::No) return (flags & flag) == 0;
+        return true;
+    };
+
+    auto matches = [&](juce::uint32 rowIndex) {
+        const auto& row = rows[rowIndex];
+        return (rootFacet < 0 || row.rootFacet == rootFacet)
+            && (chordFacet < 0 || row.chordFacet == chordFacet)
+            && flagMatches(row.flags, flagExtensions, hasExtensions)
+            && flagMatches(row.flags, flagAlterations, hasAlterations)
+            && format.matches(row.durationMs, row.sampleRate, row.channels)
+            && stringContains(row.strings[searchText], needle);
+    };
+
+    // Walk the smaller facet posting list if there is one; postings are in row order,
+    // so results come out in the default browse order either way
+    const juce::uint32* candidates = nullptr;
+    juce::uint32 numCandidates = header->rowCount;
+    auto narrowTo = [&](const Facet& facet) {
+        if (candidates == nullptr || facet.postingCount < numCandidates)
+        {
+            candidates = postings + facet.postingStart;
+            numCandidates = facet.postingCount;
+        }
+    };
+    if (rootFacet >= 0) narrowTo(rootFacets[rootFacet]);
+    if (chordFacet >= 0) narrowTo(chordFacets[chordFacet]);
+
+    int skipped = 0;
+    for (juce::uint32 i = 0; i < numCandidates; ++i)
+    {
+        juce::uint32 rowIndex = candidates != nullptr ? candidates[i] : i;
+        if (!matches(rowIndex)) continue;
+        if (skipped < offset) { ++skipped; continue; }
+
+        results.push_back(getSampleAtRow(static_cast<int>(rowIndex)));
+        if (limit > 0 && static_cast<int>(results.size()) >= limit) break;
+    }
+    return results;
+}
+
+std::unique_ptr<ChopsDatabase::SampleInfo> LibrarySnapshot::getSampleById(int sampleId) const
+{
+    if (header == nullptr) return nullptr;
+
+    auto* end = byId + header->rowCount;
+    auto it = std::lower_bound(byId, end, sampleId,
+                               [this](juce::uint32 rowIndex, int id) { return rows[rowIndex].id < id; });
+    if (it == end || rows[*it].id != sampleId) return nullptr;
+    return std::make_unique<ChopsDatabase::SampleInfo>(getSampleAtRow(static_cast<int>(*it)));
+}
+
+std::vector<int> LibrarySnapshot::getRowsByDateAdded(int limit) const
+{
+    std::vector<int> result;
+    if (header == nullptr) return result;
+
+    auto count = limit < 0 ? header->rowCount : juce::jmin(header->rowCount, static_cast<juce::uint32>(limit));
+    result.reserve(count);
+    for (juce::uint32 i = 0; i < count; ++i)
+        result.push_back(static_cast<int>(byDateAdded[i]));
+    return result;
+}
+
+juce::StringArray LibrarySnapshot::getDistinctRootNotes() const
+{
+    juce::StringArray names;
+    for (juce::uint32 i = 0; header != nullptr && i < header->rootFacetCount; ++i)
+        if (rootFacets[i].name.length > 0) names.add(getString(rootFacets[i].name));
+    names.sort(false);
+    return names;
+}
+
+juce::StringArray LibrarySnapshot::getDistinctChordTypes() const
+{
+    juce::StringArray names;
+    for (juce::uint32 i = 0; header != nullptr && i < header->chordFacetCount; ++i)
+        if (chordFacets[i].name.length > 0) names.add(getString(chordFacets[i].name));
+    names.sort(false);
+    return names;
+}
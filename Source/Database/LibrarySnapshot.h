@@ -0,0 +1,159 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChopsDatabase.h"
+#include <vector>
+#include <memory>
+
+/**
+ * Read-only, memory-mappable binary snapshot of the sample library.
+ *
+ * Whatever writes to the library republishes it shortly after (SnapshotPublisher);
+ * plugin instances map it instead of decoding SQLite rows, so every instance in a DAW session shares
+ * the same pages through the OS page cache. Writes still go through SQLite.
+ *
+ * Layout (little-endian, offsets from the start of the file):
+ *   Header | Row[rowCount] | uint32 byId[rowCount] | uint32 byDateAdded[rowCount]
+ *          | Facet[root] | Facet[chord] | uint32 postings[] | string pool
+ *
+ * Rows are stored in the library's default browse order (root note, chord type,
+ * newest first), so that order needs no index. Facet postings list the row
+ * indices for each distinct root note / chord type in ascending order.
+ */
+class LibrarySnapshot
+{
+public:
+    static constexpr juce::uint32 formatVersion = 2;
+
+    LibrarySnapshot() = default;
+    ~LibrarySnapshot() = default;
+
+    // Writes a snapshot of every sample in the database. The file is replaced atomically.
+    static bool publish(ChopsDatabase& database, const juce::File& snapshotFile);
+
+    bool open(const juce::File& snapshotFile);
+    void close();
+    bool isValid() const { return mappedFile != nullptr; }
+
+    // True if the file on disk was republished since this snapshot was opened
+    bool isOutOfDate() const;
+
+    // Reads just the header; a null Time if there's no snapshot there. Cheap enough to poll.
+    static juce::Time readCreationTime(const juce::File& snapshotFile);
+
+    int getNumSamples() const;
+    juce::Time getCreationTime() const;
+
+    // Same semantics as ChopsDatabase::searchSamples
+    std::vector<ChopsDatabase::SampleInfo> searchSamples(
+        const juce::String& query = "",
+        const juce::String& rootNote = "",
+        const juce::String& chordType = "",
+        ChopsDatabase::BoolFilter hasExtensions = ChopsDatabase::DontCare,
+        ChopsDatabase::BoolFilter hasAlterations = ChopsDatabase::DontCare,
+        int limit = 100,
+        int offset = 0,
+        const ChopsDatabase::FormatFilter& format = {}) const;
+
+    std::unique_ptr<ChopsDatabase::SampleInfo> getSampleById(int sampleId) const;
+
+    // Row indices ordered newest first
+    std::vector<int> getRowsByDateAdded(int limit = -1) const;
+    ChopsDatabase::SampleInfo getSampleAtRow(int rowIndex) const;
+
+    juce::StringArray getDistinctRootNotes() const;
+    juce::StringArray getDistinctChordTypes() const;
+
+    //==============================================================================
+    // On-disk structures
+    struct StringRef
+    {
+        juce::uint32 offset = 0;  // Relative to the string pool
+        juce::uint32 length = 0;  // UTF-8 bytes, not null-terminated
+    };
+
+    enum StringField
+    {
+        originalFilename, currentFilename, filePath, chordTypeDisplay,
+        bassNote, inversion, extensions, alterations, addedNotes, suspensions,
+        tags, userNotes, searchText,
+        numStringFields
+    };
+
+    enum RowFlags : juce::uint32
+    {
+        flagFavorite      = 1 << 0,
+        flagExtensions    = 1 << 1,
+        flagAlterations   = 1 << 2
+    };
+
+    struct Row
+    {
+        juce::int32 id;
+        juce::uint32 flags;
+        juce::int64 fileSize;
+        juce::int64 dateAddedMs;
+        juce::int64 dateModifiedMs;
+        juce::int64 lastPlayedMs;
+        juce::uint64 contentHash;
+        juce::uint32 colourArgb;
+        juce::int32 rating;
+        juce::int32 playCount;
+        juce::int32 durationMs;     // 0 until the file header has been probed
+        juce::int32 sampleRate;
+        juce::uint16 bitDepth;
+        juce::uint16 channels;
+        juce::uint16 rootFacet;
+        juce::uint16 chordFacet;
+        StringRef strings[numStringFields];
+    };
+
+    struct Facet
+    {
+        StringRef name;
+        juce::uint32 postingStart;
+        juce::uint32 postingCount;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        juce::uint32 version;
+        juce::uint32 headerSize;
+        juce::uint32 rowSize;
+        juce::uint32 rowCount;
+        juce::uint32 rootFacetCount;
+        juce::uint32 chordFacetCount;
+        juce::uint32 postingCount;
+        juce::int64 createdMs;
+        juce::uint64 rowsOffset;
+        juce::uint64 byIdOffset;
+        juce::uint64 byDateAddedOffset;
+        juce::uint64 rootFacetsOffset;
+        juce::uint64 chordFacetsOffset;
+        juce::uint64 postingsOffset;
+        juce::uint64 stringPoolOffset;
+        juce::uint64 stringPoolSize;
+    };
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::File sourceFile;
+    juce::Time openedModificationTime;
+
+    const Header* header = nullptr;
+    const Row* rows = nullptr;
+    const juce::uint32* byId = nullptr;
+    const juce::uint32* byDateAdded = nullptr;
+    const Facet* rootFacets = nullptr;
+    const Facet* chordFacets = nullptr;
+    const juce::uint32* postings = nullptr;
+    const char* stringPool = nullptr;
+
+    juce::String getString(const StringRef& ref) const;
+    bool stringContains(const StringRef& ref, const std::string& lowerNeedle) const;
+    int findFacet(const Facet* facets, juce::uint32 count, const juce::String& name) const;
+    bool validateLayout(size_t fileSize) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibrarySnapshot)
+};
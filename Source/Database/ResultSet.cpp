@@ -0,0 +1,183 @@
+#include "ResultSet.h"
+
+namespace
+{
+    juce::uint32 fnv1a(const char* data, int numBytes)
+    {
+        juce::uint32 hash = 2166136261u;
+        for (int i = 0; i < numBytes; ++i)
+            hash = (hash ^ (juce::uint8) data[i]) * 16777619u;
+        return hash;
+    }
+}
+
+//==============================================================================
+ChopsDatabase::SampleInfo ResultSet::getSample(size_t index) const
+{
+    jassert(index < rows.size());
+    const auto& row = rows[index];
+
+    ChopsDatabase::SampleInfo info;
+    info.id = row.id;
+    info.originalFilename = textAt(row.originalFilename);
+    info.currentFilename = textAt(row.currentFilename);
+    info.filePath = textAt(row.filePath);
+    info.fileSize = row.fileSize;
+    info.contentHash = row.contentHash;
+    info.durationMs = row.durationMs;
+    info.sampleRate = row.sampleRate;
+    info.bitDepth = row.bitDepth;
+    info.channels = row.channels;
+    info.rootNote = atomString(row.rootNote);
+    info.chordType = atomString(row.chordType);
+    info.chordTypeDisplay = atomString(row.chordTypeDisplay);
+    info.extensions = atomList(row.extensions, ListFormat::json);
+    info.alterations = atomList(row.alterations, ListFormat::json);
+    info.addedNotes = atomList(row.addedNotes, ListFormat::json);
+    info.suspensions = atomList(row.suspensions, ListFormat::json);
+    info.bassNote = atomString(row.bassNote);
+    info.inversion = atomString(row.inversion);
+    info.dateAdded = juce::Time(row.dateAddedMs);
+    info.dateModified = juce::Time(row.dateModifiedMs);
+    info.tags = atomList(row.tags, ListFormat::commaSeparated);
+    info.rating = row.rating;
+
+    const auto& hex = atomString(row.colourHex);
+    info.color = hex.isNotEmpty() ? juce::Colour::fromString(hex) : juce::Colours::transparentBlack;
+
+    info.isFavorite = row.isFavorite;
+    info.playCount = row.playCount;
+    info.userNotes = textAt(row.userNotes);
+    info.lastPlayed = juce::Time(row.lastPlayedMs);
+    return info;
+}
+
+std::vector<ChopsDatabase::SampleInfo> ResultSet::toVector() const
+{
+    std::vector<ChopsDatabase::SampleInfo> samples;
+    samples.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+        samples.push_back(getSample(i));
+    return samples;
+}
+
+size_t ResultSet::getMemoryUsage() const
+{
+    return rows.capacity() * sizeof(Row)
+         + arena.capacity()
+         + atoms.capacity() * sizeof(Atom)
+         + slots.capacity() * sizeof(juce::uint32);
+}
+
+//==============================================================================
+void ResultSet::reserve(size_t numRows)
+{
+    rows.reserve(numRows);
+    arena.reserve(numRows * 96); // Typical file name, path and notes for one row
+}
+
+ResultSet::TextRef ResultSet::store(const char* utf8, int numBytes)
+{
+    if (utf8 == nullptr || numBytes <= 0)
+        return {};
+
+    jassert(arena.size() + (size_t) numBytes <= 0xffffffffu);
+    TextRef ref { (juce::uint32) arena.size(), (juce::uint32) numBytes };
+    arena.insert(arena.end(), utf8, utf8 + numBytes);
+    return ref;
+}
+
+juce::uint32 ResultSet::intern(const char* utf8, int numBytes)
+{
+    if (utf8 == nullptr || numBytes < 0)
+        numBytes = 0;
+
+    if (atoms.size() * 2 >= slots.size())
+        growSlots();
+
+    auto hash = fnv1a(utf8, numBytes);
+    auto mask = slots.size() - 1;
+
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        if (slots[slot] == 0)
+        {
+            Atom atom;
+            atom.text = store(utf8, numBytes);
+            atom.hash = hash;
+            atoms.push_back(std::move(atom));
+            slots[slot] = (juce::uint32) atoms.size();
+            return (juce::uint32) atoms.size() - 1;
+        }
+
+        const auto& candidate = atoms[slots[slot] - 1];
+        if (candidate.hash == hash && candidate.text.length == (juce::uint32) numBytes
+            && (numBytes == 0 || std::memcmp(arena.data() + candidate.text.offset, utf8, (size_t) numBytes) == 0))
+            return slots[slot] - 1;
+    }
+}
+
+void ResultSet::growSlots()
+{
+    std::vector<juce::uint32> grown(juce::jmax((size_t) 64, slots.size() * 2), 0);
+    auto mask = grown.size() - 1;
+
+    for (size_t i = 0; i < atoms.size(); ++i)
+    {
+        auto slot = atoms[i].hash & mask;
+        while (grown[slot] != 0)
+            slot = (slot + 1) & mask;
+        grown[slot] = (juce::uint32) i + 1;
+    }
+
+    slots.swap(grown);
+}
+
+bool ResultSet::isEmptyList(juce::uint32 atom, ListFormat format) const
+{
+    return atomList(atom, format).isEmpty();
+}
+
+//==============================================================================
+juce::String ResultSet::textAt(TextRef ref) const
+{
+    if (ref.length == 0)
+        return {};
+    return juce::String::fromUTF8(arena.data() + ref.offset, (int) ref.length);
+}
+
+const juce::String& ResultSet::atomString(juce::uint32 atom) const
+{
+    static const juce::String empty;
+    if (atom >= atoms.size())
+        return empty;
+
+    const auto& a = atoms[atom];
+    if (!a.hasString)
+    {
+        a.string = textAt(a.text);
+        a.hasString = true;
+    }
+    return a.string;
+}
+
+const juce::StringArray& ResultSet::atomList(juce::uint32 atom, ListFormat format) const
+{
+    static const juce::StringArray empty;
+    if (atom >= atoms.size())
+        return empty;
+
+    const auto& a = atoms[atom];
+    if (!a.hasList || a.listFormat != format)
+    {
+        const auto& text = atomString(atom);
+        if (format == ListFormat::json)
+            a.list = ChopsDatabase::parseJsonArray(text);
+        else
+            a.list = text.isNotEmpty() ? juce::StringArray::fromTokens(text, ",", "") : juce::StringArray();
+
+        a.listFormat = format;
+        a.hasList = true;
+    }
+    return a.list;
+}
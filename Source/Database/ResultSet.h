@@ -0,0 +1,130 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChopsDatabase.h"
+#include <iterator>
+#include <vector>
+
+/**
+ * ResultSet - compact, arena-backed rows returned by ChopsDatabase::searchSamples
+ *
+ * Each row is a fixed-size POD. Per-row text (file names, path, notes) lives in
+ * one byte arena owned by the set; values that repeat across rows (root note,
+ * chord type, the JSON lists, tags, colour) are interned once and referenced by
+ * ID, so a 10k-row result is a handful of allocations instead of several per row.
+ *
+ * SampleInfo is only built when a row is asked for, via operator[] or iteration.
+ * Atom IDs (e.g. getChordTypeId) are local to this set: equal IDs mean equal
+ * values. Not thread-safe; hand a set to one thread at a time.
+ */
+class ResultSet
+{
+public:
+    ResultSet() = default;
+    ResultSet(ResultSet&&) noexcept = default;
+    ResultSet& operator=(ResultSet&&) noexcept = default;
+
+    size_t size() const noexcept    { return rows.size(); }
+    bool empty() const noexcept     { return rows.empty(); }
+    bool isEmpty() const noexcept   { return rows.empty(); }
+
+    // Builds the full SampleInfo for a row
+    ChopsDatabase::SampleInfo getSample(size_t index) const;
+    ChopsDatabase::SampleInfo operator[](size_t index) const { return getSample(index); }
+
+    std::vector<ChopsDatabase::SampleInfo> toVector() const;
+
+    // Cheap per-row accessors that don't materialise the whole sample
+    int getId(size_t index) const                       { return rows[index].id; }
+    juce::uint32 getChordTypeId(size_t index) const     { return rows[index].chordType; }
+    const juce::String& getRootNote(size_t index) const { return atomString(rows[index].rootNote); }
+    const juce::String& getChordType(size_t index) const { return atomString(rows[index].chordType); }
+    juce::String getFilePath(size_t index) const        { return textAt(rows[index].filePath); }
+
+    // Bytes held by the rows, arena and intern table; for the benchmark
+    size_t getMemoryUsage() const;
+    size_t getNumDistinctValues() const { return atoms.size(); }
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ChopsDatabase::SampleInfo;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ChopsDatabase::SampleInfo;
+
+        Iterator(const ResultSet& s, size_t i) : set(&s), index(i) {}
+
+        ChopsDatabase::SampleInfo operator*() const { return set->getSample(index); }
+        Iterator& operator++()                      { ++index; return *this; }
+        Iterator operator++(int)                    { auto old = *this; ++index; return old; }
+        bool operator==(const Iterator& other) const { return index == other.index && set == other.set; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        const ResultSet* set;
+        size_t index;
+    };
+
+    Iterator begin() const { return { *this, 0 }; }
+    Iterator end() const   { return { *this, rows.size() }; }
+
+private:
+    friend class ChopsDatabase;
+
+    static constexpr juce::uint32 noAtom = 0xffffffff;
+
+    struct TextRef
+    {
+        juce::uint32 offset = 0;
+        juce::uint32 length = 0;
+    };
+
+    struct Row
+    {
+        juce::int64 fileSize;
+        juce::uint64 contentHash;
+        juce::int64 dateAddedMs, dateModifiedMs, lastPlayedMs;
+        TextRef originalFilename, currentFilename, filePath, userNotes;
+        juce::int32 id;
+        juce::int32 playCount;
+        juce::int32 durationMs, sampleRate;
+        juce::uint32 rootNote, chordType, chordTypeDisplay;
+        juce::uint32 extensions, alterations, addedNotes, suspensions;
+        juce::uint32 bassNote, inversion, colourHex, tags;
+        juce::uint8 rating, bitDepth, channels;
+        bool isFavorite;
+    };
+
+    // How an atom's text expands when a list field is materialised
+    enum class ListFormat { json, commaSeparated };
+
+    struct Atom
+    {
+        TextRef text;
+        juce::uint32 hash = 0;
+        mutable bool hasString = false, hasList = false;
+        mutable ListFormat listFormat = ListFormat::json;
+        mutable juce::String string;
+        mutable juce::StringArray list;
+    };
+
+    std::vector<Row> rows;
+    std::vector<char> arena;
+    std::vector<Atom> atoms;
+    std::vector<juce::uint32> slots; // Open-addressed intern table of atom index + 1
+
+    // Builder interface, used while stepping a statement
+    void reserve(size_t numRows);
+    TextRef store(const char* utf8, int numBytes);
+    juce::uint32 intern(const char* utf8, int numBytes);
+    bool isEmptyList(juce::uint32 atom, ListFormat format) const;
+    void growSlots();
+
+    juce::String textAt(TextRef ref) const;
+    const juce::String& atomString(juce::uint32 atom) const;
+    const juce::StringArray& atomList(juce::uint32 atom, ListFormat format) const;
+
+    JUCE_DECLARE_NON_COPYABLE(ResultSet)
+};
@@ -0,0 +1,114 @@
+#include "SampleCache.h"
+
+SampleCache::SampleCache(size_t maxEntriesToKeep)
+    : maxEntries(juce::jmax((size_t) 1, maxEntriesToKeep))
+{
+}
+
+//==============================================================================
+std::unique_ptr<ChopsDatabase::SampleInfo> SampleCache::getById(int sampleId)
+{
+    const juce::ScopedLock sl(lock);
+    auto found = byId.find(sampleId);
+    if (found == byId.end()) { ++misses; return nullptr; }
+
+    ++hits;
+    return touch(found->second);
+}
+
+std::unique_ptr<ChopsDatabase::SampleInfo> SampleCache::getByPath(const juce::String& filePath)
+{
+    const juce::ScopedLock sl(lock);
+    auto path = idByPath.find(filePath);
+    if (path == idByPath.end()) { ++misses; return nullptr; }
+
+    ++hits;
+    return touch(byId.at(path->second));
+}
+
+void SampleCache::put(const ChopsDatabase::SampleInfo& sample)
+{
+    if (sample.id <= 0) return;
+
+    const juce::ScopedLock sl(lock);
+    auto existing = byId.find(sample.id);
+    if (existing != byId.end())
+        erase(existing->second);
+
+    // A path can only belong to one row; a re-ingested file gets a new ID
+    auto samePath = idByPath.find(sample.filePath);
+    if (samePath != idByPath.end())
+        erase(byId.at(samePath->second));
+
+    entries.push_front(sample);
+    byId[sample.id] = entries.begin();
+    if (sample.filePath.isNotEmpty())
+        idByPath[sample.filePath] = sample.id;
+
+    while (entries.size() > maxEntries)
+        erase(std::prev(entries.end()));
+}
+
+void SampleCache::update(int sampleId, const std::function<void(ChopsDatabase::SampleInfo&)>& edit)
+{
+    const juce::ScopedLock sl(lock);
+    auto found = byId.find(sampleId);
+    if (found == byId.end()) return;
+
+    auto oldPath = found->second->filePath;
+    edit(*found->second);
+
+    if (found->second->filePath != oldPath)
+    {
+        idByPath.erase(oldPath);
+        if (found->second->filePath.isNotEmpty())
+            idByPath[found->second->filePath] = sampleId;
+    }
+}
+
+void SampleCache::invalidate(int sampleId)
+{
+    const juce::ScopedLock sl(lock);
+    auto found = byId.find(sampleId);
+    if (found != byId.end())
+        erase(found->second);
+}
+
+void SampleCache::invalidatePath(const juce::String& filePath)
+{
+    const juce::ScopedLock sl(lock);
+    auto found = idByPath.find(filePath);
+    if (found != idByPath.end())
+        erase(byId.at(found->second));
+}
+
+void SampleCache::clear()
+{
+    const juce::ScopedLock sl(lock);
+    entries.clear();
+    byId.clear();
+    idByPath.clear();
+}
+
+SampleCache::Stats SampleCache::getStats() const
+{
+    const juce::ScopedLock sl(lock);
+    return { hits, misses, entries.size() };
+}
+
+//==============================================================================
+std::unique_ptr<ChopsDatabase::SampleInfo> SampleCache::touch(std::list<Entry>::iterator it)
+{
+    entries.splice(entries.begin(), entries, it);
+    return std::make_unique<ChopsDatabase::SampleInfo>(*it);
+}
+
+void SampleCache::erase(std::list<Entry>::iterator it)
+{
+    auto path = idByPath.find(it->filePath);
+    if (path != idByPath.end() && path->second == it->id)
+        idByPath.erase(path);
+
+    byId.erase(it->id);
+    entries.erase(it);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChopsDatabase.h"
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * SampleCache - bounded LRU of decoded samples, keyed by ID and by file path
+ *
+ * Sits in front of the read database so selection, preview and the old-value
+ * lookups done for undo don't go back to SQLite for rows we have already
+ * decoded. The owner is responsible for invalidating (or patching) entries
+ * whenever it writes to a row. Thread-safe.
+ */
+class SampleCache
+{
+public:
+    explicit SampleCache(size_t maxEntries = 512);
+
+    std::unique_ptr<ChopsDatabase::SampleInfo> getById(int sampleId);
+    std::unique_ptr<ChopsDatabase::SampleInfo> getByPath(const juce::String& filePath);
+
+    void put(const ChopsDatabase::SampleInfo& sample);
+
+    // Applies an edit to the cached copy, if there is one. Used for write-through of
+    // single-field changes whose resulting value is known without re-reading the row.
+    void update(int sampleId, const std::function<void(ChopsDatabase::SampleInfo&)>& edit);
+
+    void invalidate(int sampleId);
+    void invalidatePath(const juce::String& filePath);
+    void clear();
+
+    struct Stats
+    {
+        juce::int64 hits = 0;
+        juce::int64 misses = 0;
+        size_t entries = 0;
+    };
+    Stats getStats() const;
+
+private:
+    using Entry = ChopsDatabase::SampleInfo;
+
+    size_t maxEntries;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<int, std::list<Entry>::iterator> byId;
+    std::unordered_map<juce::String, int> idByPath;
+    juce::int64 hits = 0, misses = 0;
+    juce::CriticalSection lock;
+
+    std::unique_ptr<Entry> touch(std::list<Entry>::iterator it);
+    void erase(std::list<Entry>::iterator it);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleCache)
+};
@@ -0,0 +1,223 @@
+#include "SearchService.h"
+
+SearchService::SearchService() : juce::Thread("ChopsSearch")
+{
+}
+
+SearchService::~SearchService()
+{
+    cancelPendingUpdate();
+    signalThreadShouldExit();
+    cancel();
+    notify();
+    stopThread(4000);
+
+    const juce::ScopedLock cl(connectionLock);
+    snapshot.close();
+    database.close();
+}
+
+//==============================================================================
+void SearchService::setDatabase(const juce::File& newDatabaseFile, const juce::File& newSnapshotFile)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        databaseFile = newDatabaseFile;
+        snapshotFile = newSnapshotFile;
+        reopenRequested = true;
+    }
+
+    if (!isThreadRunning())
+        startThread();
+
+    notify();
+}
+
+juce::uint64 SearchService::search(const Request& request, ResultCallback onResults)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    const juce::ScopedLock sl(lock);
+    auto generation = ++latestGeneration;
+
+    pendingJob = { generation, request, std::move(onResults) };
+    hasPendingJob = true;
+
+    if (runningGeneration != 0)
+        interruptRunningSearch();
+
+    notify();
+    return generation;
+}
+
+void SearchService::cancel()
+{
+    const juce::ScopedLock sl(lock);
+    ++latestGeneration;
+    hasPendingJob = false;
+    pendingJob = {};
+
+    if (runningGeneration != 0)
+        interruptRunningSearch();
+}
+
+void SearchService::markSampleModified(int sampleId)
+{
+    const juce::ScopedLock sl(lock);
+    modifiedIds.add(sampleId);
+}
+
+void SearchService::snapshotRepublished()
+{
+    {
+        const juce::ScopedLock sl(lock);
+        reopenRequested = true;
+    }
+
+    notify();
+}
+
+void SearchService::interruptRunningSearch()
+{
+    const juce::ScopedLock cl(connectionLock);
+    database.interrupt();
+}
+
+//==============================================================================
+void SearchService::run()
+{
+    while (!threadShouldExit())
+    {
+        Job job;
+        bool reopen = false;
+
+        {
+            const juce::ScopedLock sl(lock);
+            if (hasPendingJob)
+            {
+                job = std::move(pendingJob);
+                hasPendingJob = false;
+                runningGeneration = job.generation;
+            }
+            reopen = std::exchange(reopenRequested, false);
+        }
+
+        if (reopen)
+            reopenConnection();
+
+        if (job.generation == 0)
+        {
+            wait(-1);
+            continue;
+        }
+
+        auto results = perform(job.request);
+
+        const juce::ScopedLock sl(lock);
+        runningGeneration = 0;
+
+        // A newer request arrived while this one ran; its results are already stale
+        if (job.generation != latestGeneration.load())
+            continue;
+
+        completedJob = std::move(job);
+        completedResults = std::move(results);
+        hasCompletedJob = true;
+        triggerAsyncUpdate();
+    }
+}
+
+void SearchService::handleAsyncUpdate()
+{
+    Job job;
+    std::vector<ChopsDatabase::SampleInfo> results;
+
+    {
+        const juce::ScopedLock sl(lock);
+        if (!hasCompletedJob)
+            return;
+
+        job = std::move(completedJob);
+        results = std::move(completedResults);
+        hasCompletedJob = false;
+    }
+
+    // Re-check here too: a search may have been submitted after the worker finished
+    if (job.generation == latestGeneration.load() && job.onResults)
+        job.onResults(results);
+}
+
+//==============================================================================
+void SearchService::reopenConnection()
+{
+    juce::File dbFile, snapFile;
+    {
+        const juce::ScopedLock sl(lock);
+        dbFile = databaseFile;
+        snapFile = snapshotFile;
+        modifiedIds.clear();
+    }
+
+    const juce::ScopedLock cl(connectionLock);
+    database.close();
+    snapshot.close();
+
+    if (snapFile != juce::File() && snapFile.existsAsFile())
+        snapshot.open(snapFile);
+}
+
+bool SearchService::openDatabaseIfNeeded()
+{
+    if (database.isOpen())
+        return true;
+
+    juce::File dbFile;
+    {
+        const juce::ScopedLock sl(lock);
+        dbFile = databaseFile;
+    }
+
+    if (!dbFile.existsAsFile())
+        return false;
+
+    const juce::ScopedLock cl(connectionLock);
+    if (!database.open(dbFile.getFullPathName()))
+    {
+        juce::Logger::writeToLog("SearchService: Failed to open " + dbFile.getFullPathName());
+        return false;
+    }
+    return true;
+}
+
+std::vector<ChopsDatabase::SampleInfo> SearchService::perform(const Request& request)
+{
+    if (snapshot.isValid())
+    {
+        auto results = snapshot.searchSamples(request.query, request.rootNote, request.chordType,
+                                              request.hasExtensions, request.hasAlterations,
+                                              request.limit, request.offset, request.format);
+
+        juce::SortedSet<int> modified;
+        {
+            const juce::ScopedLock sl(lock);
+            modified = modifiedIds;
+        }
+
+        if (!modified.isEmpty() && openDatabaseIfNeeded())
+        {
+            for (auto& sample : results)
+                if (modified.contains(sample.id))
+                    if (auto fresh = database.getSampleById(sample.id))
+                        sample = *fresh;
+        }
+
+        return results;
+    }
+
+    if (!openDatabaseIfNeeded())
+        return {};
+
+    return database.searchSamples(request.query, request.rootNote, request.chordType,
+                                  request.hasExtensions, request.hasAlterations,
+                                  request.limit, request.offset, request.format).toVector();
+}
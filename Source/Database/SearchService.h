@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChopsDatabase.h"
+#include "LibrarySnapshot.h"
+#include <functional>
+#include <vector>
+
+/**
+ * SearchService - runs library searches on a background thread
+ *
+ * Each call to search() gets a new generation number. Submitting a request
+ * replaces any request that hasn't started yet and interrupts the one that is
+ * running (sqlite3_interrupt), so typing never queues stale queries. Only the
+ * newest generation's results are delivered, on the message thread.
+ *
+ * The worker owns its own mapping of the library snapshot, and a SQLite
+ * connection it opens only when the snapshot can't answer on its own; nothing
+ * it touches is shared with the message thread.
+ */
+class SearchService : private juce::Thread,
+                      private juce::AsyncUpdater
+{
+public:
+    struct Request
+    {
+        juce::String query;
+        juce::String rootNote;
+        juce::String chordType;
+        ChopsDatabase::BoolFilter hasExtensions = ChopsDatabase::DontCare;
+        ChopsDatabase::BoolFilter hasAlterations = ChopsDatabase::DontCare;
+        ChopsDatabase::FormatFilter format;     // Length, sample rate and channel bounds
+        int limit = 100;
+        int offset = 0;
+    };
+
+    using ResultCallback = std::function<void(const std::vector<ChopsDatabase::SampleInfo>& results)>;
+
+    SearchService();
+    ~SearchService() override;
+
+    // The snapshot is optional; when it is missing or invalid the worker searches SQLite
+    void setDatabase(const juce::File& databaseFile, const juce::File& snapshotFile = {});
+
+    // Message thread only. onResults is called on the message thread, and only if
+    // no newer search has been submitted by then. Returns the request's generation.
+    juce::uint64 search(const Request& request, ResultCallback onResults);
+
+    // Drops the pending request and interrupts the running one
+    void cancel();
+
+    juce::uint64 getLatestGeneration() const { return latestGeneration.load(); }
+
+    // Rows edited since the snapshot was published are re-read from SQLite
+    void markSampleModified(int sampleId);
+
+    // Call when a new snapshot has been published (the owner of this service polls for
+    // that); the worker maps it before its next search
+    void snapshotRepublished();
+
+private:
+    juce::File databaseFile, snapshotFile;
+    bool reopenRequested = false;
+
+    ChopsDatabase database;
+    LibrarySnapshot snapshot;
+    juce::SortedSet<int> modifiedIds;
+
+    // Guards the pending/completed slots and the fields above that the message thread writes
+    juce::CriticalSection lock;
+    // Held while the worker opens or closes its connection, so interrupt() never races it
+    juce::CriticalSection connectionLock;
+
+    struct Job
+    {
+        juce::uint64 generation = 0;
+        Request request;
+        ResultCallback onResults;
+    };
+
+    Job pendingJob;
+    bool hasPendingJob = false;
+    juce::uint64 runningGeneration = 0;
+
+    Job completedJob;
+    std::vector<ChopsDatabase::SampleInfo> completedResults;
+    bool hasCompletedJob = false;
+
+    std::atomic<juce::uint64> latestGeneration { 0 };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    void reopenConnection();
+    bool openDatabaseIfNeeded();
+    std::vector<ChopsDatabase::SampleInfo> perform(const Request& request);
+    void interruptRunningSearch();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SearchService)
+};
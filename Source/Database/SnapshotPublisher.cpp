@@ -0,0 +1,220 @@
+#include "SnapshotPublisher.h"
+#include "LibrarySnapshot.h"
+#include <map>
+
+namespace
+{
+    // The publisher for each snapshot file in this process. juce::InterProcessLock is held
+    // per process on POSIX (and closing any handle to its file drops it), so instances in
+    // one DAW have to settle it among themselves before one of them takes the lock.
+    juce::CriticalSection& getRegistryLock()
+    {
+        static juce::CriticalSection registryLock;
+        return registryLock;
+    }
+
+    std::map<juce::String, SnapshotPublisher*>& getRegistry()
+    {
+        static std::map<juce::String, SnapshotPublisher*> registry;
+        return registry;
+    }
+}
+
+SnapshotPublisher::SnapshotPublisher() : juce::Thread("ChopsSnapshotPublisher")
+{
+}
+
+SnapshotPublisher::~SnapshotPublisher()
+{
+    resign();
+}
+
+//==============================================================================
+void SnapshotPublisher::setDatabase(const juce::File& newDatabaseFile, const juce::File& newSnapshotFile)
+{
+    resign();
+
+    const juce::ScopedLock sl(lock);
+    databaseFile = newDatabaseFile;
+    snapshotFile = newSnapshotFile;
+}
+
+bool SnapshotPublisher::claim()
+{
+    juce::File target;
+    {
+        const juce::ScopedLock sl(lock);
+        target = snapshotFile;
+    }
+
+    if (target == juce::File())
+        return false;
+
+    const juce::ScopedLock rl(getRegistryLock());
+    auto& registry = getRegistry();
+    auto key = target.getFullPathName();
+
+    if (auto existing = registry.find(key); existing != registry.end())
+        return existing->second == this;
+
+    auto interProcessLock = std::make_unique<juce::InterProcessLock>("ChopsSnapshotPublisher_"
+                                                                     + juce::String::toHexString(key.hashCode64()));
+    if (!interProcessLock->enter(0))
+        return false; // Another process publishes this snapshot
+
+    registry[key] = this;
+    publisherLock = std::move(interProcessLock);
+    claimedSnapshotPath = key;
+
+    {
+        const juce::ScopedLock sl(lock);
+        reopenRequested = true;
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::background);
+
+    notify();
+    juce::Logger::writeToLog("SnapshotPublisher: Publishing " + key);
+    return true;
+}
+
+bool SnapshotPublisher::isPublisher() const
+{
+    const juce::ScopedLock rl(getRegistryLock());
+    return publisherLock != nullptr;
+}
+
+void SnapshotPublisher::requestPublish()
+{
+    {
+        const juce::ScopedLock sl(lock);
+        ++stats.requests;
+    }
+
+    if (claim())
+    {
+        schedulePublish();
+        return;
+    }
+
+    // Another instance in this process may be the publisher; if it's another process,
+    // it sees the commit through data_version instead
+    juce::File target;
+    {
+        const juce::ScopedLock sl(lock);
+        target = snapshotFile;
+    }
+
+    const juce::ScopedLock rl(getRegistryLock());
+    auto& registry = getRegistry();
+    if (auto publisher = registry.find(target.getFullPathName()); publisher != registry.end())
+        publisher->second->schedulePublish();
+}
+
+SnapshotPublisher::Stats SnapshotPublisher::getStats() const
+{
+    const juce::ScopedLock sl(lock);
+    return stats;
+}
+
+//==============================================================================
+void SnapshotPublisher::schedulePublish()
+{
+    lastRequest = juce::Time::getMillisecondCounterHiRes();
+    publishRequested = true;
+    notify();
+}
+
+void SnapshotPublisher::resign()
+{
+    {
+        const juce::ScopedLock rl(getRegistryLock());
+        if (publisherLock == nullptr)
+            return;
+    }
+
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+    database.close();
+    publishRequested = false;
+
+    // Still registered until now, so nobody in this process takes the lock while it's held
+    // here; releasing this handle would drop theirs too
+    const juce::ScopedLock rl(getRegistryLock());
+    getRegistry().erase(claimedSnapshotPath);
+    claimedSnapshotPath.clear();
+    publisherLock.reset();
+}
+
+//==============================================================================
+void SnapshotPublisher::run()
+{
+    while (!threadShouldExit())
+    {
+        bool reopen;
+        juce::File target;
+        {
+            const juce::ScopedLock sl(lock);
+            reopen = std::exchange(reopenRequested, false);
+            target = snapshotFile;
+        }
+
+        if (reopen)
+        {
+            reopenConnection();
+            lastDataVersion = database.getDataVersion();
+        }
+
+        if (!publishRequested.load())
+        {
+            wait(pollIntervalMs);
+
+            // Commits made on any other connection, including writers that lost the election
+            auto version = database.getDataVersion();
+            if (version != lastDataVersion)
+            {
+                lastDataVersion = version;
+                schedulePublish();
+            }
+            continue;
+        }
+
+        // Wait for the writes to settle; every new request restarts the wait
+        auto quietFor = juce::Time::getMillisecondCounterHiRes() - lastRequest.load();
+        if (quietFor < settleMs)
+        {
+            wait(juce::jmax(1, (int) (settleMs - quietFor)));
+            continue;
+        }
+
+        publishRequested = false;
+        if (!database.isOpen() || target == juce::File())
+            continue;
+
+        // Taken first, so anything committed while publishing is published again
+        lastDataVersion = database.getDataVersion();
+        bool ok = LibrarySnapshot::publish(database, target);
+        database.releaseReadLocks(); // Don't hold back checkpoints until the next publish
+
+        const juce::ScopedLock sl(lock);
+        ++(ok ? stats.published : stats.failures);
+    }
+}
+
+void SnapshotPublisher::reopenConnection()
+{
+    juce::File file;
+    {
+        const juce::ScopedLock sl(lock);
+        file = databaseFile;
+    }
+
+    database.close();
+    if (file == juce::File() || !file.existsAsFile())
+        return;
+
+    if (!database.open(file.getFullPathName()))
+        juce::Logger::writeToLog("SnapshotPublisher: Failed to open " + file.getFullPathName());
+}
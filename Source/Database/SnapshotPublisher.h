@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChopsDatabase.h"
+#include <atomic>
+
+/**
+ * SnapshotPublisher - keeps the LibrarySnapshot in step with the database
+ *
+ * Only one publisher per snapshot file runs at a time, across every process and
+ * plugin instance: whichever claims it first. The standalone app claims it when it
+ * opens the library; a plugin instance only tries once it has written something and
+ * nobody else is publishing. The publisher watches the database (PRAGMA data_version),
+ * so commits from anyone that lost the election are picked up within a second.
+ *
+ * Requests are debounced: the snapshot is rebuilt once the writes have stopped for
+ * settleMs, so a batch of edits costs one publish rather than one each. Publishing
+ * runs on a background thread with its own read connection, both of which exist
+ * only while this instance is the publisher.
+ */
+class SnapshotPublisher : private juce::Thread
+{
+public:
+    struct Stats
+    {
+        int requests = 0;
+        int published = 0;
+        int failures = 0;
+    };
+
+    SnapshotPublisher();
+    ~SnapshotPublisher() override;
+
+    // Gives up publishing for the previous files; an empty File leaves it at that
+    void setDatabase(const juce::File& databaseFile, const juce::File& snapshotFile);
+
+    // Becomes the publisher if nobody else is. Returns true if this instance is it.
+    bool claim();
+    bool isPublisher() const;
+
+    // Call after every committed write; the publish follows once writes settle, here
+    // or wherever the publisher is
+    void requestPublish();
+
+    Stats getStats() const;
+
+private:
+    static constexpr double settleMs = 500.0;
+    static constexpr int pollIntervalMs = 1000;
+
+    mutable juce::CriticalSection lock;  // Guards the fields below
+    juce::File databaseFile, snapshotFile;
+    bool reopenRequested = false;
+    Stats stats;
+
+    // Held while this instance is the publisher; guarded by the registry lock in the .cpp
+    std::unique_ptr<juce::InterProcessLock> publisherLock;
+    juce::String claimedSnapshotPath;
+
+    std::atomic<bool> publishRequested { false };
+    std::atomic<double> lastRequest { 0.0 };
+
+    ChopsDatabase database;              // Publisher thread only
+    juce::int64 lastDataVersion = -1;    // Publisher thread only
+
+    void schedulePublish();
+    void resign();
+
+    void run() override;
+    void reopenConnection();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SnapshotPublisher)
+};
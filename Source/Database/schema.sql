@@ -1,4 +1,8 @@
 -- Chops Library Database Schema
+-- Timestamps are INTEGER milliseconds since the Unix epoch (UTC).
+
+-- Must precede the first table; lets background maintenance return free pages incrementally
+PRAGMA auto_vacuum = INCREMENTAL;
 
 CREATE TABLE IF NOT EXISTS samples (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -6,6 +10,11 @@ CREATE TABLE IF NOT EXISTS samples (
     current_filename TEXT NOT NULL,
     file_path TEXT NOT NULL UNIQUE,
     file_size INTEGER,
+    content_hash INTEGER,  -- XXH64 of the audio data only (see ContentHash); NULL until computed
+    file_mtime_ms INTEGER, -- File stamp at the last sync, with file_size; lets re-scans skip unchanged files
+    file_inode INTEGER,    -- and follow renames. NULL/0 where the platform has no inode
+    file_device INTEGER,
+    file_synced_ms INTEGER,
     
     root_note TEXT,
     chord_type TEXT,
@@ -19,13 +28,13 @@ CREATE TABLE IF NOT EXISTS samples (
     bass_note TEXT,
     inversion TEXT,
     
-    date_added TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-    date_modified TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    date_added INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)),
+    date_modified INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)),
     processing_version TEXT,
     
     search_text TEXT,
     
-    duration_ms INTEGER,
+    duration_ms INTEGER,   -- From the file header (AudioHeaderProbe); NULL until probed
     sample_rate INTEGER,
     bit_depth INTEGER,
     channels INTEGER,
@@ -37,7 +46,7 @@ CREATE TABLE IF NOT EXISTS samples (
     is_favorite INTEGER DEFAULT 0,
     play_count INTEGER DEFAULT 0,
     user_notes TEXT,
-    last_played TIMESTAMP
+    last_played INTEGER
 );
 
 CREATE TABLE IF NOT EXISTS tags (
@@ -48,14 +57,40 @@ CREATE TABLE IF NOT EXISTS tags (
 CREATE TABLE IF NOT EXISTS sample_tags (
     sample_id INTEGER NOT NULL,
     tag_id INTEGER NOT NULL,
-    date_added TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    date_added INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)),
     PRIMARY KEY (sample_id, tag_id),
     FOREIGN KEY (sample_id) REFERENCES samples(id) ON DELETE CASCADE,
     FOREIGN KEY (tag_id) REFERENCES tags(id) ON DELETE CASCADE
 );
 
+-- Collections: manual ones hold an ordered member list, smart ones store JSON criteria and
+-- keep a materialized member list (position = sample id) that the app refreshes incrementally.
+CREATE TABLE IF NOT EXISTS collections (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    name TEXT NOT NULL,
+    description TEXT,
+    is_smart INTEGER DEFAULT 0,
+    criteria TEXT,
+    date_created INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER))
+);
+
+CREATE TABLE IF NOT EXISTS collection_samples (
+    collection_id INTEGER NOT NULL,
+    position INTEGER NOT NULL,
+    sample_id INTEGER NOT NULL,
+    PRIMARY KEY (collection_id, position),
+    UNIQUE (collection_id, sample_id),
+    FOREIGN KEY (collection_id) REFERENCES collections(id) ON DELETE CASCADE,
+    FOREIGN KEY (sample_id) REFERENCES samples(id) ON DELETE CASCADE
+) WITHOUT ROWID;
+
 CREATE INDEX IF NOT EXISTS idx_samples_root_note ON samples(root_note);
 CREATE INDEX IF NOT EXISTS idx_samples_chord_type ON samples(chord_type);
 CREATE INDEX IF NOT EXISTS idx_samples_search_text ON samples(search_text);
 CREATE INDEX IF NOT EXISTS idx_samples_rating ON samples(rating);
 CREATE INDEX IF NOT EXISTS idx_samples_is_favorite ON samples(is_favorite);
+CREATE INDEX IF NOT EXISTS idx_samples_content_hash ON samples(content_hash);
+CREATE INDEX IF NOT EXISTS idx_samples_file_inode ON samples(file_inode, file_device);
+CREATE INDEX IF NOT EXISTS idx_samples_duration ON samples(duration_ms);
+CREATE INDEX IF NOT EXISTS idx_samples_format ON samples(sample_rate, bit_depth, channels);
+CREATE INDEX IF NOT EXISTS idx_collection_samples_sample ON collection_samples(sample_id);
@@ -30,6 +30,12 @@ namespace ChopsConfig
             .getChildFile("chops_library.sqlite");
     }
     
+    // Read-only snapshot republished after library writes, mapped by plugin instances
+    inline File getLibrarySnapshotFile(const File& databaseFile = getDatabaseFile())
+    {
+        return databaseFile.getSiblingFile("chops_library.snapshot");
+    }
+    
     inline File getConfigFile()
     {
         return getDefaultLibraryDirectory()
@@ -58,6 +64,7 @@ namespace ChopsConfig
         const String uploadFolder = "1. Chops upload";
         const String processedFolder = "2. Processed";
         const String mismatchFolder = "3. Filename mismatch";
+        const String duplicatesFolder = "4. Duplicates";
     }
     
     // Audio file extensions
@@ -0,0 +1,324 @@
+#include "AudioHeaderProbe.h"
+#include <cmath>
+
+namespace
+{
+    using Info = AudioHeaderProbe::Info;
+
+    int toMilliseconds(juce::int64 frames, int sampleRate)
+    {
+        if (frames <= 0 || sampleRate <= 0)
+            return 0;
+        return (int) juce::jmin((juce::int64) std::numeric_limits<int>::max(), frames * 1000 / sampleRate);
+    }
+
+    //==============================================================================
+    // Positioned just after the 12-byte FORM header
+    Info probeAiff(juce::InputStream& stream)
+    {
+        char id[4];
+
+        while (stream.read(id, 4) == 4)
+        {
+            juce::int64 size = (juce::uint32) stream.readIntBigEndian();
+            auto payloadStart = stream.getPosition();
+
+            if (memcmp(id, "COMM", 4) == 0)
+                return AudioHeaderProbe::readAiffCommon(stream, size);
+
+            if (!stream.setPosition(payloadStart + size + (size & 1)))
+                break;
+        }
+        return {};
+    }
+
+    //==============================================================================
+    // STREAMINFO is always the first metadata block
+    Info probeFlac(juce::InputStream& stream, juce::int64 start)
+    {
+        juce::uint8 block[4 + 34];
+        if (!stream.setPosition(start + 4) || stream.read(block, sizeof(block)) != (int) sizeof(block))
+            return {};
+
+        auto type = block[0] & 0x7f;
+        auto length = (block[1] << 16) | (block[2] << 8) | block[3];
+        if (type != 0 || length < 34)
+            return {};
+
+        // After the block and frame size limits: 20 bits rate, 3 bits channels - 1,
+        // 5 bits bits-per-sample - 1, 36 bits total samples
+        const auto* p = block + 4 + 10;
+        Info info;
+        info.sampleRate = (p[0] << 12) | (p[1] << 4) | (p[2] >> 4);
+        info.channels = ((p[2] >> 1) & 7) + 1;
+        info.bitDepth = (((p[2] & 1) << 4) | (p[3] >> 4)) + 1;
+        auto totalSamples = ((juce::int64) (p[3] & 0x0f) << 32) | (juce::int64) juce::ByteOrder::bigEndianInt(p + 4);
+        info.durationMs = toMilliseconds(totalSamples, info.sampleRate);
+        return info;
+    }
+
+    //==============================================================================
+    struct MpegFrame
+    {
+        bool isMpeg1 = false;
+        int layer = 0;
+        int bitrate = 0;            // Bits per second
+        int sampleRate = 0;
+        int channels = 0;
+        int samplesPerFrame = 0;
+        int length = 0;             // Bytes, including the header
+
+        bool parse(const juce::uint8* p)
+        {
+            if (p[0] != 0xff || (p[1] & 0xe0) != 0xe0)
+                return false;
+
+            auto version = (p[1] >> 3) & 3;     // 0 = MPEG 2.5, 2 = MPEG 2, 3 = MPEG 1
+            auto layerBits = (p[1] >> 1) & 3;   // 1 = III, 2 = II, 3 = I
+            auto bitrateIndex = p[2] >> 4;
+            auto rateIndex = (p[2] >> 2) & 3;
+            if (version == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3)
+                return false; // Reserved values; free-format streams aren't timed
+
+            static const short bitrates[2][3][15] = {
+                { { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+                  { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+                  { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 } },
+                { { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+                  { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+                  { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 } }
+            };
+            static const int sampleRates[3] = { 44100, 48000, 32000 };
+
+            isMpeg1 = version == 3;
+            layer = 4 - layerBits;
+            bitrate = bitrates[isMpeg1 ? 0 : 1][layer - 1][bitrateIndex] * 1000;
+            sampleRate = sampleRates[rateIndex] >> (isMpeg1 ? 0 : (version == 2 ? 1 : 2));
+            channels = ((p[3] >> 6) & 3) == 3 ? 1 : 2;
+            samplesPerFrame = layer == 1 ? 384 : (layer == 3 && !isMpeg1 ? 576 : 1152);
+
+            auto padding = (p[2] >> 1) & 1;
+            length = layer == 1 ? (12 * bitrate / sampleRate + padding) * 4
+                                : samplesPerFrame / 8 * bitrate / sampleRate + padding;
+            return length > 4;
+        }
+    };
+
+    Info probeMpeg(juce::InputStream& stream, juce::int64 start)
+    {
+        // Encoders may leave junk before the first frame; look through the first 64 KB
+        constexpr int window = 65536;
+        juce::HeapBlock<juce::uint8> buffer(window);
+        if (!stream.setPosition(start))
+            return {};
+        auto numBytes = stream.read(buffer, window);
+
+        MpegFrame frame;
+        int frameStart = -1;
+        for (int i = 0; i + 4 <= numBytes && frameStart < 0; ++i)
+        {
+            if (!frame.parse(buffer + i))
+                continue;
+
+            // A false sync rarely has a matching frame right behind it
+            MpegFrame following;
+            auto next = i + frame.length;
+            if (next + 4 > numBytes
+                || (following.parse(buffer + next) && following.sampleRate == frame.sampleRate && following.layer == frame.layer))
+                frameStart = i;
+        }
+        if (frameStart < 0)
+            return {};
+
+        Info info;
+        info.sampleRate = frame.sampleRate;
+        info.channels = frame.channels;
+
+        auto bigEndian = [&](int offset) { return offset + 4 <= numBytes ? (juce::int64) juce::ByteOrder::bigEndianInt(buffer + offset) : 0; };
+        auto matches = [&](int offset, const char* id) { return offset + 4 <= numBytes && memcmp(buffer + offset, id, 4) == 0; };
+
+        // Xing/Info follows the side information of the first frame
+        auto sideInfoSize = frame.isMpeg1 ? (frame.channels == 1 ? 17 : 32) : (frame.channels == 1 ? 9 : 17);
+        auto xing = frameStart + 4 + sideInfoSize;
+        if (frame.layer == 3 && (matches(xing, "Xing") || matches(xing, "Info")))
+        {
+            auto flags = bigEndian(xing + 4);
+            auto p = xing + 8;
+            juce::int64 frames = 0;
+            if (flags & 1) { frames = bigEndian(p); p += 4; }
+            if (flags & 2) p += 4;      // Byte count
+            if (flags & 4) p += 100;    // Seek table
+            if (flags & 8) p += 4;      // Quality
+
+            if (frames > 0)
+            {
+                auto samples = frames * frame.samplesPerFrame;
+
+                // LAME and FFmpeg record the encoder delay and padding for gapless playback
+                if ((matches(p, "LAME") || matches(p, "Lavf") || matches(p, "Lavc")) && p + 24 <= numBytes)
+                {
+                    auto delay = (buffer[p + 21] << 4) | (buffer[p + 22] >> 4);
+                    auto padding = ((buffer[p + 22] & 0x0f) << 8) | buffer[p + 23];
+                    if (samples > delay + padding)
+                        samples -= delay + padding;
+                }
+
+                info.durationMs = toMilliseconds(samples, info.sampleRate);
+                return info;
+            }
+        }
+
+        // Fraunhofer's VBR header sits 32 bytes after the frame header
+        auto vbri = frameStart + 4 + 32;
+        if (matches(vbri, "VBRI"))
+        {
+            auto frames = bigEndian(vbri + 14);
+            if (frames > 0)
+            {
+                info.durationMs = toMilliseconds(frames * frame.samplesPerFrame, info.sampleRate);
+                return info;
+            }
+        }
+
+        // CBR: time the bytes between the first frame and any ID3v1 tag at the end
+        auto totalLength = stream.getTotalLength();
+        auto audioBytes = totalLength - (start + frameStart);
+        char tag[3];
+        if (totalLength >= 128 && stream.setPosition(totalLength - 128) && stream.read(tag, 3) == 3 && memcmp(tag, "TAG", 3) == 0)
+            audioBytes -= 128;
+        if (audioBytes > 0)
+            info.durationMs = (int) juce::jmin((juce::int64) std::numeric_limits<int>::max(), audioBytes * 8000 / frame.bitrate);
+        return info;
+    }
+}
+
+//==============================================================================
+void AudioHeaderProbe::WaveChunks::add(const RiffChunkReader::Chunk& chunk)
+{
+    if (chunk.is("fmt ") && !hasFmt)
+    {
+        fmt = chunk;
+        hasFmt = true;
+    }
+    else if (chunk.is("fact") && !hasFact)
+    {
+        fact = chunk;
+        hasFact = true;
+    }
+    else if (chunk.is("data") && !hasData)
+    {
+        dataSize = chunk.size;
+        hasData = true;
+    }
+}
+
+AudioHeaderProbe::Info AudioHeaderProbe::WaveChunks::read(RiffChunkReader& reader) const
+{
+    Info info;
+    juce::MemoryBlock block;
+    if (!hasFmt || fmt.size < 16 || !reader.readPayload(fmt, block, 1024))
+        return info;
+
+    const auto* p = static_cast<const juce::uint8*>(block.getData());
+    auto formatTag = juce::ByteOrder::littleEndianShort(p);
+    info.channels = juce::ByteOrder::littleEndianShort(p + 2);
+    info.sampleRate = (int) juce::ByteOrder::littleEndianInt(p + 4);
+    auto bytesPerSecond = (juce::int64) juce::ByteOrder::littleEndianInt(p + 8);
+    auto blockAlign = juce::ByteOrder::littleEndianShort(p + 12);
+    info.bitDepth = juce::ByteOrder::littleEndianShort(p + 14);
+
+    // WAVE_FORMAT_EXTENSIBLE: valid bits and the real format tag (first two bytes of the GUID)
+    if (formatTag == 0xfffe && fmt.size >= 40)
+    {
+        if (auto validBits = juce::ByteOrder::littleEndianShort(p + 18))
+            info.bitDepth = validBits;
+        formatTag = juce::ByteOrder::littleEndianShort(p + 24);
+    }
+
+    // PCM, float, A-law and mu-law have fixed-size frames; compressed data says how long it is in 'fact'
+    bool isUncompressed = formatTag == 1 || formatTag == 3 || formatTag == 6 || formatTag == 7;
+    if (isUncompressed && blockAlign > 0 && hasData)
+    {
+        info.durationMs = toMilliseconds(dataSize / blockAlign, info.sampleRate);
+    }
+    else if (hasFact && reader.readPayload(fact, block, 64) && block.getSize() >= 4)
+    {
+        info.durationMs = toMilliseconds(juce::ByteOrder::littleEndianInt(block.getData()), info.sampleRate);
+    }
+    else if (bytesPerSecond > 0 && hasData)
+    {
+        info.durationMs = (int) juce::jmin((juce::int64) std::numeric_limits<int>::max(), dataSize * 1000 / bytesPerSecond);
+    }
+    return info;
+}
+
+AudioHeaderProbe::Info AudioHeaderProbe::readAiffCommon(juce::InputStream& stream, juce::int64 chunkSize)
+{
+    if (chunkSize < 18)
+        return {};
+
+    Info info;
+    info.channels = stream.readShortBigEndian();
+    juce::int64 frames = (juce::uint32) stream.readIntBigEndian();
+    info.bitDepth = stream.readShortBigEndian();
+
+    // The sample rate is an 80-bit IEEE 754 extended float
+    juce::uint8 rate[10];
+    if (stream.read(rate, 10) != 10)
+        return {};
+    auto exponent = ((rate[0] & 0x7f) << 8) | rate[1];
+    auto mantissa = juce::ByteOrder::bigEndianInt64(rate + 2);
+    auto sampleRate = std::ldexp((double) mantissa, exponent - 16383 - 63);
+    info.sampleRate = sampleRate >= 1.0 && sampleRate < 10000000.0 ? juce::roundToInt(sampleRate) : 0;
+
+    info.durationMs = toMilliseconds(frames, info.sampleRate);
+    return info;
+}
+
+//==============================================================================
+AudioHeaderProbe::Info AudioHeaderProbe::probe(const juce::File& audioFile)
+{
+    juce::FileInputStream stream(audioFile);
+    if (!stream.openedOk())
+        return {};
+    return probe(stream);
+}
+
+AudioHeaderProbe::Info AudioHeaderProbe::probe(juce::InputStream& stream)
+{
+    juce::uint8 header[12] = {};
+    if (!stream.setPosition(0) || stream.read(header, 12) != 12)
+        return {};
+
+    if (memcmp(header + 8, "WAVE", 4) == 0)
+    {
+        RiffChunkReader reader(stream);
+        WaveChunks chunks;
+        RiffChunkReader::Chunk chunk;
+        while (!chunks.hasFormatAndData() && reader.next(chunk))
+            chunks.add(chunk);
+        return chunks.read(reader);
+    }
+
+    if (memcmp(header, "FORM", 4) == 0 && (memcmp(header + 8, "AIFF", 4) == 0 || memcmp(header + 8, "AIFC", 4) == 0))
+        return probeAiff(stream);
+
+    // FLAC and MP3 may start with an ID3v2 tag, whose size is a 28-bit syncsafe integer
+    juce::int64 start = 0;
+    if (memcmp(header, "ID3", 3) == 0)
+    {
+        start = 10 + ((header[6] & 0x7f) << 21 | (header[7] & 0x7f) << 14 | (header[8] & 0x7f) << 7 | (header[9] & 0x7f));
+        if ((header[5] & 0x10) != 0)
+            start += 10; // Footer
+        if (!stream.setPosition(start) || stream.read(header, 4) != 4)
+            return {};
+    }
+
+    if (memcmp(header, "fLaC", 4) == 0)
+        return probeFlac(stream, start);
+
+    if (start > 0 || (header[0] == 0xff && (header[1] & 0xe0) == 0xe0))
+        return probeMpeg(stream, start);
+
+    return {};
+}
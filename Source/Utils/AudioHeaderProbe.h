@@ -0,0 +1,52 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RiffChunkReader.h"
+
+/**
+ * AudioHeaderProbe - reads duration, sample rate, bit depth and channel count from
+ * a file's headers, without an AudioFormatReader and without decoding
+ *
+ * - WAV/RF64: 'fmt ' and the size of 'data' ('fact' for compressed data)
+ * - AIFF/AIFC: 'COMM'
+ * - FLAC: STREAMINFO
+ * - MP3: the first frame header and its Xing/Info (with LAME gapless info) or VBRI
+ *   tag; without either the stream is taken to be CBR and timed from its size
+ *
+ * A probe costs a few small reads. Fields the header doesn't carry (bit depth for
+ * MP3, say) are 0, and so is everything for formats it doesn't know.
+ */
+namespace AudioHeaderProbe
+{
+    struct Info
+    {
+        int durationMs = 0;
+        int sampleRate = 0;
+        int bitDepth = 0;
+        int channels = 0;
+
+        bool isValid() const noexcept { return sampleRate > 0 && channels > 0; }
+    };
+
+    Info probe(const juce::File& audioFile);
+    Info probe(juce::InputStream& stream);
+
+    // For code that is already walking an AIFF file's chunks: the stream is positioned
+    // at the payload of 'COMM'
+    Info readAiffCommon(juce::InputStream& stream, juce::int64 chunkSize);
+
+    // For code that is already walking a WAV file's chunks: hand every chunk to add(),
+    // then read() parses the ones that matter
+    class WaveChunks
+    {
+    public:
+        void add(const RiffChunkReader::Chunk& chunk);
+        bool hasFormatAndData() const noexcept  { return hasFmt && hasData; }
+        Info read(RiffChunkReader& reader) const;
+
+    private:
+        RiffChunkReader::Chunk fmt, fact;
+        juce::int64 dataSize = 0;
+        bool hasFmt = false, hasFact = false, hasData = false;
+    };
+}
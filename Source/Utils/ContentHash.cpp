@@ -0,0 +1,234 @@
+#include "ContentHash.h"
+#include "RiffChunkReader.h"
+
+namespace
+{
+    constexpr juce::uint64 prime1 = 11400714785074694791ull;
+    constexpr juce::uint64 prime2 = 14029467366897019727ull;
+    constexpr juce::uint64 prime3 = 1609587929392839161ull;
+    constexpr juce::uint64 prime4 = 9650029242287828579ull;
+    constexpr juce::uint64 prime5 = 2870177450012600261ull;
+
+    inline juce::uint64 rotl(juce::uint64 x, int r)  { return (x << r) | (x >> (64 - r)); }
+    inline juce::uint64 read64(const juce::uint8* p) { return juce::ByteOrder::littleEndianInt64(p); }
+    inline juce::uint32 read32(const juce::uint8* p) { return juce::ByteOrder::littleEndianInt(p); }
+
+    inline juce::uint64 round(juce::uint64 acc, juce::uint64 input)
+    {
+        acc += input * prime2;
+        return rotl(acc, 31) * prime1;
+    }
+
+    inline juce::uint64 mergeRound(juce::uint64 acc, juce::uint64 value)
+    {
+        acc ^= round(0, value);
+        return acc * prime1 + prime4;
+    }
+
+    // Feeds up to numBytes from the stream's current position into the hasher
+    bool hashRange(juce::InputStream& stream, juce::int64 numBytes, ContentHash::Hasher& hasher)
+    {
+        juce::HeapBlock<char> block(65536);
+        while (numBytes > 0)
+        {
+            auto wanted = (int) juce::jmin((juce::int64) 65536, numBytes);
+            auto got = stream.read(block, wanted);
+            if (got <= 0)
+                return false;
+
+            hasher.update(block, (size_t) got);
+            numBytes -= got;
+        }
+        return true;
+    }
+
+    bool hashRiffData(juce::InputStream& stream, ContentHash::Hasher& hasher, AudioHeaderProbe::Info* format)
+    {
+        RiffChunkReader reader(stream);
+        if (!reader.isValid())
+            return false;
+
+        // 'fmt ' comes before 'data' in practically every file, so asking for it costs nothing extra
+        AudioHeaderProbe::WaveChunks formatChunks;
+        RiffChunkReader::Chunk chunk, data;
+        bool hasData = false;
+        while (reader.next(chunk))
+        {
+            if (chunk.is("data") && !hasData)
+            {
+                data = chunk;
+                hasData = true;
+            }
+            formatChunks.add(chunk);
+
+            if (hasData && (format == nullptr || formatChunks.hasFormatAndData()))
+                break;
+        }
+
+        if (!hasData || !stream.setPosition(data.dataOffset) || !hashRange(stream, data.size, hasher))
+            return false;
+
+        if (format != nullptr)
+            *format = formatChunks.read(reader);
+        return true;
+    }
+
+    bool hashAiffData(juce::InputStream& stream, ContentHash::Hasher& hasher, AudioHeaderProbe::Info* format)
+    {
+        char id[4];
+        bool hashed = false, hasCommon = format == nullptr;
+
+        while (!(hashed && hasCommon) && !stream.isExhausted() && stream.read(id, 4) == 4)
+        {
+            juce::int64 size = (juce::uint32) stream.readIntBigEndian();
+            auto payloadStart = stream.getPosition();
+
+            if (memcmp(id, "SSND", 4) == 0 && size >= 8 && !hashed)
+            {
+                juce::int64 offset = (juce::uint32) stream.readIntBigEndian();
+                stream.readIntBigEndian(); // blockSize
+                auto audioBytes = size - 8 - offset;
+                if (audioBytes < 0 || !stream.setPosition(payloadStart + 8 + offset)
+                    || !hashRange(stream, juce::jmin(audioBytes, stream.getTotalLength() - stream.getPosition()), hasher))
+                    return false;
+                hashed = true;
+            }
+            else if (memcmp(id, "COMM", 4) == 0 && !hasCommon)
+            {
+                *format = AudioHeaderProbe::readAiffCommon(stream, size);
+                hasCommon = true;
+            }
+
+            if (!stream.setPosition(payloadStart + size + (size & 1)))
+                break;
+        }
+        return hashed;
+    }
+}
+
+//==============================================================================
+ContentHash::Hasher::Hasher()
+    : acc { prime1 + prime2, prime2, 0, 0 - prime1 }
+{
+}
+
+void ContentHash::Hasher::update(const void* data, size_t numBytes)
+{
+    auto* p = static_cast<const juce::uint8*>(data);
+    auto* end = p + numBytes;
+    totalBytes += numBytes;
+
+    if (bufferedBytes + numBytes < 32)
+    {
+        memcpy(buffer + bufferedBytes, p, numBytes);
+        bufferedBytes += numBytes;
+        return;
+    }
+
+    if (bufferedBytes > 0)
+    {
+        auto fill = 32 - bufferedBytes;
+        memcpy(buffer + bufferedBytes, p, fill);
+        for (int i = 0; i < 4; ++i)
+            acc[i] = round(acc[i], read64(buffer + 8 * i));
+        p += fill;
+        bufferedBytes = 0;
+    }
+
+    for (; p + 32 <= end; p += 32)
+        for (int i = 0; i < 4; ++i)
+            acc[i] = round(acc[i], read64(p + 8 * i));
+
+    bufferedBytes = (size_t) (end - p);
+    memcpy(buffer, p, bufferedBytes);
+}
+
+juce::uint64 ContentHash::Hasher::getDigest() const
+{
+    juce::uint64 h;
+    if (totalBytes >= 32)
+    {
+        h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+        for (auto v : acc)
+            h = mergeRound(h, v);
+    }
+    else
+    {
+        h = prime5;
+    }
+
+    h += totalBytes;
+
+    auto* p = buffer;
+    auto* end = buffer + bufferedBytes;
+    for (; p + 8 <= end; p += 8)
+        h = rotl(h ^ round(0, read64(p)), 27) * prime1 + prime4;
+    if (p + 4 <= end)
+    {
+        h = rotl(h ^ ((juce::uint64) read32(p) * prime1), 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+        h = rotl(h ^ (*p * prime5), 11) * prime1;
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+//==============================================================================
+juce::uint64 ContentHash::ofAudioData(const juce::File& audioFile)
+{
+    juce::FileInputStream stream(audioFile);
+    if (!stream.openedOk())
+    {
+        juce::Logger::writeToLog("ContentHash: Could not open " + audioFile.getFullPathName());
+        return 0;
+    }
+    return ofAudioData(stream);
+}
+
+juce::uint64 ContentHash::ofAudioData(const juce::File& audioFile, AudioHeaderProbe::Info& format)
+{
+    format = {};
+    juce::FileInputStream stream(audioFile);
+    if (!stream.openedOk())
+    {
+        juce::Logger::writeToLog("ContentHash: Could not open " + audioFile.getFullPathName());
+        return 0;
+    }
+    return ofAudioData(stream, &format);
+}
+
+juce::uint64 ContentHash::ofAudioData(juce::InputStream& stream, AudioHeaderProbe::Info* format)
+{
+    Hasher hasher;
+    char header[12] = {};
+    auto start = stream.getPosition();
+    bool parsed = false;
+
+    if (stream.read(header, 12) == 12)
+    {
+        if (memcmp(header + 8, "WAVE", 4) == 0)
+            parsed = hashRiffData(stream, hasher, format);
+        else if (memcmp(header, "FORM", 4) == 0 && (memcmp(header + 8, "AIFF", 4) == 0 || memcmp(header + 8, "AIFC", 4) == 0))
+            parsed = hashAiffData(stream, hasher, format);
+    }
+
+    // Compressed formats, or a container we couldn't walk: hash every byte
+    if (!parsed)
+    {
+        if (format != nullptr)
+            *format = AudioHeaderProbe::probe(stream);
+
+        hasher = Hasher();
+        if (!stream.setPosition(start) || !hashRange(stream, stream.getTotalLength() - start, hasher))
+            return 0;
+    }
+
+    auto digest = hasher.getDigest();
+    return digest != 0 ? digest : 1;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioHeaderProbe.h"
+
+/**
+ * ContentHash - identifies audio by its sample data rather than its file
+ *
+ * Two chops that differ only in name, iXML/LIST metadata or chunk order hash
+ * the same: for WAV/RF64 only the 'data' chunk is hashed, for AIFF/AIFC only the
+ * sound data in 'SSND'. Other formats are hashed whole. The hash is 64-bit
+ * XXH64 and is never 0, so 0 can mean "not computed".
+ */
+namespace ContentHash
+{
+    // Streaming XXH64 (seed 0)
+    class Hasher
+    {
+    public:
+        Hasher();
+
+        void update(const void* data, size_t numBytes);
+        juce::uint64 getDigest() const;
+
+    private:
+        juce::uint64 acc[4];
+        juce::uint8 buffer[32];
+        size_t bufferedBytes = 0;
+        juce::uint64 totalBytes = 0;
+    };
+
+    // Reads the file once, seeking past chunks that aren't audio. Returns 0 if unreadable.
+    juce::uint64 ofAudioData(const juce::File& audioFile);
+
+    // The same, also reading the format ('fmt ', 'COMM', ...) from the chunks the hash
+    // walks anyway, so ingest opens each file once rather than once per question
+    juce::uint64 ofAudioData(const juce::File& audioFile, AudioHeaderProbe::Info& format);
+    juce::uint64 ofAudioData(juce::InputStream& stream, AudioHeaderProbe::Info* format = nullptr);
+}
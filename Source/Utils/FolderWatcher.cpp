@@ -0,0 +1,371 @@
+#include "FolderWatcher.h"
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    bool isHiddenName(const juce::String& name) { return name.startsWithChar('.'); }
+
+    struct Backend
+    {
+        virtual ~Backend() = default;
+        virtual bool isNative() const = 0;
+        // Waits up to timeoutMs and adds directories with changes to 'changed'
+        virtual void waitForChanges(int timeoutMs, juce::Array<juce::File>& changed) = 0;
+    };
+
+    //==============================================================================
+   #if JUCE_LINUX
+    class InotifyBackend : public Backend
+    {
+    public:
+        explicit InotifyBackend(const std::map<juce::File, bool>& roots)
+            : fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+        {
+            if (fd < 0)
+                return;
+
+            for (auto& [directory, recursive] : roots)
+                addWatch(directory, recursive, nullptr);
+        }
+
+        ~InotifyBackend() override
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        bool isValid() const { return fd >= 0 && !watches.empty(); }
+        bool isNative() const override { return true; }
+
+        void waitForChanges(int timeoutMs, juce::Array<juce::File>& changed) override
+        {
+            pollfd pfd { fd, POLLIN, 0 };
+            if (::poll(&pfd, 1, timeoutMs) <= 0)
+                return;
+
+            alignas(inotify_event) char buffer[64 * 1024];
+            for (;;)
+            {
+                auto length = ::read(fd, buffer, sizeof(buffer));
+                if (length <= 0)
+                    break;
+
+                for (char* p = buffer; p < buffer + length;)
+                {
+                    auto* event = reinterpret_cast<const inotify_event*>(p);
+                    p += sizeof(inotify_event) + event->len;
+                    handleEvent(*event, changed);
+                }
+            }
+        }
+
+    private:
+        struct Watch
+        {
+            juce::File directory;
+            bool recursive;
+        };
+
+        int fd;
+        std::map<int, Watch> watches;
+
+        static constexpr juce::uint32 mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE
+                                           | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+        void addWatch(const juce::File& directory, bool recursive, juce::Array<juce::File>* changed)
+        {
+            auto wd = inotify_add_watch(fd, directory.getFullPathName().toRawUTF8(), mask);
+            if (wd < 0)
+            {
+                juce::Logger::writeToLog("FolderWatcher: Could not watch " + directory.getFullPathName());
+                return;
+            }
+            watches[wd] = { directory, recursive }; // A directory moved within the tree keeps its wd
+
+            // Files may have landed in a new directory before its watch existed
+            if (changed != nullptr)
+                changed->addIfNotAlreadyThere(directory);
+
+            if (recursive)
+                for (const auto& entry : juce::RangedDirectoryIterator(directory, false, "*", juce::File::findDirectories))
+                    if (!isHiddenName(entry.getFile().getFileName()))
+                        addWatch(entry.getFile(), true, changed);
+        }
+
+        void handleEvent(const inotify_event& event, juce::Array<juce::File>& changed)
+        {
+            if ((event.mask & IN_Q_OVERFLOW) != 0)
+            {
+                // Events were dropped; report everything we watch
+                for (auto& [wd, watch] : watches)
+                    changed.addIfNotAlreadyThere(watch.directory);
+                return;
+            }
+
+            auto found = watches.find(event.wd);
+            if (found == watches.end())
+                return;
+
+            if ((event.mask & IN_IGNORED) != 0)
+            {
+                watches.erase(found);
+                return;
+            }
+
+            auto watch = found->second;
+            juce::String name = event.len > 0 ? juce::String::fromUTF8(event.name) : juce::String();
+            if (name.isNotEmpty() && isHiddenName(name))
+                return;
+
+            if ((event.mask & IN_ISDIR) != 0)
+            {
+                if (watch.recursive && (event.mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                    addWatch(watch.directory.getChildFile(name), true, &changed);
+                else if ((event.mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+                    changed.addIfNotAlreadyThere(watch.directory);
+                return;
+            }
+
+            // Creation alone isn't interesting: the file is reported when its writer closes it
+            if ((event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+                changed.addIfNotAlreadyThere(watch.directory);
+        }
+    };
+   #endif
+
+    //==============================================================================
+    // Compares a fingerprint of each directory's listing (names, sizes, mtimes) between polls
+    class PollingBackend : public Backend
+    {
+    public:
+        explicit PollingBackend(const std::map<juce::File, bool>& watchedRoots) : roots(watchedRoots)
+        {
+            poll(nullptr);
+        }
+
+        bool isNative() const override { return false; }
+
+        void waitForChanges(int timeoutMs, juce::Array<juce::File>& changed) override
+        {
+            juce::Thread::sleep(timeoutMs);
+            poll(&changed);
+        }
+
+    private:
+        struct State
+        {
+            juce::uint64 fingerprint = 0;
+            bool settling = false;  // Changed at the last poll; reported once it stops changing
+        };
+
+        std::map<juce::File, bool> roots;
+        std::map<juce::File, State> directories;
+
+        void poll(juce::Array<juce::File>* changed)
+        {
+            std::map<juce::File, State> seen;
+            for (auto& [directory, recursive] : roots)
+                visit(directory, recursive, seen, changed);
+
+            // Directories that disappeared count as changes to their parents
+            if (changed != nullptr)
+                for (auto& [directory, state] : directories)
+                    if (seen.count(directory) == 0 && seen.count(directory.getParentDirectory()) > 0)
+                        changed->addIfNotAlreadyThere(directory.getParentDirectory());
+
+            directories = std::move(seen);
+        }
+
+        void visit(const juce::File& directory, bool recursive, std::map<juce::File, State>& seen,
+                   juce::Array<juce::File>* changed)
+        {
+            juce::uint64 fingerprint = 14695981039346656037ull;
+            auto mix = [&fingerprint](juce::uint64 value) {
+                fingerprint = (fingerprint ^ value) * 1099511628211ull;
+            };
+
+            juce::Array<juce::File> subdirectories;
+            for (const auto& entry : juce::RangedDirectoryIterator(directory, false, "*",
+                                                                   juce::File::findFilesAndDirectories))
+            {
+                auto name = entry.getFile().getFileName();
+                if (isHiddenName(name))
+                    continue;
+
+                if (entry.isDirectory())
+                {
+                    if (recursive)
+                        subdirectories.add(entry.getFile());
+                    continue;
+                }
+
+                mix((juce::uint64) name.hashCode64());
+                mix((juce::uint64) entry.getFileSize());
+                mix((juce::uint64) entry.getModificationTime().toMilliseconds());
+            }
+
+            State state;
+            state.fingerprint = fingerprint;
+            auto previous = directories.find(directory);
+            if (changed != nullptr)
+            {
+                if (previous == directories.end())
+                    state.settling = true; // New directory: report it once it settles
+                else if (previous->second.fingerprint != fingerprint)
+                    state.settling = true;
+                else if (previous->second.settling)
+                    changed->addIfNotAlreadyThere(directory);
+            }
+            seen[directory] = state;
+
+            for (auto& subdirectory : subdirectories)
+                visit(subdirectory, true, seen, changed);
+        }
+    };
+
+    std::unique_ptr<Backend> createBackend(const std::map<juce::File, bool>& roots, bool allowNative)
+    {
+       #if JUCE_LINUX
+        if (allowNative)
+        {
+            auto inotify = std::make_unique<InotifyBackend>(roots);
+            if (inotify->isValid())
+                return inotify;
+            juce::Logger::writeToLog("FolderWatcher: inotify unavailable, polling instead");
+        }
+       #else
+        juce::ignoreUnused(allowNative);
+       #endif
+        return std::make_unique<PollingBackend>(roots);
+    }
+}
+
+//==============================================================================
+FolderWatcher::FolderWatcher(bool allowNativeEvents)
+    : juce::Thread("ChopsFolderWatcher"), allowNative(allowNativeEvents)
+{
+}
+
+FolderWatcher::~FolderWatcher()
+{
+    stopThread(2000);
+    cancelPendingUpdate();
+}
+
+void FolderWatcher::watch(const juce::File& directory, bool recursive)
+{
+    if (!directory.isDirectory())
+    {
+        juce::Logger::writeToLog("FolderWatcher: Not a directory: " + directory.getFullPathName());
+        return;
+    }
+
+    {
+        const juce::ScopedLock sl(lock);
+        roots[directory] = recursive;
+        rootsChanged = true;
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void FolderWatcher::unwatch(const juce::File& directory)
+{
+    const juce::ScopedLock sl(lock);
+    rootsChanged = roots.erase(directory) > 0 || rootsChanged;
+}
+
+void FolderWatcher::unwatchAll()
+{
+    const juce::ScopedLock sl(lock);
+    roots.clear();
+    rootsChanged = true;
+}
+
+void FolderWatcher::setSettings(const Settings& newSettings)
+{
+    const juce::ScopedLock sl(lock);
+    settings = newSettings;
+}
+
+//==============================================================================
+void FolderWatcher::run()
+{
+    std::unique_ptr<Backend> backend;
+
+    while (!threadShouldExit())
+    {
+        std::map<juce::File, bool> watchedRoots;
+        bool rebuild;
+        int timeoutMs;
+        {
+            const juce::ScopedLock sl(lock);
+            rebuild = std::exchange(rootsChanged, false);
+            if (rebuild)
+                watchedRoots = roots;
+            timeoutMs = settings.pollIntervalMs;
+            if (!pending.isEmpty())
+            {
+                // Wake up when the pending burst is due
+                auto due = juce::jmin(lastPendingMs + settings.debounceMs, firstPendingMs + settings.maxLatencyMs);
+                timeoutMs = juce::jlimit(1, timeoutMs, (int) (due - juce::Time::getMillisecondCounterHiRes()) + 1);
+            }
+        }
+
+        if (rebuild)
+        {
+            backend = watchedRoots.empty() ? nullptr : createBackend(watchedRoots, allowNative);
+            usingNativeEvents = backend != nullptr && backend->isNative();
+        }
+
+        juce::Array<juce::File> changed;
+        if (backend != nullptr)
+            backend->waitForChanges(backend->isNative() ? juce::jmin(timeoutMs, 200) : timeoutMs, changed);
+        else
+            wait(200);
+
+        auto now = juce::Time::getMillisecondCounterHiRes();
+        bool deliver = false;
+        {
+            const juce::ScopedLock sl(lock);
+            if (!changed.isEmpty())
+            {
+                if (pending.isEmpty())
+                    firstPendingMs = now;
+                lastPendingMs = now;
+                for (auto& directory : changed)
+                    pending.addIfNotAlreadyThere(directory);
+            }
+
+            if (!pending.isEmpty()
+                && (now - lastPendingMs >= settings.debounceMs || now - firstPendingMs >= settings.maxLatencyMs))
+            {
+                for (auto& directory : pending)
+                    ready.addIfNotAlreadyThere(directory);
+                pending.clearQuick();
+                deliver = true;
+            }
+        }
+
+        if (deliver)
+            triggerAsyncUpdate();
+    }
+}
+
+void FolderWatcher::handleAsyncUpdate()
+{
+    juce::Array<juce::File> directories;
+    {
+        const juce::ScopedLock sl(lock);
+        directories.swapWith(ready);
+    }
+
+    if (!directories.isEmpty())
+        listeners.call(&Listener::foldersChanged, directories);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+/**
+ * FolderWatcher - reports which watched directories have new, changed or removed files
+ *
+ * On Linux this uses inotify: files are reported once they're closed after writing
+ * or moved in, and directories created inside a recursive watch are picked up as they
+ * appear. Elsewhere (or if inotify is unavailable) it polls directory listings and
+ * only reports a directory once its listing has stopped changing, so half-copied
+ * files aren't picked up.
+ *
+ * Events are debounced: a burst of changes is delivered as one call listing each
+ * affected directory once, at most maxLatencyMs after the first event. Listeners are
+ * called on the message thread. Hidden files (names starting with '.') are ignored.
+ */
+class FolderWatcher : private juce::Thread,
+                      private juce::AsyncUpdater
+{
+public:
+    struct Settings
+    {
+        int debounceMs = 250;       // Quiet time before a burst is delivered
+        int maxLatencyMs = 1000;    // Deliver by then even if events keep coming
+        int pollIntervalMs = 1000;  // Polling fallback only
+    };
+
+    explicit FolderWatcher(bool allowNativeEvents = true);
+    ~FolderWatcher() override;
+
+    void watch(const juce::File& directory, bool recursive);
+    void unwatch(const juce::File& directory);
+    void unwatchAll();
+
+    void setSettings(const Settings& newSettings);
+    bool isUsingNativeEvents() const noexcept { return usingNativeEvents.load(); }
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        // Directories in which something changed; for recursive watches these can be subdirectories
+        virtual void foldersChanged(const juce::Array<juce::File>& directories) = 0;
+    };
+
+    void addListener(Listener* listener)    { listeners.add(listener); }
+    void removeListener(Listener* listener) { listeners.remove(listener); }
+
+private:
+    const bool allowNative;
+    std::atomic<bool> usingNativeEvents { false };
+
+    juce::CriticalSection lock;             // Guards everything below
+    std::map<juce::File, bool> roots;       // Directory -> recursive
+    bool rootsChanged = false;
+    Settings settings;
+    juce::Array<juce::File> pending;
+    double firstPendingMs = 0.0, lastPendingMs = 0.0;
+    juce::Array<juce::File> ready;
+
+    juce::ListenerList<Listener> listeners;
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FolderWatcher)
+};
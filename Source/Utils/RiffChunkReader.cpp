@@ -0,0 +1,108 @@
+#include "RiffChunkReader.h"
+
+RiffChunkReader::RiffChunkReader(juce::InputStream& stream)
+    : input(stream)
+{
+    totalLength = input.getTotalLength();
+
+    char header[12];
+    if (totalLength < 12 || !input.setPosition(0) || input.read(header, 12) != 12)
+        return;
+
+    rf64 = memcmp(header, "RF64", 4) == 0 || memcmp(header, "BW64", 4) == 0;
+    valid = (rf64 || memcmp(header, "RIFF", 4) == 0) && memcmp(header + 8, "WAVE", 4) == 0;
+}
+
+//==============================================================================
+bool RiffChunkReader::next(Chunk& chunk)
+{
+    if (!valid || nextHeader + 8 > totalLength || !input.setPosition(nextHeader))
+        return false;
+
+    if (input.read(chunk.id, 4) != 4)
+        return false;
+
+    for (auto c : chunk.id)
+        if (c < 0x20 || c > 0x7e)
+            return false; // Not a chunk header; the file is damaged or we lost alignment
+
+    juce::int64 size = (juce::uint32) input.readInt();
+    if (rf64 && size == 0xffffffff)
+    {
+        if (chunk.is("data") && rf64DataSize >= 0)
+            size = rf64DataSize;
+
+        for (auto& entry : rf64ChunkSizes)
+            if (entry.first == juce::String(chunk.id, 4))
+                size = entry.second;
+    }
+
+    chunk.headerOffset = nextHeader;
+    chunk.dataOffset = nextHeader + 8;
+    chunk.size = juce::jlimit((juce::int64) 0, totalLength - chunk.dataOffset, size);
+
+    if (rf64 && chunk.is("ds64"))
+        readDs64(chunk);
+
+    // Odd-sized chunks are followed by a pad byte, which some writers forget
+    nextHeader = chunk.getEnd();
+    if ((chunk.size & 1) != 0)
+    {
+        if (looksLikeChunkHeader(nextHeader + 1) || !looksLikeChunkHeader(nextHeader))
+            ++nextHeader;
+    }
+
+    return true;
+}
+
+bool RiffChunkReader::findChunk(const char* fourCC, Chunk& chunk)
+{
+    nextHeader = 12;
+    while (next(chunk))
+        if (chunk.is(fourCC))
+            return true;
+    return false;
+}
+
+bool RiffChunkReader::readPayload(const Chunk& chunk, juce::MemoryBlock& destination, juce::int64 maxBytes)
+{
+    if (chunk.size > maxBytes || !input.setPosition(chunk.dataOffset))
+        return false;
+
+    destination.setSize((size_t) chunk.size);
+    return input.read(destination.getData(), (int) chunk.size) == (int) chunk.size;
+}
+
+//==============================================================================
+void RiffChunkReader::readDs64(const Chunk& chunk)
+{
+    // riffSize, dataSize, sampleCount, then a table of (ID, size) for any other big chunks
+    if (chunk.size < 28 || !input.setPosition(chunk.dataOffset))
+        return;
+
+    input.readInt64();
+    rf64DataSize = input.readInt64();
+    input.readInt64();
+    auto tableLength = (juce::uint32) input.readInt();
+
+    rf64ChunkSizes.clear();
+    for (juce::uint32 i = 0; i < tableLength && 28 + (i + 1) * 12 <= (juce::uint64) chunk.size; ++i)
+    {
+        char id[4];
+        if (input.read(id, 4) != 4)
+            break;
+        rf64ChunkSizes.add({ juce::String(id, 4), input.readInt64() });
+    }
+}
+
+bool RiffChunkReader::looksLikeChunkHeader(juce::int64 offset)
+{
+    char id[4];
+    if (offset + 8 > totalLength || !input.setPosition(offset) || input.read(id, 4) != 4)
+        return false;
+
+    for (auto c : id)
+        if (c < 0x20 || c > 0x7e)
+            return false;
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * RiffChunkReader - walks the chunks of a RIFF/RF64 WAVE file by seeking
+ *
+ * Only the 12-byte file header and the 8-byte header of each chunk are read;
+ * payloads are read on request, so finding the iXML chunk of a 50 MB stem costs
+ * a few hundred bytes of I/O. Handles:
+ * - RF64/BW64, where 32-bit sizes of 0xFFFFFFFF are resolved through 'ds64'
+ * - the pad byte after odd-sized chunks, including writers that leave it out
+ * - chunks that claim to run past the end of the file (truncated to what's there)
+ */
+class RiffChunkReader
+{
+public:
+    struct Chunk
+    {
+        char id[4] = {};
+        juce::int64 headerOffset = 0;   // File offset of the chunk ID
+        juce::int64 dataOffset = 0;     // File offset of the payload
+        juce::int64 size = 0;           // Payload size, without the pad byte
+
+        bool is(const char* fourCC) const   { return memcmp(id, fourCC, 4) == 0; }
+        juce::int64 getEnd() const          { return dataOffset + size; }
+    };
+
+    // The stream must stay alive and seekable for the reader's lifetime
+    explicit RiffChunkReader(juce::InputStream& stream);
+
+    // True when the stream starts with a RIFF, RF64 or BW64 header of form type WAVE
+    bool isValid() const noexcept   { return valid; }
+    bool isRF64() const noexcept    { return rf64; }
+
+    // Steps to the next chunk; false at the end of the file or on a damaged header
+    bool next(Chunk& chunk);
+
+    // Rewinds and walks until the first chunk with this ID
+    bool findChunk(const char* fourCC, Chunk& chunk);
+
+    // Reads a chunk's payload; fails rather than allocating more than maxBytes
+    bool readPayload(const Chunk& chunk, juce::MemoryBlock& destination,
+                     juce::int64 maxBytes = 16 * 1024 * 1024);
+
+private:
+    juce::InputStream& input;
+    juce::int64 totalLength = 0;
+    juce::int64 nextHeader = 12;
+    bool valid = false, rf64 = false;
+
+    // From 'ds64': the real sizes of chunks whose 32-bit size is 0xFFFFFFFF
+    juce::int64 rf64DataSize = -1;
+    juce::Array<std::pair<juce::String, juce::int64>> rf64ChunkSizes;
+
+    void readDs64(const Chunk& chunk);
+    bool looksLikeChunkHeader(juce::int64 offset);
+
+    JUCE_DECLARE_NON_COPYABLE(RiffChunkReader)
+};
@@ -1,13 +1,21 @@
 #include <JuceHeader.h>
 #include "Database/ChopsDatabase.h"
 #include "Database/DatabaseSyncManager.h"
+#include "Database/LibrarySnapshot.h"
 #include "Core/ChordTypes.h"
 #include "Core/ChordParser.h"
 #include "Core/MetadataService.h"
+#include "Core/MetadataWriteBehind.h"
 #include "Core/MetadataServiceTest.h"
+#include "Audio/ChordDetectorTest.h"
+#include "Audio/SincResamplerTest.h"
 #include "Utils/FilenameUtils.h"
+#include "Utils/ContentHash.h"
+#include "Utils/AudioHeaderProbe.h"
+#include "Utils/FolderWatcher.h"
 #include "Shared/SharedConfig.h"
 #include <sqlite3.h>
+#include <deque>
 
 //==============================================================================
 class ChopsLibraryManagerApplication : public juce::JUCEApplication,
@@ -44,6 +52,11 @@ public:
         if (!databaseManager->initialize(dbFile)) { showErrorAndQuit("Could not initialize database manager."); return; }
         juce::Logger::writeToLog("Database initialized successfully");
         
+        // Plugins browse from the snapshot, so make sure one exists for the current database
+        juce::File snapshotFile = ChopsConfig::getLibrarySnapshotFile(dbFile);
+        if (!snapshotFile.existsAsFile() || snapshotFile.getLastModificationTime() < dbFile.getLastModificationTime())
+            LibrarySnapshot::publish(*databaseManager->getReadDatabase(), snapshotFile);
+        
         mainWindow = std::make_unique<MainWindow>(getApplicationName(), databaseManager.get(), this);
         
         startTimer(1000);
@@ -68,6 +81,7 @@ private:
                        public juce::Button::Listener,
                        public juce::FileDragAndDropTarget,
                        public DatabaseSyncManager::Listener,
+                       public FolderWatcher::Listener,
                        public juce::TableListBoxModel
     {
     public:
@@ -88,13 +102,18 @@ private:
             setVisible(true);
             if (databaseManager) {
                 databaseManager->addListener(this);
+                metadataWriteBehind = std::make_unique<MetadataWriteBehind>(*databaseManager);
+                ingestThread.setDatabaseFile(databaseManager->getDatabaseFile());
                 updateStatistics();
                 loadLibraryData();
+                startWatchingFolders();
             }
             juce::Logger::writeToLog("Main window created successfully");
         }
 
         ~MainWindow() override {
+            folderWatcher.removeListener(this);
+            ingestThread.stop(); // Its jobs use this window's members
             if (databaseManager) databaseManager->removeListener(this);
             #if JUCE_MAC
                 juce::MenuBarModel::setMacMainMenu(nullptr);
@@ -224,7 +243,7 @@ private:
             if(b==scanButton.get())
                 scanLibrary(); 
             else if(b==processButton.get())
-                processUploadFolder(); 
+                postUploadProcessing(); 
             else if(b==organizeButton.get())
                 organizeFiles(); 
             else if(b==testMetadataButton.get())
@@ -303,7 +322,7 @@ private:
             juce::ignoreUnused(sel); 
             if(rN<0||(size_t)rN>=currentSamples.size())
                 return; 
-            const auto&s=currentSamples[(size_t)rN];
+            const auto s=currentSamples[(size_t)rN];
             g.setColour(getLookAndFeel().findColour(juce::Label::textColourId)); 
             g.setFont(juce::FontOptions(14.0f)); 
             juce::String t;
@@ -322,6 +341,60 @@ private:
         DatabaseSyncManager* databaseManager; 
         ChopsLibraryManagerApplication* app; 
         
+        // Upload processing and folder syncs read, hash and move every file they touch: seconds
+        // of work for a big drop. They run here, one job at a time, on a write connection of
+        // their own, and hand their changes to DatabaseSyncManager on the message thread.
+        class IngestThread : public juce::Thread {
+        public:
+            using Job = std::function<void(ChopsDatabase&)>;
+            
+            IngestThread() : juce::Thread("ChopsIngest") {}
+            ~IngestThread() override { stop(); }
+            
+            void setDatabaseFile(const juce::File& file) { const juce::ScopedLock sl(lock); databaseFile = file; }
+            
+            // A job whose key is already waiting is dropped: the waiting one will see the same files
+            void post(const juce::String& key, Job job) {
+                {
+                    const juce::ScopedLock sl(lock);
+                    for (const auto& queued : jobs)
+                        if (queued.first == key) return;
+                    jobs.emplace_back(key, std::move(job));
+                }
+                if (!isThreadRunning()) startThread();
+                notify();
+            }
+            
+            void stop() { signalThreadShouldExit(); notify(); stopThread(10000); }
+            
+        private:
+            juce::CriticalSection lock; // Guards databaseFile and jobs
+            juce::File databaseFile;
+            std::deque<std::pair<juce::String, Job>> jobs;
+            ChopsDatabase database;     // Ingest thread only
+            
+            void run() override {
+                while (!threadShouldExit()) {
+                    Job job;
+                    juce::File file;
+                    {
+                        const juce::ScopedLock sl(lock);
+                        if (!jobs.empty()) { job = std::move(jobs.front().second); jobs.pop_front(); }
+                        file = databaseFile;
+                    }
+                    if (!job) { wait(-1); continue; }
+                    
+                    if (!database.isOpen() && !database.open(file.getFullPathName())) {
+                        juce::Logger::writeToLog("Ingest: Failed to open " + file.getFullPathName());
+                        continue;
+                    }
+                    job(database);
+                    database.releaseReadLocks(); // Don't hold back checkpoints until the next job
+                }
+                database.close();
+            }
+        };
+        
         class DropZoneComponent : public juce::Component { 
         public: 
             void paint(juce::Graphics& g) override { 
@@ -347,15 +420,77 @@ private:
         std::unique_ptr<juce::ListBox> uploadQueueList; 
         std::unique_ptr<juce::TextEditor> logView;
         std::unique_ptr<juce::Label> statusLabel; 
-        std::vector<ChopsDatabase::SampleInfo> currentSamples;
+        ResultSet currentSamples;
         juce::StringArray uploadQueueDisplayItems;
+        FolderWatcher folderWatcher;
+        MetadataService metadataService;
+        std::unique_ptr<MetadataWriteBehind> metadataWriteBehind; // Rating/tag/colour edits reach the files from here
+        IngestThread ingestThread;
+
+        static juce::File getChopsFolder(const juce::String& name) {
+            return ChopsConfig::getDefaultLibraryDirectory().getChildFile(ChopsConfig::FolderNames::chopsRoot).getChildFile(name);
+        }
+
+        // Files dropped into the upload folder are processed as soon as they're written;
+        // anything added, changed or moved under the processed folder is synced incrementally
+        void startWatchingFolders() {
+            folderWatcher.addListener(this);
+            folderWatcher.watch(getChopsFolder(ChopsConfig::FolderNames::uploadFolder), false);
+            folderWatcher.watch(getChopsFolder(ChopsConfig::FolderNames::processedFolder), true);
+            if (!folderWatcher.isUsingNativeEvents())
+                juce::Logger::writeToLog("Watching library folders by polling");
+        }
+
+        void foldersChanged(const juce::Array<juce::File>& directories) override {
+            if (!databaseManager) return;
+            juce::File upDir = getChopsFolder(ChopsConfig::FolderNames::uploadFolder);
+            juce::File procDir = getChopsFolder(ChopsConfig::FolderNames::processedFolder);
+
+            for (const auto& dir : directories) {
+                if (dir == upDir) {
+                    juce::Array<juce::File> files;
+                    upDir.findChildFiles(files, juce::File::findFiles, false, "*");
+                    for (const auto& f : files) {
+                        if (ChopsConfig::isAudioFile(f)) { postUploadProcessing(); break; }
+                    }
+                }
+                else if (dir == procDir || dir.isAChildOf(procDir)) {
+                    ingestThread.post("sync:" + dir.getFullPathName(),
+                                      [this, dir](ChopsDatabase& db) { syncLibraryFolder(db, dir, false); });
+                }
+            }
+        }
+
+        // Incremental: files whose size and mtime match the last sync are skipped. Ingest thread.
+        MetadataService::ScanResult syncLibraryFolder(ChopsDatabase& db, const juce::File& dir, bool recursive) {
+            MetadataService::ScanResult result;
+            if (!dir.isDirectory()) return result;
+            MetadataService::ScanOptions options;
+            options.recursive = recursive;
+            options.writeMetadataToFiles = false;
+            options.shouldCancel = [this] { return ingestThread.threadShouldExit(); };
+            result = metadataService.scanAndSyncDirectory(dir, &db, options);
+
+            // Skipped files wrote nothing; only a sync that touched rows republishes
+            int changed = result.filesProcessed - result.filesUnchanged;
+            if (changed > 0 || result.filesMoved > 0)
+                runOnMessageThread([](MainWindow& w) { if (w.databaseManager) w.databaseManager->helperWritesCommitted(); });
+
+            if (changed > 0 || result.filesMoved > 0 || result.errors > 0)
+                addLogMessage("Synced " + dir.getFileName() + ": " + juce::String(changed) + " changed, "
+                              + juce::String(result.filesMoved) + " moved, " + juce::String(result.errors) + " errors");
+            for (const auto& e : result.errorMessages) addLogMessage("  " + e);
+            return result;
+        }
 
         void scanLibrary(){
-            // Silent - no logging during interval debugging
-            statusLabel->setText("Scanning...", juce::dontSendNotification); 
-            if(databaseManager) 
-                databaseManager->notifyListenersDatabaseUpdated(); 
-            updateStatistics();
+            setStatus("Scanning...");
+            ingestThread.post("scan", [this](ChopsDatabase& db) {
+                auto result = syncLibraryFolder(db, getChopsFolder(ChopsConfig::FolderNames::processedFolder), true);
+                setStatus("Scan: " + juce::String(result.filesProcessed) + " files, "
+                          + juce::String(result.filesUnchanged) + " unchanged, "
+                          + juce::String(result.filesMissing) + " missing");
+            });
         }
         
         // NEW: Metadata service test method
@@ -392,16 +527,27 @@ private:
             addLogMessage("=== METADATA TESTS COMPLETE ===");
             addLogMessage("Check the log above for detailed results.");
             addLogMessage("Test files created in: " + testDir.getFullPathName());
+            
+            // The audio tests need no files
+            SincResamplerTest resamplerTester;
+            addLogMessage(resamplerTester.runAllTests() ? "✅ ALL RESAMPLER TESTS PASSED!" : "❌ SOME RESAMPLER TESTS FAILED!");
+            ChordDetectorTest chordTester;
+            addLogMessage(chordTester.runAllTests() ? "✅ ALL CHORD DETECTOR TESTS PASSED!" : "❌ SOME CHORD DETECTOR TESTS FAILED!");
+        }
+        
+        void postUploadProcessing() {
+            ingestThread.post("uploads", [this](ChopsDatabase& db) { processUploadFolder(db); });
         }
         
-        void processUploadFolder() 
+        // Ingest thread: reads and inserts through db, never through databaseManager's connections
+        void processUploadFolder(ChopsDatabase& db) 
         {
             addLogMessage("=== PROCESSING SESSION STARTED (INTERVAL DEBUGGING) ===");
-            statusLabel->setText("Starting processing...", juce::dontSendNotification);
+            setStatus("Starting processing...");
             
             if (!databaseManager) {
                 addLogMessage("ERROR: DatabaseManager not available");
-                statusLabel->setText("Error: DBManager N/A", juce::dontSendNotification);
+                setStatus("Error: DBManager N/A");
                 return;
             }
             
@@ -410,19 +556,20 @@ private:
             juce::File upDir = cRoot.getChildFile(ChopsConfig::FolderNames::uploadFolder);
             juce::File procDir = cRoot.getChildFile(ChopsConfig::FolderNames::processedFolder);
             juce::File misDir = cRoot.getChildFile(ChopsConfig::FolderNames::mismatchFolder);
+            juce::File dupDir = cRoot.getChildFile(ChopsConfig::FolderNames::duplicatesFolder);
             
             // Ensure directories exist
-            for (auto& d : {procDir, misDir}) {
+            for (auto& d : {procDir, misDir, dupDir}) {
                 if (!d.isDirectory() && !d.createDirectory()) {
                     addLogMessage("ERROR: Could not create directory: " + d.getFullPathName());
-                    statusLabel->setText("Error creating directories", juce::dontSendNotification);
+                    setStatus("Error creating directories");
                     return;
                 }
             }
             
             if (!upDir.isDirectory()) {
                 addLogMessage("ERROR: Upload directory missing: " + upDir.getFullPathName());
-                statusLabel->setText("Upload dir missing", juce::dontSendNotification);
+                setStatus("Upload dir missing");
                 return;
             }
             
@@ -443,14 +590,14 @@ private:
             
             if (audioFiles.isEmpty()) {
                 addLogMessage("No audio files in upload directory.");
-                statusLabel->setText("Upload empty.", juce::dontSendNotification);
+                setStatus("Upload empty.");
                 return;
             }
             
-            int ok = 0, errCount = 0, intervalCount = 0;
+            int ok = 0, errCount = 0, intervalCount = 0, dupCount = 0;
             bool dbChangedByThisRun = false;
             
-            for (int i = 0; i < audioFiles.size(); ++i) {
+            for (int i = 0; i < audioFiles.size() && !ingestThread.threadShouldExit(); ++i) {
                 const auto& f = audioFiles[i];
                 
                 // Update progress with percentage and current file
@@ -496,6 +643,28 @@ private:
                 
                 // === SILENT PROCESSING (no regular logging) ===
                 
+                // Same audio already in the library (renamed or re-tagged copy): set it aside.
+                // Hashing walks the chunks, so it reads the format on the way.
+                AudioHeaderProbe::Info format;
+                juce::uint64 contentHash = ContentHash::ofAudioData(f, format);
+                // A row whose file has gone is no reason to turn the audio away, but it mustn't
+                // hide a live copy added after it either
+                int existingId = 0;
+                for (int candidateId : db.findSampleIdsByContentHash(contentHash)) {
+                    auto candidate = db.getSampleById(candidateId);
+                    if (candidate != nullptr && juce::File(candidate->filePath).existsAsFile()) {
+                        existingId = candidateId;
+                        break;
+                    }
+                }
+                
+                if (existingId > 0) {
+                    addLogMessage("DUPLICATE of sample #" + juce::String(existingId) + ": " + f.getFileName());
+                    f.moveFileTo(createUniqueDestination(dupDir, f.getFileName()));
+                    dupCount++;
+                    continue;
+                }
+                
                 // Check if parsing was successful
                 if (!FilenameUtils::isValidParsedData(pd)) {
                     // Move to mismatch folder (silently)
@@ -510,6 +679,11 @@ private:
                 ChopsDatabase::SampleInfo si;
                 si.originalFilename = f.getFileName();
                 si.fileSize = f.getSize();
+                si.contentHash = contentHash;
+                si.durationMs = format.durationMs;
+                si.sampleRate = format.sampleRate;
+                si.bitDepth = format.bitDepth;
+                si.channels = format.channels;
                 si.rootNote = pd.rootNote;
                 si.chordType = pd.standardizedQuality;
                 si.chordTypeDisplay = pd.getFullChordName();
@@ -551,7 +725,7 @@ private:
                     si.filePath = destF.getFullPathName();
                     si.currentFilename = newFilenameStr;
                     
-                    int newId = databaseManager->insertProcessedSample(si);
+                    int newId = db.insertSample(si);
                     
                     if (newId > 0) {
                         ok++;
@@ -562,19 +736,13 @@ private:
                 } else {
                     errCount++;
                 }
-                
-                // Allow UI updates periodically to prevent freezing
-                if (i % 5 == 0) {
-                    juce::MessageManager::callAsync([]() {
-                        // Empty lambda to trigger message queue processing
-                    });
-                }
             }
             
             addLogMessage("=== INTERVAL DETECTION SUMMARY ===");
             addLogMessage("📊 Files interpreted as INTERVALS: " + juce::String(intervalCount));
             addLogMessage("✓ Total processed successfully: " + juce::String(ok));
             addLogMessage("✗ Total failed: " + juce::String(errCount));
+            addLogMessage("⧉ Duplicates set aside: " + juce::String(dupCount));
             if (ok + errCount > 0) {
                 addLogMessage("📈 Success rate: " + juce::String((ok * 100) / (ok + errCount)) + "%");
             }
@@ -585,14 +753,14 @@ private:
                 addLogMessage("⚠️  " + juce::String(intervalCount) + " files were interpreted as intervals - check details above");
             }
             
-            statusLabel->setText("Complete: " + juce::String(ok) + " success, " + juce::String(errCount) + " errors, " + juce::String(intervalCount) + " intervals", 
-                                juce::dontSendNotification);
-            
-            refreshUploadQueue();
+            setStatus("Complete: " + juce::String(ok) + " success, " + juce::String(errCount) + " errors, " + juce::String(dupCount) + " duplicates, " + juce::String(intervalCount) + " intervals");
             
-            if (dbChangedByThisRun && databaseManager != nullptr) {
-                databaseManager->notifyListenersDatabaseUpdated();
-            }
+            // Reloads the window's view and republishes the plugins' snapshot
+            runOnMessageThread([dbChangedByThisRun](MainWindow& w) {
+                w.refreshUploadQueue();
+                if (dbChangedByThisRun && w.databaseManager != nullptr)
+                    w.databaseManager->helperWritesCommitted();
+            });
             
             addLogMessage("=== PROCESSING SESSION FINISHED ===");
         }
@@ -609,7 +777,7 @@ private:
             juce::String progressText = juce::String::formatted("Processing %d/%d (%d%%): %s", 
                                                               current, total, percentage, 
                                                               displayName.toRawUTF8());
-            statusLabel->setText(progressText, juce::dontSendNotification);
+            setStatus(progressText);
         }
         
         juce::File createUniqueDestination(const juce::File& directory, const juce::String& desiredName) {
@@ -689,13 +857,35 @@ private:
             // Silent - no logging during interval debugging
         }
         
+        // The ingest thread logs and reports status too; the components are only touched here
+        void runOnMessageThread(std::function<void(MainWindow&)> fn) {
+            juce::Component::SafePointer<MainWindow> safeThis(this);
+            juce::MessageManager::callAsync([safeThis, fn] { if (safeThis != nullptr) fn(*safeThis); });
+        }
+        
+        void setStatus(const juce::String& text) {
+            if (!juce::MessageManager::existsAndIsCurrentThread()) {
+                runOnMessageThread([text](MainWindow& w) { w.setStatus(text); });
+                return;
+            }
+            if (statusLabel) statusLabel->setText(text, juce::dontSendNotification);
+        }
+        
         void addLogMessage(const juce::String& msg) { 
             juce::String ts=juce::Time::getCurrentTime().toString(true,true,true,true); 
+            juce::Logger::writeToLog(msg); 
+            appendToLogView("["+ts+"] "+msg+juce::newLine);
+        }
+        
+        void appendToLogView(const juce::String& line) {
+            if (!juce::MessageManager::existsAndIsCurrentThread()) {
+                runOnMessageThread([line](MainWindow& w) { w.appendToLogView(line); });
+                return;
+            }
             if(logView){
                 logView->moveCaretToEnd();
-                logView->insertTextAtCaret("["+ts+"] "+msg+juce::newLine);
+                logView->insertTextAtCaret(line);
             } 
-            juce::Logger::writeToLog(msg); 
         }
     }; // End of nested MainWindow class
 
@@ -750,7 +940,7 @@ private:
             }
         } else {
             juce::Logger::writeToLog("schema.sql not found (final path checked: " + schemaFile.getFullPathName() + "), creating basic schema.");
-            const char* basicSchema = "CREATE TABLE IF NOT EXISTS samples (id INTEGER PRIMARY KEY AUTOINCREMENT, original_filename TEXT NOT NULL, current_filename TEXT NOT NULL, file_path TEXT NOT NULL UNIQUE, file_size INTEGER, root_note TEXT, chord_type TEXT, chord_type_display TEXT, extensions TEXT DEFAULT '[]', alterations TEXT DEFAULT '[]', added_notes TEXT DEFAULT '[]', suspensions TEXT DEFAULT '[]', bass_note TEXT, inversion TEXT, date_added TIMESTAMP DEFAULT CURRENT_TIMESTAMP, date_modified TIMESTAMP DEFAULT CURRENT_TIMESTAMP, search_text TEXT, rating INTEGER DEFAULT 0, color_hex TEXT, is_favorite INTEGER DEFAULT 0, play_count INTEGER DEFAULT 0, user_notes TEXT, last_played TIMESTAMP); CREATE TABLE IF NOT EXISTS tags (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL UNIQUE); CREATE TABLE IF NOT EXISTS sample_tags (sample_id INTEGER NOT NULL, tag_id INTEGER NOT NULL, PRIMARY KEY (sample_id, tag_id), FOREIGN KEY (sample_id) REFERENCES samples(id) ON DELETE CASCADE, FOREIGN KEY (tag_id) REFERENCES tags(id) ON DELETE CASCADE);";
+            const char* basicSchema = "PRAGMA auto_vacuum = INCREMENTAL; CREATE TABLE IF NOT EXISTS samples (id INTEGER PRIMARY KEY AUTOINCREMENT, original_filename TEXT NOT NULL, current_filename TEXT NOT NULL, file_path TEXT NOT NULL UNIQUE, file_size INTEGER, content_hash INTEGER, file_mtime_ms INTEGER, file_inode INTEGER, file_device INTEGER, file_synced_ms INTEGER, duration_ms INTEGER, sample_rate INTEGER, bit_depth INTEGER, channels INTEGER, root_note TEXT, chord_type TEXT, chord_type_display TEXT, extensions TEXT DEFAULT '[]', alterations TEXT DEFAULT '[]', added_notes TEXT DEFAULT '[]', suspensions TEXT DEFAULT '[]', bass_note TEXT, inversion TEXT, date_added INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)), date_modified INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)), search_text TEXT, rating INTEGER DEFAULT 0, color_hex TEXT, is_favorite INTEGER DEFAULT 0, play_count INTEGER DEFAULT 0, user_notes TEXT, last_played INTEGER); CREATE TABLE IF NOT EXISTS tags (id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL UNIQUE); CREATE TABLE IF NOT EXISTS sample_tags (sample_id INTEGER NOT NULL, tag_id INTEGER NOT NULL, PRIMARY KEY (sample_id, tag_id), FOREIGN KEY (sample_id) REFERENCES samples(id) ON DELETE CASCADE, FOREIGN KEY (tag_id) REFERENCES tags(id) ON DELETE CASCADE);";
             char* errMsg = nullptr; 
             rc = sqlite3_exec(tempDb, basicSchema, nullptr, nullptr, &errMsg);
             if (rc != SQLITE_OK) { 
@@ -781,6 +971,8 @@ private:
             juce::Logger::writeToLog("Failed to create processedFolder");
         if (!chopsRoot.getChildFile(ChopsConfig::FolderNames::mismatchFolder).createDirectory()) 
             juce::Logger::writeToLog("Failed to create mismatchFolder");
+        if (!chopsRoot.getChildFile(ChopsConfig::FolderNames::duplicatesFolder).createDirectory()) 
+            juce::Logger::writeToLog("Failed to create duplicatesFolder");
         
         using namespace ChordTypes; 
         auto chordTypesMap = getStandardizedChordTypes();